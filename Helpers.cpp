@@ -6,6 +6,8 @@
 #include "VK.hpp"
 // #include "refsol.hpp"
 
+#include <algorithm>
+#include <numeric>
 #include <utility>
 #include <cassert>
 #include <cstring>
@@ -18,6 +20,8 @@ Helpers::Allocation::Allocation(Allocation &&from) {
 	std::swap(size, from.size);
 	std::swap(offset, from.offset);
 	std::swap(mapped, from.mapped);
+	std::swap(memory_type_index, from.memory_type_index);
+	std::swap(category, from.category);
 }
 
 Helpers::Allocation &Helpers::Allocation::operator=(Allocation &&from) {
@@ -30,6 +34,8 @@ Helpers::Allocation &Helpers::Allocation::operator=(Allocation &&from) {
 	std::swap(size, from.size);
 	std::swap(offset, from.offset);
 	std::swap(mapped, from.mapped);
+	std::swap(memory_type_index, from.memory_type_index);
+	std::swap(category, from.category);
 
 	return *this;
 }
@@ -42,11 +48,194 @@ Helpers::Allocation::~Allocation() {
 
 //----------------------------
 
-Helpers::Allocation Helpers::allocate(VkDeviceSize size, VkDeviceSize alignment, uint32_t memory_type_index, MapFlag map) {
+bool Helpers::MemoryBlock::take(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset_) {
+	assert(size > 0 && alignment > 0);
+	// best fit: the smallest free range that still holds size bytes once its start is aligned
+	// (only ranges within alignment bytes of size can fail that, so this rarely looks at more than one or two)
+	for (auto f = free_by_size.lower_bound(size); f != free_by_size.end(); ++f) {
+		VkDeviceSize range_size = f->first;
+		VkDeviceSize range_offset = f->second;
+		VkDeviceSize offset = (range_offset + alignment - 1) / alignment * alignment;
+		if (offset + size > range_offset + range_size) continue;
+
+		free_by_size.erase(f);
+		free_by_offset.erase(range_offset);
+
+		// the range's neighbours are in use (free ranges are always merged), so leftovers go straight back:
+		if (offset > range_offset) {
+			free_by_offset.emplace(range_offset, offset - range_offset);
+			free_by_size.emplace(offset - range_offset, range_offset);
+		}
+		if (offset + size < range_offset + range_size) {
+			VkDeviceSize after = range_offset + range_size - (offset + size);
+			free_by_offset.emplace(offset + size, after);
+			free_by_size.emplace(after, offset + size);
+		}
+
+		allocations += 1;
+		used += size;
+		*offset_ = offset;
+		return true;
+	}
+	return false;
+}
+
+void Helpers::MemoryBlock::give(VkDeviceSize offset, VkDeviceSize size) {
+	assert(allocations > 0 && used >= size);
+	allocations -= 1;
+	used -= size;
+
+	auto forget = [this](std::map< VkDeviceSize, VkDeviceSize >::iterator range) {
+		auto [first, last] = free_by_size.equal_range(range->second);
+		for (auto f = first; f != last; ++f) {
+			if (f->second == range->first) {
+				free_by_size.erase(f);
+				break;
+			}
+		}
+		free_by_offset.erase(range);
+	};
+
+	// merge with the free ranges right after and right before, if there are any:
+	auto next = free_by_offset.find(offset + size);
+	if (next != free_by_offset.end()) {
+		size += next->second;
+		forget(next);
+	}
+	auto prev = free_by_offset.lower_bound(offset);
+	if (prev != free_by_offset.begin()) {
+		--prev;
+		assert(prev->first + prev->second <= offset); //otherwise offset was freed twice
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			size += prev->second;
+			forget(prev);
+		}
+	}
+
+	free_by_offset.emplace(offset, size);
+	free_by_size.emplace(size, offset);
+}
+
+VkDeviceSize Helpers::block_size(uint32_t memory_type_index) const {
+	// 64MiB blocks, but no more than an eighth of a small heap (e.g., the 256MiB device-local + host-visible heap some GPUs have):
+	VkDeviceSize heap_size = memory_properties.memoryHeaps[memory_properties.memoryTypes[memory_type_index].heapIndex].size;
+	return std::min< VkDeviceSize >(VkDeviceSize(64) << 20, heap_size / 8);
+}
+
+Helpers::Allocation Helpers::allocate(VkDeviceSize size, VkDeviceSize alignment, uint32_t memory_type_index, MapFlag map, ResourceKind kind) {
+	assert(memory_type_index < memory_properties.memoryTypeCount);
+
+	bool host_visible = (memory_properties.memoryTypes[memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+	if (map == Mapped && !host_visible) {
+		throw std::runtime_error("Can't map memory of type " + std::to_string(memory_type_index) + ", which isn't HOST_VISIBLE.");
+	}
+
+	// large allocations would waste most of a block, so they get their own memory:
+	VkDeviceSize new_block_size = block_size(memory_type_index);
+	if (size > new_block_size / 2) {
+		return allocate_dedicated(size, memory_type_index, map);
+	}
+
+	// linear and optimal resources only need separate blocks if the device has a granularity to respect:
+	if (buffer_image_granularity <= 1) kind = Linear;
+
+	Allocation allocation;
+	allocation.size = size;
+
+	MemoryBlock *block = nullptr;
+	for (auto const &b : memory_blocks) {
+		if (b->memory_type_index == memory_type_index && b->kind == kind && b->take(size, alignment, &allocation.offset)) {
+			block = b.get();
+			break;
+		}
+	}
+
+	if (!block) {
+		// every block of this type is full (or there are none yet), so make another:
+		auto b = std::make_unique< MemoryBlock >();
+		b->size = new_block_size;
+		b->memory_type_index = memory_type_index;
+		b->kind = kind;
+
+		VkMemoryAllocateInfo alloc_info{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			.allocationSize = b->size,
+			.memoryTypeIndex = memory_type_index,
+		};
+		VK(vkAllocateMemory(rtg.device, &alloc_info, nullptr, &b->handle));
+
+		if (host_visible) {
+			VK(vkMapMemory(rtg.device, b->handle, 0, VK_WHOLE_SIZE, 0, &b->mapped));
+		}
+
+		b->free_by_offset.emplace(0, b->size);
+		b->free_by_size.emplace(b->size, 0);
+
+		memory_stats.blocks += 1;
+		memory_stats.block_bytes += b->size;
+		count_heap_bytes(memory_type_index, b->size, true);
+		memory_stats.peak_device_memory_objects = std::max(memory_stats.peak_device_memory_objects, memory_stats.blocks + memory_stats.dedicated);
+
+		block = b.get();
+		memory_blocks.emplace_back(std::move(b));
+
+		[[maybe_unused]] bool taken = block->take(size, alignment, &allocation.offset);
+		assert(taken);
+	}
+
+	allocation.handle = block->handle;
+	if (map == Mapped) {
+		allocation.mapped = block->mapped; //(data() adds the offset)
+	}
+
+	allocation.memory_type_index = memory_type_index;
+	memory_stats.sub_allocations += 1;
+	memory_stats.sub_allocated_bytes += size;
+	count_allocation(allocation, true); //(as Uncategorized, until create_buffer or create_image sets its category)
+
+	return allocation;
+}
+
+Helpers::Allocation Helpers::allocate(VkMemoryRequirements const &req, VkMemoryPropertyFlags properties, MapFlag map, ResourceKind kind) {
+	return allocate(req.size, req.alignment, find_memory_type(req.memoryTypeBits, properties), map, kind);
+}
+
+Helpers::Allocation Helpers::allocate_image_memory(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags properties, MapFlag map) {
+	VkMemoryDedicatedRequirements dedicated{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+	};
+	VkMemoryRequirements2 req2{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+		.pNext = &dedicated,
+	};
+	VkImageMemoryRequirementsInfo2 info{
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2,
+		.image = image,
+	};
+	vkGetImageMemoryRequirements2(rtg.device, &info, &req2);
+
+	VkMemoryRequirements const &req = req2.memoryRequirements;
+	uint32_t memory_type_index = find_memory_type(req.memoryTypeBits, properties);
+
+	// drivers prefer dedicated memory for some images (e.g., render targets they compress), and large images don't belong in a block anyway:
+	if (dedicated.requiresDedicatedAllocation || dedicated.prefersDedicatedAllocation || req.size > block_size(memory_type_index) / 2) {
+		return allocate_dedicated(req.size, memory_type_index, map, image);
+	}
+
+	return allocate(req.size, req.alignment, memory_type_index, map, (tiling == VK_IMAGE_TILING_OPTIMAL ? Optimal : Linear));
+}
+
+Helpers::Allocation Helpers::allocate_dedicated(VkDeviceSize size, uint32_t memory_type_index, MapFlag map, VkImage image) {
 	Helpers::Allocation allocation;
-	
+
+	VkMemoryDedicatedAllocateInfo dedicated_info{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+		.image = image,
+	};
 	VkMemoryAllocateInfo alloc_info {
 		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.pNext = (image != VK_NULL_HANDLE ? &dedicated_info : nullptr),
 		.allocationSize = size,
 		.memoryTypeIndex = memory_type_index
 	};
@@ -61,30 +250,162 @@ Helpers::Allocation Helpers::allocate(VkDeviceSize size, VkDeviceSize alignment,
 		VK(vkMapMemory(rtg.device, allocation.handle, 0, allocation.size, 0, &allocation.mapped));
 	}
 
-	return allocation;
-}
+	allocation.memory_type_index = memory_type_index;
+	memory_stats.dedicated += 1;
+	memory_stats.dedicated_bytes += size;
+	count_heap_bytes(memory_type_index, size, true);
+	count_allocation(allocation, true);
+	memory_stats.peak_device_memory_objects = std::max(memory_stats.peak_device_memory_objects, memory_stats.blocks + memory_stats.dedicated);
 
-Helpers::Allocation Helpers::allocate(VkMemoryRequirements const &req, VkMemoryPropertyFlags properties, MapFlag map) {
-	return allocate(req.size, req.alignment, find_memory_type(req.memoryTypeBits, properties), map);
+	return allocation;
 }
 
 void Helpers::free(Helpers::Allocation &&allocation) {
-	if (allocation.mapped != nullptr) {
-		// unmap the memory if mapped
-		vkUnmapMemory(rtg.device, allocation.handle);
-		allocation.mapped = nullptr;
+	if (allocation.handle == VK_NULL_HANDLE) return;
+
+	count_allocation(allocation, false);
+
+	auto block = std::find_if(memory_blocks.begin(), memory_blocks.end(), [&](auto const &b) {
+		return b->handle == allocation.handle;
+	});
+
+	if (block != memory_blocks.end()) {
+		// sub-allocation: hand the range back to its block (which stays mapped)
+		MemoryBlock &b = **block;
+		b.give(allocation.offset, allocation.size);
+		memory_stats.sub_allocations -= 1;
+		memory_stats.sub_allocated_bytes -= allocation.size;
+
+		// keep one empty block per memory type and kind around for the next allocation, but release any others:
+		if (b.allocations == 0) {
+			bool have_another = std::any_of(memory_blocks.begin(), memory_blocks.end(), [&](auto const &other) {
+				return other.get() != &b && other->memory_type_index == b.memory_type_index && other->kind == b.kind;
+			});
+			if (have_another) {
+				if (b.mapped) vkUnmapMemory(rtg.device, b.handle);
+				vkFreeMemory(rtg.device, b.handle, nullptr);
+				memory_stats.blocks -= 1;
+				memory_stats.block_bytes -= b.size;
+				count_heap_bytes(b.memory_type_index, b.size, false);
+				memory_blocks.erase(block);
+			}
+		}
+	} else {
+		// dedicated allocation:
+		if (allocation.mapped != nullptr) {
+			// unmap the memory if mapped
+			vkUnmapMemory(rtg.device, allocation.handle);
+		}
+		vkFreeMemory(rtg.device, allocation.handle, nullptr);
+		memory_stats.dedicated -= 1;
+		memory_stats.dedicated_bytes -= allocation.size;
+		count_heap_bytes(allocation.memory_type_index, allocation.size, false);
 	}
 
-	vkFreeMemory(rtg.device, allocation.handle, nullptr);
-
 	allocation.handle = VK_NULL_HANDLE;
+	allocation.mapped = nullptr;
 	allocation.offset = 0;
 	allocation.size = 0;
+	allocation.memory_type_index = 0;
+	allocation.category = MemoryCategory::Uncategorized;
+}
+
+char const *Helpers::memory_category_name(MemoryCategory category) {
+	switch (category) {
+		case MemoryCategory::Uncategorized: return "uncategorized";
+		case MemoryCategory::SceneVertices: return "scene vertices";
+		case MemoryCategory::Textures: return "textures";
+		case MemoryCategory::Cubemaps: return "cubemaps";
+		case MemoryCategory::Workspace: return "workspaces";
+		case MemoryCategory::Swapchain: return "swapchain";
+		case MemoryCategory::Staging: return "staging";
+		case MemoryCategory::Count: break;
+	}
+	return "?";
+}
+
+void Helpers::count_heap_bytes(uint32_t memory_type_index, VkDeviceSize size, bool allocated) {
+	uint32_t heap = memory_properties.memoryTypes[memory_type_index].heapIndex;
+	if (allocated) {
+		memory_stats.heap_bytes[heap] += size;
+		memory_stats.peak_heap_bytes[heap] = std::max(memory_stats.peak_heap_bytes[heap], memory_stats.heap_bytes[heap]);
+	} else {
+		assert(memory_stats.heap_bytes[heap] >= size);
+		memory_stats.heap_bytes[heap] -= size;
+	}
+}
+
+void Helpers::count_allocation(Allocation const &allocation, bool allocated) {
+	MemoryStats::Category &category = memory_stats.categories[size_t(allocation.category)];
+	if (allocated) {
+		category.allocations += 1;
+		category.bytes += allocation.size;
+		category.peak_bytes = std::max(category.peak_bytes, category.bytes);
+	} else {
+		assert(category.allocations > 0 && category.bytes >= allocation.size);
+		category.allocations -= 1;
+		category.bytes -= allocation.size;
+	}
+}
+
+void Helpers::set_category(Allocation &allocation, MemoryCategory category) {
+	count_allocation(allocation, false);
+	allocation.category = category;
+	count_allocation(allocation, true);
+}
+
+void Helpers::report_memory(std::ostream &out) const {
+	auto MiB = [](VkDeviceSize bytes) { return double(bytes) / double(1 << 20); };
+
+	out << "Device memory by category (current / peak MiB):\n";
+	for (uint32_t c = 0; c < uint32_t(MemoryCategory::Count); ++c) {
+		MemoryStats::Category const &category = memory_stats.categories[c];
+		if (category.peak_bytes == 0) continue;
+		out << " " << memory_category_name(MemoryCategory(c)) << ": " << category.allocations << " allocations, "
+		    << MiB(category.bytes) << " / " << MiB(category.peak_bytes) << "\n";
+	}
+
+	// what the driver says about each heap (counting other processes, and memory we don't allocate through Helpers):
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+	};
+	if (rtg.memory_budget_supported) {
+		VkPhysicalDeviceMemoryProperties2 properties{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+			.pNext = &budget,
+		};
+		vkGetPhysicalDeviceMemoryProperties2(rtg.physical_device, &properties);
+	}
+
+	out << "Device memory by heap (allocated / peak MiB" << (rtg.memory_budget_supported ? ", driver usage / budget MiB" : "; no VK_EXT_memory_budget, so heap size") << "):\n";
+	for (uint32_t h = 0; h < memory_properties.memoryHeapCount; ++h) {
+		VkMemoryHeap const &heap = memory_properties.memoryHeaps[h];
+		out << " [" << h << "]" << ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " device-local" : " host") << ": "
+		    << MiB(memory_stats.heap_bytes[h]) << " / " << MiB(memory_stats.peak_heap_bytes[h]) << ", ";
+		if (rtg.memory_budget_supported) {
+			out << MiB(budget.heapUsage[h]) << " / " << MiB(budget.heapBudget[h]);
+			if (budget.heapBudget[h] != 0) out << " (" << int(100.0 * double(budget.heapUsage[h]) / double(budget.heapBudget[h]) + 0.5) << "%)";
+		} else {
+			out << MiB(heap.size);
+		}
+		out << "\n";
+	}
+
+	out << "Device memory: " << memory_stats.blocks << " blocks (" << MiB(memory_stats.block_bytes) << " MiB) holding "
+	    << memory_stats.sub_allocations << " allocations (" << MiB(memory_stats.sub_allocated_bytes) << " MiB), "
+	    << memory_stats.dedicated << " dedicated allocations (" << MiB(memory_stats.dedicated_bytes) << " MiB); "
+	    << "at most " << memory_stats.peak_device_memory_objects << " VkDeviceMemory objects at once.\n";
+	for (auto const &b : memory_blocks) {
+		out << " type " << b->memory_type_index << (b->kind == Optimal ? " optimal" : " linear") << " block: "
+		    << MiB(b->used) << " of " << MiB(b->size) << " MiB used by " << b->allocations << " allocations, "
+		    << b->free_by_offset.size() << " free ranges\n";
+	}
+	out.flush();
 }
 
 //----------------------------
 
-Helpers::AllocatedBuffer Helpers::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map) {
+Helpers::AllocatedBuffer Helpers::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map, MemoryCategory category) {
 	AllocatedBuffer buffer;
 	// refsol::Helpers_create_buffer(rtg, size, usage, properties, (map == Mapped), &buffer);
 
@@ -104,6 +425,7 @@ Helpers::AllocatedBuffer Helpers::create_buffer(VkDeviceSize size, VkBufferUsage
 
 	// allocate memory
 	buffer.allocation = allocate(req, properties, map);
+	set_category(buffer.allocation, category);
 	
 	// bind memory with the buffer
 	VK(vkBindBufferMemory(rtg.device, buffer.handle, buffer.allocation.handle, buffer.allocation.offset));
@@ -123,7 +445,7 @@ void Helpers::destroy_buffer(AllocatedBuffer &&buffer) {
 }
 
 
-Helpers::AllocatedImage Helpers::create_image(VkExtent2D const &extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map) {
+Helpers::AllocatedImage Helpers::create_image(VkExtent2D const &extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map, MemoryCategory category) {
 	AllocatedImage image;
 	// refsol::Helpers_create_image(rtg, extent, format, tiling, usage, properties, (map == Mapped), &image);
 	image.extent = extent;
@@ -149,10 +471,8 @@ Helpers::AllocatedImage Helpers::create_image(VkExtent2D const &extent, VkFormat
 
 	VK(vkCreateImage(rtg.device, &create_info, nullptr, &image.handle));
 
-	VkMemoryRequirements req;
-	vkGetImageMemoryRequirements(rtg.device, image.handle, &req);
-
-	image.allocation = allocate(req, properties, map);
+	image.allocation = allocate_image_memory(image.handle, tiling, properties, map);
+	set_category(image.allocation, category);
 
 	VK(vkBindImageMemory(rtg.device, image.handle, image.allocation.handle, image.allocation.offset));
 	
@@ -174,91 +494,83 @@ void Helpers::destroy_image(AllocatedImage &&image) {
 
 void Helpers::transfer_to_buffer(void const *data, size_t size, AllocatedBuffer &target) {
 	// refsol::Helpers_transfer_to_buffer(rtg, data, size, &target);
-	// NOTE: could let this stick around and use it for all uploads, but this function isn't for performant transfers anyway:
-	AllocatedBuffer transfer_src = create_buffer(
-		size,
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		Mapped
-	);
-
-	// copy data to transfer buffer
-	std::memcpy(transfer_src.allocation.data(), data, size);
+	// stage and copy like any other upload, then wait for it to finish:
+	wait_for_upload(transfer_to_buffer_async(data, size, target));
+}
 
-	{	// record CPU -> GPU transfer to command buffer
-		VK(vkResetCommandBuffer(transfer_command_buffer, 0));
+void Helpers::transfer_to_buffer(AllocatedBuffer const &transfer_src, size_t size, AllocatedBuffer &target) {
+	// run the copy like any other upload, then wait for it to finish:
+	wait_for_upload(transfer_to_buffer_async(transfer_src, VkBufferCopy{ .srcOffset = 0, .dstOffset = 0, .size = size }, target));
+}
 
-		VkCommandBufferBeginInfo begin_info{
-			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,	// will record again every submit
-		};
+void Helpers::transfer_to_image(void const *data, size_t size, AllocatedImage &target) {
+	// refsol::Helpers_transfer_to_image(rtg, data, size, &target);
+	wait_for_upload(transfer_to_image_async(data, size, target));
+}
 
-		VK(vkBeginCommandBuffer(transfer_command_buffer, &begin_info));
+uint64_t Helpers::transfer_to_buffer_async(void const *data, size_t size, AllocatedBuffer &target, VkDeviceSize target_offset) {
+	assert(target.size >= target_offset + size);
 
-		VkBufferCopy copy_region{
-			.srcOffset = 0,
-			.dstOffset = 0,
-			.size = size
-		};
-		vkCmdCopyBuffer(transfer_command_buffer, transfer_src.handle, target.handle, 1, &copy_region);
+	StagingSpace space = stage(size, 16);
+	std::memcpy(space.data, data, size);
 
-		VK(vkEndCommandBuffer(transfer_command_buffer));
-	}
+	VkBufferCopy region{
+		.srcOffset = space.offset,
+		.dstOffset = target_offset,
+		.size = size,
+	};
+	VkCommandBuffer command_buffer = begin_upload();
+	vkCmdCopyBuffer(command_buffer, space.buffer, target.handle, 1, &region);
+	release_buffer(command_buffer, target, region.dstOffset, region.size);
 
-	{	// run command buffer -> submit it to the graphics queue
-		VkSubmitInfo submit_info{
-			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			.commandBufferCount = 1,
-			.pCommandBuffers = &transfer_command_buffer
-		};
+	return upload_submitted + 1;
+}
 
-		VK(vkQueueSubmit(rtg.graphics_queue, 1, &submit_info, VK_NULL_HANDLE));
-	}
+uint64_t Helpers::transfer_to_buffer_async(AllocatedBuffer const &transfer_src, VkBufferCopy const &region, AllocatedBuffer &target) {
+	assert(transfer_src.size >= region.srcOffset + region.size && target.size >= region.dstOffset + region.size);
 
-	// wait for command buffer to finish -> wait until the graphics queue is idle
-	VK(vkQueueWaitIdle(rtg.graphics_queue));
+	VkCommandBuffer command_buffer = begin_upload();
+	vkCmdCopyBuffer(command_buffer, transfer_src.handle, target.handle, 1, &region);
+	release_buffer(command_buffer, target, region.dstOffset, region.size);
 
-	// don't leak buffer memory:
-	destroy_buffer(std::move(transfer_src));
+	return upload_submitted + 1;
 }
 
-void Helpers::transfer_to_image(void const *data, size_t size, AllocatedImage &target) {
-	// refsol::Helpers_transfer_to_image(rtg, data, size, &target);
+uint64_t Helpers::transfer_to_buffer_async(StagingSpace const &space, VkBufferCopy const &region, AllocatedBuffer &target) {
+	assert(space.buffer != VK_NULL_HANDLE && target.size >= region.dstOffset + region.size);
+
+	VkBufferCopy copy = region;
+	copy.srcOffset += space.offset;
+	VkCommandBuffer command_buffer = begin_upload();
+	vkCmdCopyBuffer(command_buffer, space.buffer, target.handle, 1, &copy);
+	release_buffer(command_buffer, target, copy.dstOffset, copy.size);
 
+	return upload_submitted + 1;
+}
+
+uint64_t Helpers::transfer_to_image_async(void const *data, size_t size, AllocatedImage &target) {
 	assert(target.handle != VK_NULL_HANDLE);	// target image should be allocated already
 
 	// check data is the right size
 	size_t bytes_per_block = vkuFormatTexelBlockSize(target.format);
 	size_t texels_per_block = vkuFormatTexelsPerBlock(target.format);
-	assert(size == target.extent.width * target.extent.height * bytes_per_block / texels_per_block);
-
-	// create a host-coherent source buffer
-	AllocatedBuffer transfer_src = create_buffer(
-		size,
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		Mapped
-	);
-
-	// copy image data into the source buffer
-	std::memcpy(transfer_src.allocation.data(), data, size);
+	size_t layer_size = target.extent.width * target.extent.height * bytes_per_block / texels_per_block;
+	assert(size == layer_size * target.arrayLayers);
 
-	// begin recording a command buffer
-	VK( vkResetCommandBuffer(transfer_command_buffer, 0) );
+	// copy image data into staging memory
+	// (buffer offsets of image copies must be a multiple of the texel block size; 16 keeps them tidy for the rest)
+	StagingSpace space = stage(size, std::lcm< VkDeviceSize >(bytes_per_block, 16));
+	std::memcpy(space.data, data, size);
 
-	VkCommandBufferBeginInfo begin_info{
-		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,	// will record again every submit
-	};
-
-	VK( vkBeginCommandBuffer(transfer_command_buffer, &begin_info) );
+	// record into the open batch
+	VkCommandBuffer command_buffer = begin_upload();
 
 	VkImageSubresourceRange whole_image{
 		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
 		.baseMipLevel = 0,
 		.levelCount = 1,
 		.baseArrayLayer = 0,
-		.layerCount = 1,
+		.layerCount = target.arrayLayers,
 	};
 
 	{ 	// put the receiving image in destination-optimal layout
@@ -275,7 +587,7 @@ void Helpers::transfer_to_image(void const *data, size_t size, AllocatedImage &t
 		};
 
 		vkCmdPipelineBarrier(
-			transfer_command_buffer,	// commandBuffer
+			command_buffer,	// commandBuffer
 			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,	// srcStageMask
 			VK_PIPELINE_STAGE_TRANSFER_BIT,	// dstStageMask
 			0,	// dependencyFlags
@@ -285,53 +597,62 @@ void Helpers::transfer_to_image(void const *data, size_t size, AllocatedImage &t
 		);
 	}
 	
-	{	//copy the source buffer to the image
-		VkBufferImageCopy region{
-			.bufferOffset = 0,
-			.bufferRowLength = target.extent.width,
-			.bufferImageHeight = target.extent.height,
-			.imageSubresource{
-				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-				.mipLevel = 0,
-				.baseArrayLayer = 0,
-				.layerCount = 1,
-			},
-			.imageOffset{ .x = 0, .y = 0, .z = 0 },
-			.imageExtent{
-				.width = target.extent.width,
-				.height = target.extent.height,
-				.depth = 1
-			},
-		};	// describes what part of the image to copy
+	{	//copy the source buffer to the image, one region per layer (e.g., cube face)
+		std::vector< VkBufferImageCopy > regions;
+		for (uint32_t layer = 0; layer < target.arrayLayers; ++layer) {
+			regions.emplace_back(VkBufferImageCopy{
+				.bufferOffset = space.offset + layer * layer_size,
+				.bufferRowLength = target.extent.width,
+				.bufferImageHeight = target.extent.height,
+				.imageSubresource{
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel = 0,
+					.baseArrayLayer = layer,
+					.layerCount = 1,
+				},
+				.imageOffset{ .x = 0, .y = 0, .z = 0 },
+				.imageExtent{
+					.width = target.extent.width,
+					.height = target.extent.height,
+					.depth = 1
+				},
+			});	// describes what part of the image to copy
+		}
 
 		vkCmdCopyBufferToImage(
-			transfer_command_buffer,
-			transfer_src.handle,	// the buffer to copy from
+			command_buffer,
+			space.buffer,	// the buffer to copy from
 			target.handle,	// the image to copy to
 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,	// the current format of the image
-			1, &region
+			uint32_t(regions.size()), regions.data()
 		);
 
 		// NOTE: if image had mip levels, would need to copy as additional regions here.
 	}
 
 	{	// transition the image memory to shader-read-only-optimal layout
+		// (the readers wait on upload_timeline, which orders them after this, so there is nothing to wait for here)
+		// if uploads run on another queue family, this also releases the image to the graphics family, which acquires it with the same layout change
+		bool release = uploads_change_family();
 		VkImageMemoryBarrier barrier{
 			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
 			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,	// waits until all transfer writes are complete, then transitions the image
-			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,	// allows fragment shader reads to proceed
+			.dstAccessMask = 0,
 			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 			.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.srcQueueFamilyIndex = (release ? rtg.transfer_queue_family.value() : VK_QUEUE_FAMILY_IGNORED),
+			.dstQueueFamilyIndex = (release ? rtg.graphics_queue_family.value() : VK_QUEUE_FAMILY_IGNORED),
 			.image = target.handle,
 			.subresourceRange = whole_image,
 		};
+		if (release) {
+			open_batch_acquires().images.emplace_back(barrier);
+		}
 
 		vkCmdPipelineBarrier(
-			transfer_command_buffer,	// commandBuffer
+			command_buffer,	// commandBuffer
 			VK_PIPELINE_STAGE_TRANSFER_BIT,	// srcStageMask
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,	// dstStageMask
+			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,	// dstStageMask
 			0,	// dependencyFlags
 			0, nullptr,	// memory barrier count, pointer
 			0, nullptr, // buffer memory barrier count, pointer
@@ -339,23 +660,241 @@ void Helpers::transfer_to_image(void const *data, size_t size, AllocatedImage &t
 		);
 	}
 	
-	// end and submit the command buffer
-	VK( vkEndCommandBuffer(transfer_command_buffer) );
+	return upload_submitted + 1;
+}
+
+bool Helpers::uploads_change_family() const {
+	return rtg.transfer_queue_family.value() != rtg.graphics_queue_family.value();
+}
+
+Helpers::PendingAcquires &Helpers::open_batch_acquires() {
+	uint64_t value = upload_submitted + 1;
+	if (pending_acquires.empty() || pending_acquires.back().value != value) {
+		pending_acquires.emplace_back(PendingAcquires{ .value = value });
+	}
+	return pending_acquires.back();
+}
+
+void Helpers::release_buffer(VkCommandBuffer command_buffer, AllocatedBuffer const &target, VkDeviceSize offset, VkDeviceSize size) {
+	// (on the same queue family, waiting on upload_timeline is all the readers need)
+	if (!uploads_change_family()) return;
+
+	VkBufferMemoryBarrier barrier{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = 0,
+		.srcQueueFamilyIndex = rtg.transfer_queue_family.value(),
+		.dstQueueFamilyIndex = rtg.graphics_queue_family.value(),
+		.buffer = target.handle,
+		.offset = offset,
+		.size = size,
+	};
+	vkCmdPipelineBarrier(
+		command_buffer,	// commandBuffer
+		VK_PIPELINE_STAGE_TRANSFER_BIT,	// srcStageMask
+		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,	// dstStageMask
+		0,	// dependencyFlags
+		0, nullptr,	// memory barrier count, pointer
+		1, &barrier, // buffer memory barrier count, pointer
+		0, nullptr // image memory barrier count, pointer
+	);
+
+	open_batch_acquires().buffers.emplace_back(barrier);
+}
+
+void Helpers::acquire_uploads(VkCommandBuffer command_buffer, uint64_t value, VkPipelineStageFlags stages) {
+	std::vector< VkBufferMemoryBarrier > buffers;
+	std::vector< VkImageMemoryBarrier > images;
+	while (!pending_acquires.empty() && pending_acquires.front().value <= value) {
+		PendingAcquires &acquires = pending_acquires.front();
+		buffers.insert(buffers.end(), acquires.buffers.begin(), acquires.buffers.end());
+		images.insert(images.end(), acquires.images.begin(), acquires.images.end());
+		pending_acquires.pop_front();
+	}
+	if (buffers.empty() && images.empty()) return;
+
+	// the acquire barriers repeat their releases, but with access masks for this side of the transfer:
+	for (VkBufferMemoryBarrier &barrier : buffers) {
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+	}
+	for (VkImageMemoryBarrier &barrier : images) {
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	}
+
+	vkCmdPipelineBarrier(
+		command_buffer,	// commandBuffer
+		stages,	// srcStageMask (the stages that wait on upload_timeline, so this comes after the wait)
+		stages,	// dstStageMask
+		0,	// dependencyFlags
+		0, nullptr,	// memory barrier count, pointer
+		uint32_t(buffers.size()), buffers.data(), // buffer memory barrier count, pointer
+		uint32_t(images.size()), images.data() // image memory barrier count, pointer
+	);
+}
+
+Helpers::StagingSpace Helpers::stage(size_t size, VkDeviceSize alignment) {
+	assert(size > 0);
+
+	// get a big enough batch going before adding to it, so the copies overlap with whatever the caller does next:
+	if (upload_batch_bytes >= staging_ring.size / 4) flush_uploads();
+	upload_batch_bytes += size;
+
+	if (size > staging_ring.size) {
+		// too big for the ring; use a one-off buffer, freed along with the batch:
+		AllocatedBuffer buffer = create_buffer(
+			size,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			Mapped,
+			MemoryCategory::Staging
+		);
+		StagingSpace space{ .buffer = buffer.handle, .offset = 0, .data = buffer.allocation.data() };
+		destroy_buffer_after(upload_submitted + 1, std::move(buffer));
+		return space;
+	}
+
+	// regions go around the ring in order; the free space is after staging_head, up to (and, wrapping around, before) the oldest region:
+	VkDeviceSize offset = 0;
+	for (;;) {
+		if (staging_regions.empty()) staging_head = 0;
+		offset = (staging_head + alignment - 1) / alignment * alignment;
+
+		if (staging_regions.empty()) break; //(size fits in an empty ring)
+		VkDeviceSize tail = staging_regions.front().begin;
+		if (staging_head > tail) {
+			if (offset + size <= staging_ring.size) break;
+			if (size < tail) { offset = 0; break; } //wrap around
+		} else {
+			//(strictly less, so a full ring never has staging_head == tail)
+			if (offset + size < tail) break;
+		}
+
+		// no room; wait for the oldest region to be copied from (which submits the open batch, if it is that one):
+		wait_for_upload(staging_regions.front().value);
+	}
+
+	uint64_t value = upload_submitted + 1;
+	if (!staging_regions.empty() && staging_regions.back().value == value && staging_regions.back().end <= offset) {
+		staging_regions.back().end = offset + size;
+	} else {
+		staging_regions.emplace_back(StagingRegion{ .value = value, .begin = offset, .end = offset + size });
+	}
+	staging_head = offset + size;
+
+	return StagingSpace{
+		.buffer = staging_ring.handle,
+		.offset = offset,
+		.data = reinterpret_cast< char * >(staging_ring.allocation.data()) + offset,
+	};
+}
+
+VkCommandBuffer Helpers::begin_upload() {
+	if (upload_batch != VK_NULL_HANDLE) return upload_batch;
+
+	VkCommandBufferAllocateInfo alloc_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.commandPool = transfer_command_pool,
+		.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandBufferCount = 1,
+	};
+	VK( vkAllocateCommandBuffers(rtg.device, &alloc_info, &upload_batch) );
+
+	VkCommandBufferBeginInfo begin_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,	// freed once the batch is done
+	};
+	VK( vkBeginCommandBuffer(upload_batch, &begin_info) );
 
+	return upload_batch;
+}
+
+uint64_t Helpers::flush_uploads() {
+	if (upload_batch == VK_NULL_HANDLE) return upload_submitted; //nothing recorded since the last flush
+
+	VK( vkEndCommandBuffer(upload_batch) );
+
+	// batches finish in submission order (they share a queue), so each one signals the next timeline value:
+	uint64_t value = ++upload_submitted;
+
+	VkTimelineSemaphoreSubmitInfo timeline_info{
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.signalSemaphoreValueCount = 1,
+		.pSignalSemaphoreValues = &value,
+	};
 	VkSubmitInfo submit_info{
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timeline_info,
 		.commandBufferCount = 1,
-		.pCommandBuffers = &transfer_command_buffer
+		.pCommandBuffers = &upload_batch,
+		.signalSemaphoreCount = 1,
+		.pSignalSemaphores = &upload_timeline,
 	};
+	VK( vkQueueSubmit(rtg.transfer_queue, 1, &submit_info, VK_NULL_HANDLE) );
+
+	pending_uploads.emplace_back(PendingUpload{ .value = value, .command_buffer = upload_batch });
+	upload_batch = VK_NULL_HANDLE;
+	upload_batch_bytes = 0;
 
-	VK( vkQueueSubmit(rtg.graphics_queue, 1, &submit_info, VK_NULL_HANDLE) );
+	return value;
+}
+
+void Helpers::destroy_buffer_after(uint64_t value, AllocatedBuffer &&buffer) {
+	if (value <= upload_completed) {
+		destroy_buffer(std::move(buffer));
+	} else {
+		pending_uploads.emplace_back(PendingUpload{ .value = value, .buffer = std::move(buffer) });
+	}
+}
+
+uint64_t Helpers::poll_uploads() {
+	flush_uploads();
+
+	if (pending_uploads.empty() && staging_regions.empty()) return upload_completed;
+
+	VK( vkGetSemaphoreCounterValue(rtg.device, upload_timeline, &upload_completed) );
+
+	// clean up after the finished uploads:
+	size_t kept = 0;
+	for (PendingUpload &pending : pending_uploads) {
+		if (pending.value <= upload_completed) {
+			if (pending.command_buffer != VK_NULL_HANDLE) {
+				vkFreeCommandBuffers(rtg.device, transfer_command_pool, 1, &pending.command_buffer);
+			}
+			if (pending.buffer.handle != VK_NULL_HANDLE) {
+				destroy_buffer(std::move(pending.buffer));
+			}
+		} else {
+			if (&pending != &pending_uploads[kept]) pending_uploads[kept] = std::move(pending);
+			kept += 1;
+		}
+	}
+	pending_uploads.resize(kept);
 
-	// wait for command buffer to finish executing
-	VK( vkQueueWaitIdle(rtg.graphics_queue) );
+	// ...and reclaim the staging space they were copying from:
+	while (!staging_regions.empty() && staging_regions.front().value <= upload_completed) {
+		staging_regions.pop_front();
+	}
 
+	return upload_completed;
+}
 
-	// destroy the source buffer
-	destroy_buffer(std::move(transfer_src));
+void Helpers::wait_for_upload(uint64_t value) {
+	if (value > upload_submitted) {
+		flush_uploads();
+	}
+	assert(value <= upload_submitted);
+	if (value > upload_completed) {
+		VkSemaphoreWaitInfo wait_info{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.semaphoreCount = 1,
+			.pSemaphores = &upload_timeline,
+			.pValues = &value,
+		};
+		VK( vkWaitSemaphores(rtg.device, &wait_info, UINT64_MAX) );
+	}
+	poll_uploads();
 }
 
 //----------------------------
@@ -412,21 +951,34 @@ Helpers::~Helpers() {
 void Helpers::create() {
 	VkCommandPoolCreateInfo create_info{
 		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-		.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-		.queueFamilyIndex = rtg.graphics_queue_family.value(),
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,	// each upload's command buffer is recorded once, then freed
+		.queueFamilyIndex = rtg.transfer_queue_family.value(),
 	};
 	VK(vkCreateCommandPool(rtg.device, &create_info, nullptr, &transfer_command_pool));
 
-	VkCommandBufferAllocateInfo alloc_info{
-		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-		.commandPool = transfer_command_pool,
-		.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-		.commandBufferCount = 1,
-	};
-	VK(vkAllocateCommandBuffers(rtg.device, &alloc_info, &transfer_command_buffer));
+	{ // every upload signals upload_timeline, which starts at 0:
+		VkSemaphoreTypeCreateInfo type_info{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue = 0,
+		};
+		VkSemaphoreCreateInfo semaphore_info{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &type_info,
+		};
+		VK(vkCreateSemaphore(rtg.device, &semaphore_info, nullptr, &upload_timeline));
+		upload_submitted = 0;
+		upload_completed = 0;
+	}
 
 	vkGetPhysicalDeviceMemoryProperties(rtg.physical_device, &memory_properties);
 
+	{ // allocate() keeps buffers and optimal-tiling images in separate blocks when this is more than 1:
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(rtg.physical_device, &properties);
+		buffer_image_granularity = properties.limits.bufferImageGranularity;
+	}
+
 	if (rtg.configuration.debug) {
 		std::cout << "Memory types:\n";
 		for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++) {
@@ -438,19 +990,51 @@ void Helpers::create() {
 			VkMemoryHeap const &heap = memory_properties.memoryHeaps[i];
 			std::cout << " [" << i << "] " << heap.size << " bytes, flags: " << string_VkMemoryHeapFlags(heap.flags) << '\n';
 		}
+		std::cout << "bufferImageGranularity: " << buffer_image_granularity << '\n';
 		std::cout.flush();
 	}
+
+	// every async upload copies from here:
+	staging_ring = create_buffer(
+		staging_ring_size,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		Mapped,
+		MemoryCategory::Staging
+	);
+	staging_head = 0;
 }
 
 void Helpers::destroy() {
-	// technically not needed since freeing the pool will free all contained buffers:
-	if (transfer_command_buffer != VK_NULL_HANDLE) {
-		vkFreeCommandBuffers(rtg.device, transfer_command_pool, 1, &transfer_command_buffer);
-		transfer_command_buffer = VK_NULL_HANDLE;
+	// let any uploads still running finish, then free their command and staging buffers:
+	if (upload_timeline != VK_NULL_HANDLE) {
+		wait_for_upload(flush_uploads());
+		assert(pending_uploads.empty() && staging_regions.empty());
+		pending_acquires.clear(); //(nothing will use the uploads now)
+
+		vkDestroySemaphore(rtg.device, upload_timeline, nullptr);
+		upload_timeline = VK_NULL_HANDLE;
 	}
 
 	if (transfer_command_pool != VK_NULL_HANDLE) {
 		vkDestroyCommandPool(rtg.device, transfer_command_pool, nullptr);
 		transfer_command_pool = VK_NULL_HANDLE;
 	}
+
+	if (staging_ring.handle != VK_NULL_HANDLE) {
+		destroy_buffer(std::move(staging_ring));
+	}
+
+	// (everything allocated should have been freed by now, leaving only the blocks kept around for reuse)
+	if (memory_stats.sub_allocations != 0 || memory_stats.dedicated != 0) {
+		std::cerr << "Destroying Helpers with " << memory_stats.sub_allocations << " sub-allocations and " << memory_stats.dedicated << " dedicated allocations still live; device memory will leak." << std::endl;
+	}
+	for (auto &b : memory_blocks) {
+		if (b->mapped) vkUnmapMemory(rtg.device, b->handle);
+		vkFreeMemory(rtg.device, b->handle, nullptr);
+		count_heap_bytes(b->memory_type_index, b->size, false);
+	}
+	memory_blocks.clear();
+	memory_stats.blocks = 0;
+	memory_stats.block_bytes = 0;
 }
\ No newline at end of file
@@ -3,7 +3,11 @@
 #include <vulkan/vulkan_core.h>
 
 #include <cstddef>
+#include <deque>
 #include <fstream>
+#include <iosfwd>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -14,6 +18,19 @@ struct Helpers {
 	//-----------------------
 	//memory allocation:
 
+	//what an allocation is for, so memory use can be reported by category (see report_memory):
+	enum class MemoryCategory : uint32_t {
+		Uncategorized = 0,
+		SceneVertices, //scene (and built-in object) vertex and index buffers
+		Textures, //material textures and normal maps
+		Cubemaps,
+		Workspace, //per-workspace uniform, storage, and streamed vertex buffers
+		Swapchain, //depth buffer and headless swapchain images
+		Staging, //upload staging ring and one-off staging buffers
+		Count
+	};
+	static char const *memory_category_name(MemoryCategory category);
+
 	//An owning reference to (part of) a slab of device memory:
 	struct Allocation {
 		VkDeviceMemory handle = VK_NULL_HANDLE;
@@ -22,6 +39,10 @@ struct Helpers {
 		void *mapped = nullptr;
 		void *data() const { return reinterpret_cast< char * >(mapped) + offset; } //get pointer to beginning of allocation, taking offset into account
 
+		//bookkeeping for memory_stats:
+		uint32_t memory_type_index = 0;
+		MemoryCategory category = MemoryCategory::Uncategorized;
+
 		//Call an all-zero (no handle, offset, size, mapped) Allocation "empty":
 		Allocation() = default; //default-constructed Allocation is empty
 		Allocation(Allocation &&); //swaps contents with moved-from Allocation.
@@ -34,15 +55,78 @@ struct Helpers {
 		Mapped = 1,
 	};
 
+	//what will be bound to an allocation; linear and optimal resources never share a memory block,
+	// so neighbouring allocations always respect bufferImageGranularity:
+	enum ResourceKind {
+		Linear = 0, //buffers and VK_IMAGE_TILING_LINEAR images
+		Optimal = 1, //VK_IMAGE_TILING_OPTIMAL images
+	};
+
 	// allocate a block of requested size and alignment from a memory with the given type index:
-	Allocation allocate(VkDeviceSize size, VkDeviceSize alignement, uint32_t memory_type_index, MapFlag map = Unmapped);
+	// (sub-allocated from a shared MemoryBlock, unless it is large enough to get its own VkDeviceMemory)
+	Allocation allocate(VkDeviceSize size, VkDeviceSize alignement, uint32_t memory_type_index, MapFlag map = Unmapped, ResourceKind kind = Linear);
 
 	// allocate a block that works for a given VkMemoryRequirements and VkMemoryPropertyFlags:
-	Allocation allocate(VkMemoryRequirements const &requirements, VkMemoryPropertyFlags memory_properties, MapFlag map = Unmapped);
+	Allocation allocate(VkMemoryRequirements const &requirements, VkMemoryPropertyFlags memory_properties, MapFlag map = Unmapped, ResourceKind kind = Linear);
+
+	// allocate memory for (but don't bind) an image, giving it a dedicated allocation if the driver prefers one:
+	Allocation allocate_image_memory(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags memory_properties, MapFlag map = Unmapped);
 
 	// free an allocated block:
 	void free(Allocation &&allocation);
 
+	//a large VkDeviceMemory that allocations of one memory type and ResourceKind are carved out of:
+	struct MemoryBlock {
+		VkDeviceMemory handle = VK_NULL_HANDLE;
+		VkDeviceSize size = 0;
+		uint32_t memory_type_index = 0;
+		ResourceKind kind = Linear;
+		void *mapped = nullptr; //blocks of HOST_VISIBLE types stay mapped for their whole life
+
+		//free ranges, indexed both ways: by offset (to merge neighbours on free) and by size (for best-fit allocation):
+		std::map< VkDeviceSize, VkDeviceSize > free_by_offset; //offset -> size
+		std::multimap< VkDeviceSize, VkDeviceSize > free_by_size; //size -> offset
+		uint32_t allocations = 0; //ranges currently handed out
+		VkDeviceSize used = 0; //bytes in those ranges
+
+		//take [offset, offset+size) out of the free ranges, or return false if nothing fits:
+		bool take(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset);
+		//give back [offset, offset+size):
+		void give(VkDeviceSize offset, VkDeviceSize size);
+	};
+	std::vector< std::unique_ptr< MemoryBlock > > memory_blocks;
+
+	//allocation with its own VkDeviceMemory (for large resources; image may be passed to mark it as dedicated to that image):
+	Allocation allocate_dedicated(VkDeviceSize size, uint32_t memory_type_index, MapFlag map, VkImage image = VK_NULL_HANDLE);
+
+	VkDeviceSize block_size(uint32_t memory_type_index) const; //size of new blocks for a memory type
+	VkDeviceSize buffer_image_granularity = 1; //from the physical device limits
+
+	struct MemoryStats {
+		uint32_t blocks = 0; //VkDeviceMemory objects backing sub-allocations
+		VkDeviceSize block_bytes = 0;
+		uint32_t sub_allocations = 0;
+		VkDeviceSize sub_allocated_bytes = 0;
+		uint32_t dedicated = 0; //allocations with their own VkDeviceMemory
+		VkDeviceSize dedicated_bytes = 0;
+		uint32_t peak_device_memory_objects = 0; //most VkDeviceMemory objects alive at once
+
+		VkDeviceSize heap_bytes[VK_MAX_MEMORY_HEAPS] = {}; //VkDeviceMemory (blocks and dedicated) allocated from each heap
+		VkDeviceSize peak_heap_bytes[VK_MAX_MEMORY_HEAPS] = {};
+
+		struct Category {
+			uint32_t allocations = 0;
+			VkDeviceSize bytes = 0;
+			VkDeviceSize peak_bytes = 0;
+		} categories[size_t(MemoryCategory::Count)];
+	} memory_stats;
+	void count_heap_bytes(uint32_t memory_type_index, VkDeviceSize size, bool allocated); //(on every vkAllocateMemory/vkFreeMemory)
+	void count_allocation(Allocation const &allocation, bool allocated); //(add to or remove from its category's counts)
+	void set_category(Allocation &allocation, MemoryCategory category); //count allocation under category instead
+	//print memory_stats: use by category, and per heap, what we've allocated next to the driver's budget and usage
+	// (the latter from VK_EXT_memory_budget, if rtg.memory_budget_supported), then a line per block:
+	void report_memory(std::ostream &out) const;
+
 	//specializations that also create a buffer or image (respectively):
 	struct AllocatedBuffer {
 		VkBuffer handle = VK_NULL_HANDLE;
@@ -51,7 +135,7 @@ struct Helpers {
 
 		//NOTE: could define default constructor, move constructor, move assignment, destructor for a bit more paranoia
 	};
-	AllocatedBuffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map = Unmapped);
+	AllocatedBuffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map = Unmapped, MemoryCategory category = MemoryCategory::Uncategorized);
 	void destroy_buffer(AllocatedBuffer &&allocated_buffer);
 
 	struct AllocatedImage {
@@ -65,10 +149,10 @@ struct Helpers {
 		// A2-env, cubemap support
 		uint32_t arrayLayers = 1;
 	};
-	AllocatedImage create_image(VkExtent2D const &extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map = Unmapped);
+	AllocatedImage create_image(VkExtent2D const &extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map = Unmapped, MemoryCategory category = MemoryCategory::Uncategorized);
 
 	// A2-env, cubemap support
-	AllocatedImage create_cube_image(VkExtent2D const &extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map = Unmapped);
+	AllocatedImage create_cube_image(VkExtent2D const &extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map = Unmapped, MemoryCategory category = MemoryCategory::Uncategorized);
 
 	void destroy_image(AllocatedImage &&allocated_image); 
 	
@@ -76,15 +160,88 @@ struct Helpers {
 	//-----------------------
 	//CPU -> GPU data transfer:
 
-	// NOTE: synchronizes *hard* against the GPU; inefficient to use for streaming data!
+	// NOTE: waits for the copy to finish; fine for small one-off uploads, but use the _async versions for streaming data!
 	void transfer_to_buffer(void const *data, size_t size, AllocatedBuffer &target);
+	// (same, but from a host-visible TRANSFER_SRC buffer that has already been filled, e.g. written in place through its mapping)
+	void transfer_to_buffer(AllocatedBuffer const &transfer_src, size_t size, AllocatedBuffer &target);
 	void transfer_to_image(void const *data, size_t size, AllocatedImage &image); //NOTE: image layout after call is VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
 
 	// A2-env, cubemap support
 	void transfer_to_cube_image(void const *data, size_t size, AllocatedImage &image);
 
+	//asynchronous versions: copy data into staging_ring, record the copy into the open upload batch, and return right away
+	// with the value upload_timeline will reach once it is done; the data may not be used (nor transfer_src freed) before then:
+	// (the batch is submitted by flush_uploads, which poll_uploads and wait_for_upload call, or once it has staged enough bytes)
+	uint64_t transfer_to_buffer_async(void const *data, size_t size, AllocatedBuffer &target, VkDeviceSize target_offset = 0);
+	uint64_t transfer_to_buffer_async(AllocatedBuffer const &transfer_src, VkBufferCopy const &region, AllocatedBuffer &target);
+	uint64_t transfer_to_image_async(void const *data, size_t size, AllocatedImage &image); //copies every array layer, one after another in data; same final layout as transfer_to_image
+
+	//a timeline semaphore signalled by every upload batch in turn:
+	// (so work that reads an upload must wait for upload_timeline to reach its value, e.g. as a wait semaphore of its submit)
+	VkSemaphore upload_timeline = VK_NULL_HANDLE;
+	uint64_t upload_submitted = 0; //value the most recently submitted batch will signal (the open batch will signal upload_submitted + 1)
+	uint64_t upload_completed = 0; //value of upload_timeline when it was last checked
+
+	uint64_t flush_uploads(); //submit the open batch (if any); returns upload_submitted
+	uint64_t poll_uploads(); //flush, then update upload_completed (and clean up after finished uploads); returns upload_completed
+	void wait_for_upload(uint64_t value); //block until upload_timeline reaches value
+	void destroy_buffer_after(uint64_t value, AllocatedBuffer &&buffer); //destroy buffer once upload_timeline reaches value
+
 	VkCommandPool transfer_command_pool = VK_NULL_HANDLE;
-	VkCommandBuffer transfer_command_buffer	= VK_NULL_HANDLE;
+
+	//command buffers (and one-off staging buffers) of uploads that may still be running:
+	struct PendingUpload {
+		uint64_t value = 0;
+		VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+		AllocatedBuffer buffer;
+	};
+	std::vector< PendingUpload > pending_uploads;
+
+	//the batch of uploads being recorded:
+	VkCommandBuffer upload_batch = VK_NULL_HANDLE;
+	VkDeviceSize upload_batch_bytes = 0; //staged by the batch so far
+
+	VkCommandBuffer begin_upload(); //the open batch's command buffer (allocating and beginning one if there is no open batch)
+
+	//persistently mapped staging memory, handed out front to back and reclaimed as upload_timeline passes each region's value:
+	VkDeviceSize staging_ring_size = VkDeviceSize(64) << 20;
+	AllocatedBuffer staging_ring;
+	VkDeviceSize staging_head = 0; //where the next region starts (before alignment)
+	struct StagingRegion {
+		uint64_t value = 0; //upload_timeline value after which [begin, end) is free again
+		VkDeviceSize begin = 0, end = 0;
+	};
+	std::deque< StagingRegion > staging_regions; //oldest first
+
+	//space for size bytes of upload data, to be copied from by the open batch:
+	// (waits for older uploads if the ring is full; uploads larger than the ring get a one-off buffer)
+	struct StagingSpace {
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		void *data = nullptr;
+	};
+	StagingSpace stage(size_t size, VkDeviceSize alignment);
+
+	//the asynchronous buffer upload of space that the caller got from stage() and filled in place (e.g., by jobs writing straight into it):
+	// (region.srcOffset is relative to space.offset; every copy from space must be recorded before anything else is staged or
+	//  flushed, since space is only held for the open batch)
+	uint64_t transfer_to_buffer_async(StagingSpace const &space, VkBufferCopy const &region, AllocatedBuffer &target);
+
+	//if rtg.transfer_queue_family isn't the graphics family, each batch releases its targets to the graphics family with
+	// queue family ownership transfer barriers, and the graphics queue must acquire them before their first use:
+	struct PendingAcquires {
+		uint64_t value = 0; //value of the batch that released these
+		std::vector< VkBufferMemoryBarrier > buffers;
+		std::vector< VkImageMemoryBarrier > images;
+	};
+	std::deque< PendingAcquires > pending_acquires; //oldest first
+	bool uploads_change_family() const; //true if uploads need ownership transfers at all
+	PendingAcquires &open_batch_acquires(); //(the entry for the open batch's targets)
+	void release_buffer(VkCommandBuffer command_buffer, AllocatedBuffer const &target, VkDeviceSize offset, VkDeviceSize size); //(after a copy to target)
+
+	//record the acquire half of the ownership transfer of every upload up to value into command_buffer
+	// (which must run on the graphics queue, waiting on upload_timeline for value at stages); does nothing if uploads don't change family:
+	void acquire_uploads(VkCommandBuffer command_buffer, uint64_t value, VkPipelineStageFlags stages);
 
 	//-----------------------
 	//Misc utilities:
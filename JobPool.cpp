@@ -0,0 +1,32 @@
+#include "JobPool.hpp"
+
+JobPool::JobPool(uint32_t threads) {
+	if (threads == 0) threads = 1;
+	workers.reserve(threads);
+	for (uint32_t i = 0; i < threads; ++i) {
+		workers.emplace_back([this]() {
+			while (true) {
+				std::function< void() > job;
+				{
+					std::unique_lock< std::mutex > lock(mutex);
+					wake.wait(lock, [this]() { return quit || !queue.empty(); });
+					if (queue.empty()) return; //(only when quitting)
+					job = std::move(queue.front());
+					queue.pop_front();
+				}
+				job(); //(packaged_task stores any exception in the job's future)
+			}
+		});
+	}
+}
+
+JobPool::~JobPool() {
+	{
+		std::lock_guard< std::mutex > lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for (auto &worker : workers) {
+		worker.join();
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+//A fixed set of worker threads that run queued jobs in the order they were submitted.
+// (Used at startup to read files, decode images, and repack vertices while the main thread does the uploads.)
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct JobPool {
+	explicit JobPool(uint32_t threads); //starts max(threads, 1) workers
+	~JobPool(); //finishes the queued jobs, then joins the workers
+
+	//no copies or moves (the workers point at *this):
+	JobPool(JobPool const &) = delete;
+	JobPool &operator=(JobPool const &) = delete;
+
+	//queue a job; the returned future holds its result (or the exception it threw):
+	template< typename F >
+	std::future< std::invoke_result_t< F > > submit(F &&job) {
+		using Result = std::invoke_result_t< F >;
+		//(packaged_task can't be copied, but std::function needs a copyable callable)
+		auto task = std::make_shared< std::packaged_task< Result() > >(std::forward< F >(job));
+		std::future< Result > result = task->get_future();
+		{
+			std::lock_guard< std::mutex > lock(mutex);
+			queue.emplace_back([task]() { (*task)(); });
+		}
+		wake.notify_one();
+		return result;
+	}
+
+	std::vector< std::thread > workers;
+
+	std::mutex mutex; //guards queue and quit
+	std::condition_variable wake; //signal'd when a job is queued or quit is set
+	std::deque< std::function< void() > > queue;
+	bool quit = false;
+};
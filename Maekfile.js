@@ -26,16 +26,31 @@ custom_flags_and_rules();
 
 //maek.CPP(...) builds a c++ file:
 // it returns the path to the output object file
+
+//(shared with the benchmark tools below)
+const sejp_obj = maek.CPP('sejp.cpp');
+const s72_objs = [
+	maek.CPP('S72.cpp'),
+	maek.CPP('S72-cache.cpp'),
+	maek.CPP('S72-dense.cpp'),
+	maek.CPP('MappedFile.cpp'),
+	sejp_obj,
+];
+
 const main_objs = [
 	maek.CPP('print_scene.cpp'),
-	maek.CPP('S72.cpp'),
-	maek.CPP('sejp.cpp'),
+	...s72_objs,
 	maek.CPP('Tutorial.cpp'),
+	maek.CPP('JobPool.cpp'),
 	maek.CPP('PosColVertex.cpp'),
 	maek.CPP('PosNorTexVertex.cpp'),
+	maek.CPP('PackedVertex.cpp'),
 	maek.CPP('RTG.cpp'),
 	maek.CPP('Helpers.cpp'),
 	maek.CPP('SceneViewer/SceneViewer.cpp'),
+	maek.CPP('SceneViewer/SceneMeshes.cpp'),
+	maek.CPP('mesh_optimize.cpp'),
+	maek.CPP('vertex_convert.cpp'),
 	maek.CPP('Materials/Materials.cpp'),
 	maek.CPP('main.cpp'),
 ];
@@ -83,8 +98,14 @@ const main_exe = maek.LINK([...main_objs], 'bin/viewer');
 // A2-diffuse: standalone cube convolution utility
 const cube_exe = maek.LINK([maek.CPP('Materials/cube.cpp')], 'bin/cube');
 
+// JSON parser benchmark (buffer vs. std::istream parsing)
+const sejp_bench_exe = maek.LINK([maek.CPP('sejp-bench.cpp'), sejp_obj], 'bin/sejp-bench');
+
+// s72 startup benchmark (parsing vs. compiled scene cache)
+const s72_bench_exe = maek.LINK([maek.CPP('s72-bench.cpp'), ...s72_objs], 'bin/s72-bench');
+
 //default targets:
-maek.TARGETS = [main_exe, cube_exe];
+maek.TARGETS = [main_exe, cube_exe, sejp_bench_exe, s72_bench_exe];
 
 //- - - - - - - - - - - - - - - - - - - - -
 function custom_flags_and_rules() {
@@ -113,6 +134,7 @@ function custom_flags_and_rules() {
 			`-L${GLFW_DIR}/lib`,
 			'-lX11',
 			`-lglfw3`,
+			'-pthread', //for S72::load's loading threads
 		];
 
 	} else if (maek.OS === 'windows') {
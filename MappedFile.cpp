@@ -0,0 +1,119 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(std::string const &filename) {
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("failed to open '" + filename + "' for reading.");
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size)) {
+		CloseHandle(file);
+		throw std::runtime_error("failed to get size of '" + filename + "'.");
+	}
+	size = size_t(file_size.QuadPart);
+
+	//(can't map an empty file, but there's nothing to map anyway)
+	if (size != 0) {
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) {
+			data = static_cast< char const * >(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		}
+	}
+	CloseHandle(file); //(the mapping keeps the file open)
+
+	if (size != 0 && !data) {
+		if (mapping) CloseHandle(mapping);
+		mapping = nullptr;
+		size = 0;
+		throw std::runtime_error("failed to map '" + filename + "'.");
+	}
+}
+
+void MappedFile::unmap() {
+	if (data) UnmapViewOfFile(data);
+	if (mapping) CloseHandle(mapping);
+	data = nullptr;
+	size = 0;
+	mapping = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile &&from) {
+	std::swap(data, from.data);
+	std::swap(size, from.size);
+	std::swap(mapping, from.mapping);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&from) {
+	if (this == &from) return *this;
+	unmap();
+	std::swap(data, from.data);
+	std::swap(size, from.size);
+	std::swap(mapping, from.mapping);
+	return *this;
+}
+
+#else
+
+MappedFile::MappedFile(std::string const &filename) {
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("failed to open '" + filename + "' for reading.");
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		throw std::runtime_error("failed to get size of '" + filename + "'.");
+	}
+	size = size_t(info.st_size);
+
+	//(can't map an empty file, but there's nothing to map anyway)
+	if (size != 0) {
+		void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped == MAP_FAILED) {
+			close(fd);
+			size = 0;
+			throw std::runtime_error("failed to map '" + filename + "'.");
+		}
+		data = static_cast< char const * >(mapped);
+	}
+	close(fd); //(the mapping keeps the file open)
+}
+
+void MappedFile::unmap() {
+	if (data) munmap(const_cast< char * >(data), size);
+	data = nullptr;
+	size = 0;
+}
+
+MappedFile::MappedFile(MappedFile &&from) {
+	std::swap(data, from.data);
+	std::swap(size, from.size);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&from) {
+	if (this == &from) return *this;
+	unmap();
+	std::swap(data, from.data);
+	std::swap(size, from.size);
+	return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	unmap();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+//A read-only memory mapping of a whole file.
+// (The OS pages the file in as it is read, and the pages can be shared with other processes and the file cache.)
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+struct MappedFile {
+	MappedFile() = default; //empty (nothing mapped)
+	explicit MappedFile(std::string const &filename); //NOTE: throws on error
+	~MappedFile();
+
+	//no copies, but moves are okay:
+	MappedFile(MappedFile const &) = delete;
+	MappedFile &operator=(MappedFile const &) = delete;
+	MappedFile(MappedFile &&);
+	MappedFile &operator=(MappedFile &&);
+
+	char const *data = nullptr; //NOTE: nullptr for an empty file
+	size_t size = 0;
+
+	std::string_view view() const { return std::string_view(data, size); }
+
+	void unmap(); //release the mapping (leaving *this empty)
+
+#if defined(_WIN32)
+	void *mapping = nullptr; //HANDLE from CreateFileMapping
+#endif
+};
@@ -5,16 +5,16 @@
 
 #include "../SceneViewer/stb_image.h"
 
-#include <vulkan/utility/vk_format_utils.h>
-
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstring>
 #include <iostream>
 #include <array>
+#include <future>
 #include <memory>
 
-Helpers::AllocatedImage Helpers::create_cube_image(VkExtent2D const &extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map)
+Helpers::AllocatedImage Helpers::create_cube_image(VkExtent2D const &extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MapFlag map, MemoryCategory category)
 {
 	AllocatedImage image;
 	image.extent = extent;
@@ -42,10 +42,8 @@ Helpers::AllocatedImage Helpers::create_cube_image(VkExtent2D const &extent, VkF
 
 	VK(vkCreateImage(rtg.device, &create_info, nullptr, &image.handle));
 
-	VkMemoryRequirements req;
-	vkGetImageMemoryRequirements(rtg.device, image.handle, &req);
-
-	image.allocation = allocate(req, properties, map);
+	image.allocation = allocate_image_memory(image.handle, tiling, properties, map);
+	set_category(image.allocation, category);
 
 	VK(vkBindImageMemory(rtg.device, image.handle, image.allocation.handle, image.allocation.offset));
 
@@ -57,129 +55,137 @@ void Helpers::transfer_to_cube_image(void const *data, size_t size, Helpers::All
 	assert(target.handle != VK_NULL_HANDLE);
 	assert(target.arrayLayers == 6);
 
-	size_t bytes_per_block = vkuFormatTexelBlockSize(target.format);
-	size_t texels_per_block = vkuFormatTexelsPerBlock(target.format);
-	size_t face_size = target.extent.width * target.extent.height * bytes_per_block / texels_per_block;
-	assert(size == face_size * 6);
+	// data layout: [face0][face1][face2][face3][face4][face5], which the image upload copies one layer at a time
+	transfer_to_image(data, size, target);
+}
+
+// Derive a lambertian cubemap's path from its radiance cubemap's path: replace ".png" with ".lambertian.png"
+static std::string lambertian_cubemap_path(std::string const &rad_path)
+{
+	auto dot_pos = rad_path.rfind(".png");
+	if (dot_pos != std::string::npos) {
+		return rad_path.substr(0, dot_pos) + ".lambertian.png";
+	} else {
+		return rad_path + ".lambertian.png";
+	}
+}
+
+Tutorial::DecodedImage Tutorial::decode_image(std::string const &path, bool rgbe)
+{
+	DecodedImage image;
 
-	AllocatedBuffer transfer_src = create_buffer(
-		size,
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		Mapped
+	int img_w = 0, img_h = 0;
+	image.rgba = std::unique_ptr<unsigned char, void(*)(void*)>(
+		stbi_load(path.c_str(), &img_w, &img_h, nullptr, 4),
+		[](void *p) { stbi_image_free(p); }
 	);
+	if (!image.rgba) {
+		image.error = stbi_failure_reason(); // (thread-local in stb_image)
+		return image;
+	}
+	if (img_w <= 0 || img_h <= 0) {
+		image.rgba.reset();
+		image.error = "invalid image dimensions";
+		return image;
+	}
+	image.width = static_cast<uint32_t>(img_w);
+	image.height = static_cast<uint32_t>(img_h);
 
-	std::memcpy(transfer_src.allocation.data(), data, size);
+	if (rgbe) {
+		size_t total_pixels = static_cast<size_t>(image.width) * image.height;
 
-	VK( vkResetCommandBuffer(transfer_command_buffer, 0) );
+		// Decode RGBE -> RGBA32F
+		// Formula: rgb' = 2^(e-128) * (rgb + 0.5) / 256, with (0,0,0,0) -> (0,0,0)
+		image.rgba32f.resize(total_pixels * 4);
+		unsigned char const *src = image.rgba.get();
+		float *hdr_data = image.rgba32f.data();
+		for (size_t i = 0; i < total_pixels; ++i) {
+			uint8_t r = src[i * 4 + 0];
+			uint8_t g = src[i * 4 + 1];
+			uint8_t b = src[i * 4 + 2];
+			uint8_t e = src[i * 4 + 3];
 
-	VkCommandBufferBeginInfo begin_info{
-		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-	};
+			if (r == 0 && g == 0 && b == 0 && e == 0) {
+				hdr_data[i * 4 + 0] = 0.0f;
+				hdr_data[i * 4 + 1] = 0.0f;
+				hdr_data[i * 4 + 2] = 0.0f;
+			} else {
+				float scale = std::ldexp(1.0f, static_cast<int>(e) - 128) / 256.0f;
+				hdr_data[i * 4 + 0] = (r + 0.5f) * scale;
+				hdr_data[i * 4 + 1] = (g + 0.5f) * scale;
+				hdr_data[i * 4 + 2] = (b + 0.5f) * scale;
+			}
+			hdr_data[i * 4 + 3] = 1.0f;
+		}
+		image.rgba.reset();
+	}
 
-	VK( vkBeginCommandBuffer(transfer_command_buffer, &begin_info) );
+	return image;
+}
 
-	VkImageSubresourceRange whole_image{
-		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-		.baseMipLevel = 0,
-		.levelCount = 1,
-		.baseArrayLayer = 0,
-		.layerCount = 6,
+void Tutorial::start_image_decodes(JobPool &jobs)
+{
+	auto queue = [&](std::string const &path, bool rgbe) {
+		auto key = std::make_pair(path, rgbe);
+		if (image_decodes.count(key)) return; // (textures shared by several materials are decoded once)
+		image_decodes.emplace(key, jobs.submit([path, rgbe]() {
+			return decode_image(path, rgbe);
+		}).share());
 	};
 
-	{	// transition all 6 faces to transfer-dst layout
-		VkImageMemoryBarrier barrier{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			.srcAccessMask = 0,
-			.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-			.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.image = target.handle,
-			.subresourceRange = whole_image,
-		};
+	// queued in the order they are uploaded, so the first uploads wait the least:
 
-		vkCmdPipelineBarrier(
-			transfer_command_buffer,
-			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &barrier
-		);
+	// albedo textures (see build_scene_materials)
+	for (auto const &it : scene_S72.materials)
+	{
+		if (auto lamb = std::get_if<S72::Material::Lambertian>(&it.second.brdf))
+		{
+			if (auto tex = std::get_if<S72::Texture *>(&lamb->albedo))
+			{
+				if (*tex != nullptr
+					&& (*tex)->type == S72::Texture::Type::flat
+					&& (*tex)->format != S72::Texture::Format::rgbe)
+				{
+					queue((*tex)->path, false);
+				}
+			}
+		}
 	}
 
-	{	// copy buffer data to all 6 faces
-		// data layout in buffer: [face0][face1][face2][face3][face4][face5]
-		std::array<VkBufferImageCopy, 6> regions;
-		for (uint32_t face = 0; face < 6; ++face) {
-			regions[face] = VkBufferImageCopy{
-				.bufferOffset = face * face_size,
-				.bufferRowLength = target.extent.width,
-				.bufferImageHeight = target.extent.height,
-				.imageSubresource{
-					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-					.mipLevel = 0,
-					.baseArrayLayer = face,
-					.layerCount = 1,
-				},
-				.imageOffset{ .x = 0, .y = 0, .z = 0 },
-				.imageExtent{
-					.width = target.extent.width,
-					.height = target.extent.height,
-					.depth = 1
-				},
-			};
+	// normal maps (see build_normal_map_textures)
+	for (auto const &it : scene_S72.materials)
+	{
+		if (it.second.normal_map != nullptr
+			&& it.second.normal_map->type == S72::Texture::Type::flat)
+		{
+			queue(it.second.normal_map->path, false);
 		}
-
-		vkCmdCopyBufferToImage(
-			transfer_command_buffer,
-			transfer_src.handle,
-			target.handle,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			uint32_t(regions.size()), regions.data()
-		);
 	}
 
-	{	// transition all 6 faces to shader-read-only layout
-		VkImageMemoryBarrier barrier{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.image = target.handle,
-			.subresourceRange = whole_image,
-		};
-
-		vkCmdPipelineBarrier(
-			transfer_command_buffer,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &barrier
-		);
+	// environment and lambertian cubemaps (see load_environment_cubemap and load_lambertian_cubemap)
+	for (auto const &[name, env] : scene_S72.environments)
+	{
+		if (env.radiance == nullptr) continue;
+		queue(env.radiance->path, true);
+		queue(lambertian_cubemap_path(env.radiance->path), true);
+		break;
 	}
 
-	VK( vkEndCommandBuffer(transfer_command_buffer) );
-
-	VkSubmitInfo submit_info{
-		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.commandBufferCount = 1,
-		.pCommandBuffers = &transfer_command_buffer
-	};
-
-	VK( vkQueueSubmit(rtg.graphics_queue, 1, &submit_info, VK_NULL_HANDLE) );
-	VK( vkQueueWaitIdle(rtg.graphics_queue) );
+	std::cout << "[Materials.cpp]: Queued " << image_decodes.size() << " image decode(s) on "
+		<< jobs.workers.size() << " loader thread(s)." << std::endl;
+}
 
-	destroy_buffer(std::move(transfer_src));
+Tutorial::DecodedImage const &Tutorial::decoded_image(std::string const &path, bool rgbe)
+{
+	auto key = std::make_pair(path, rgbe);
+	auto f = image_decodes.find(key);
+	if (f == image_decodes.end()) {
+		// not queued, so decode it (on this thread) when waited for:
+		f = image_decodes.emplace(key, std::async(std::launch::deferred, [path, rgbe]() {
+			return decode_image(path, rgbe);
+		}).share()).first;
+	}
+	return f->second.get();
 }
 
 void Tutorial::load_environment_cubemap()
@@ -199,52 +205,24 @@ void Tutorial::load_environment_cubemap()
 		assert(env.radiance->type == S72::Texture::Type::cube);
 		assert(env.radiance->format == S72::Texture::Format::rgbe);
 
-		// Load the image (6 faces stacked vertically in a single PNG)
-		int img_w = 0, img_h = 0;
-		std::unique_ptr<unsigned char, void(*)(void*)> pixels(
-			stbi_load(env.radiance->path.c_str(), &img_w, &img_h, nullptr, 4),
-			[](void *p) { stbi_image_free(p); }
-		);
+		// Wait for the image (6 faces stacked vertically in a single PNG, decoded to RGBA32F on a loader thread)
+		DecodedImage const &image = decoded_image(env.radiance->path, true);
 
-		if (!pixels) {
+		if (!image.error.empty()) {
 			std::cerr << "[Materials.cpp]: Failed to load cubemap '" << env.radiance->path
-				<< "': " << stbi_failure_reason() << std::endl;
+				<< "': " << image.error << std::endl;
 			continue;
 		}
 
 		// Expect 6 square faces stacked vertically: width = face_size, height = 6 * face_size
-		if (img_w <= 0 || img_h != img_w * 6) {
-			std::cerr << "[Materials.cpp]: Cubemap image dimensions (" << img_w << "x" << img_h
+		if (image.height != image.width * 6) {
+			std::cerr << "[Materials.cpp]: Cubemap image dimensions (" << image.width << "x" << image.height
 				<< ") don't match expected vertical strip (w x 6w)." << std::endl;
 			continue;
 		}
 
-		uint32_t face_size = static_cast<uint32_t>(img_w);
-		size_t face_pixels = static_cast<size_t>(face_size) * face_size;
-		size_t total_pixels = face_pixels * 6;
-
-		// Decode RGBE -> RGBA32F
-		// Formula: rgb' = 2^(e-128) * (rgb + 0.5) / 256, with (0,0,0,0) -> (0,0,0)
-		std::vector<float> hdr_data(total_pixels * 4);
-		unsigned char *src = pixels.get();
-		for (size_t i = 0; i < total_pixels; ++i) {
-			uint8_t r = src[i * 4 + 0];
-			uint8_t g = src[i * 4 + 1];
-			uint8_t b = src[i * 4 + 2];
-			uint8_t e = src[i * 4 + 3];
-
-			if (r == 0 && g == 0 && b == 0 && e == 0) {
-				hdr_data[i * 4 + 0] = 0.0f;
-				hdr_data[i * 4 + 1] = 0.0f;
-				hdr_data[i * 4 + 2] = 0.0f;
-			} else {
-				float scale = std::ldexp(1.0f, static_cast<int>(e) - 128) / 256.0f;
-				hdr_data[i * 4 + 0] = (r + 0.5f) * scale;
-				hdr_data[i * 4 + 1] = (g + 0.5f) * scale;
-				hdr_data[i * 4 + 2] = (b + 0.5f) * scale;
-			}
-			hdr_data[i * 4 + 3] = 1.0f;
-		}
+		uint32_t face_size = image.width;
+		std::vector<float> const &hdr_data = image.rgba32f;
 
 		// Create cubemap image on GPU
 		environment_cubemap = rtg.helpers.create_cube_image(
@@ -253,15 +231,16 @@ void Tutorial::load_environment_cubemap()
 			VK_IMAGE_TILING_OPTIMAL,
 			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			Helpers::Unmapped
+			Helpers::Unmapped,
+			Helpers::MemoryCategory::Cubemaps
 		);
 
-		// Upload all 6 faces
-		rtg.helpers.transfer_to_cube_image(
+		// Upload all 6 faces (in the background)
+		cubemap_uploads = std::max(cubemap_uploads, rtg.helpers.transfer_to_image_async(
 			hdr_data.data(),
 			hdr_data.size() * sizeof(float),
 			environment_cubemap
-		);
+		));
 
 		// Create cubemap image view (VK_IMAGE_VIEW_TYPE_CUBE with 6 layers)
 		VkImageViewCreateInfo view_info{
@@ -315,61 +294,25 @@ void Tutorial::load_lambertian_cubemap()
 	{
 		if (env.radiance == nullptr) continue;
 
-		// Derive lambertian cubemap path: replace ".png" with ".lambertian.png"
-		std::string rad_path = env.radiance->path;
-		std::string lamb_path;
-		{
-			auto dot_pos = rad_path.rfind(".png");
-			if (dot_pos != std::string::npos) {
-				lamb_path = rad_path.substr(0, dot_pos) + ".lambertian.png";
-			} else {
-				lamb_path = rad_path + ".lambertian.png";
-			}
-		}
+		std::string lamb_path = lambertian_cubemap_path(env.radiance->path);
 
-		int img_w = 0, img_h = 0;
-		std::unique_ptr<unsigned char, void(*)(void*)> pixels(
-			stbi_load(lamb_path.c_str(), &img_w, &img_h, nullptr, 4),
-			[](void *p) { stbi_image_free(p); }
-		);
+		// (decoded to RGBA32F on a loader thread, same as the environment cubemap)
+		DecodedImage const &image = decoded_image(lamb_path, true);
 
-		if (!pixels) {
+		if (!image.error.empty()) {
 			std::cerr << "[Materials.cpp]: Lambertian cubemap not found at '"
 				<< lamb_path << "' (run cube utility to generate it)." << std::endl;
 			return;
 		}
 
-		if (img_w <= 0 || img_h != img_w * 6) {
-			std::cerr << "[Materials.cpp]: Lambertian cubemap dimensions (" << img_w << "x" << img_h
+		if (image.height != image.width * 6) {
+			std::cerr << "[Materials.cpp]: Lambertian cubemap dimensions (" << image.width << "x" << image.height
 				<< ") don't match vertical strip (w x 6w)." << std::endl;
 			return;
 		}
 
-		uint32_t face_size = static_cast<uint32_t>(img_w);
-		size_t face_pixels = static_cast<size_t>(face_size) * face_size;
-		size_t total_pixels = face_pixels * 6;
-
-		// Decode RGBE -> RGBA32F (same as environment cubemap)
-		std::vector<float> hdr_data(total_pixels * 4);
-		unsigned char *src = pixels.get();
-		for (size_t i = 0; i < total_pixels; ++i) {
-			uint8_t r = src[i * 4 + 0];
-			uint8_t g = src[i * 4 + 1];
-			uint8_t b = src[i * 4 + 2];
-			uint8_t e = src[i * 4 + 3];
-
-			if (r == 0 && g == 0 && b == 0 && e == 0) {
-				hdr_data[i * 4 + 0] = 0.0f;
-				hdr_data[i * 4 + 1] = 0.0f;
-				hdr_data[i * 4 + 2] = 0.0f;
-			} else {
-				float scale = std::ldexp(1.0f, static_cast<int>(e) - 128) / 256.0f;
-				hdr_data[i * 4 + 0] = (r + 0.5f) * scale;
-				hdr_data[i * 4 + 1] = (g + 0.5f) * scale;
-				hdr_data[i * 4 + 2] = (b + 0.5f) * scale;
-			}
-			hdr_data[i * 4 + 3] = 1.0f;
-		}
+		uint32_t face_size = image.width;
+		std::vector<float> const &hdr_data = image.rgba32f;
 
 		lambertian_cubemap = rtg.helpers.create_cube_image(
 			VkExtent2D{ .width = face_size, .height = face_size },
@@ -377,14 +320,15 @@ void Tutorial::load_lambertian_cubemap()
 			VK_IMAGE_TILING_OPTIMAL,
 			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			Helpers::Unmapped
+			Helpers::Unmapped,
+			Helpers::MemoryCategory::Cubemaps
 		);
 
-		rtg.helpers.transfer_to_cube_image(
+		cubemap_uploads = std::max(cubemap_uploads, rtg.helpers.transfer_to_image_async(
 			hdr_data.data(),
 			hdr_data.size() * sizeof(float),
 			lambertian_cubemap
-		);
+		));
 
 		VkImageViewCreateInfo view_info{
 			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
@@ -427,21 +371,29 @@ void Tutorial::load_lambertian_cubemap()
 	}
 }
 
-void Tutorial::build_normal_map_textures()
+void Tutorial::build_default_normal_map()
 {
 	// Create default 1x1 normal map (flat normal pointing up in tangent space)
-	{
-		uint32_t default_pixel = 0xFFFF8080; // RGBA = (128, 128, 255, 255) -> tangent-space (0,0,1) after *2-1
-		normal_map_textures.emplace_back(rtg.helpers.create_image(
-			VkExtent2D{ .width = 1, .height = 1 },
-			VK_FORMAT_R8G8B8A8_UNORM,
-			VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			Helpers::Unmapped
-		));
-		rtg.helpers.transfer_to_image(&default_pixel, sizeof(default_pixel), normal_map_textures.back());
-	}
+	assert(normal_map_textures.empty());
+	uint32_t default_pixel = 0xFFFF8080; // RGBA = (128, 128, 255, 255) -> tangent-space (0,0,1) after *2-1
+	normal_map_textures.emplace_back(rtg.helpers.create_image(
+		VkExtent2D{ .width = 1, .height = 1 },
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		Helpers::Unmapped,
+		Helpers::MemoryCategory::Textures
+	));
+	// (uploaded up front, in the constructor's placeholder batch: it also stands in for normal maps that are still uploading)
+	rtg.helpers.transfer_to_image_async(&default_pixel, sizeof(default_pixel), normal_map_textures.back());
+	normal_map_uploads.emplace_back(0);
+}
+
+void Tutorial::build_normal_map_textures()
+{
+	// (the default normal map was made by build_default_normal_map)
+	assert(!normal_map_textures.empty());
 	const uint32_t default_normal_idx = 0;
 
 	mat_to_normal_tex.clear();
@@ -451,32 +403,29 @@ void Tutorial::build_normal_map_textures()
 			&& it.second.normal_map->type == S72::Texture::Type::flat)
 		{
 			S72::Texture *nm = it.second.normal_map;
-			int w = 0, h = 0;
-			std::unique_ptr<unsigned char, void(*)(void*)> pixels(
-				stbi_load(nm->path.c_str(), &w, &h, nullptr, 4),
-				[](void *p) { stbi_image_free(p); }
-			);
-			if (!pixels || w <= 0 || h <= 0) {
+			DecodedImage const &image = decoded_image(nm->path, false);
+			if (!image.error.empty()) {
 				std::cerr << "[Materials.cpp]: Failed to load normal map '" << nm->path
 					<< "', using default." << std::endl;
 				mat_to_normal_tex[&it.second] = default_normal_idx;
 				continue;
 			}
 
-			size_t byte_size = static_cast<size_t>(w) * static_cast<size_t>(h) * 4u;
+			size_t byte_size = static_cast<size_t>(image.width) * image.height * 4u;
 			normal_map_textures.emplace_back(rtg.helpers.create_image(
-				VkExtent2D{ .width = static_cast<uint32_t>(w), .height = static_cast<uint32_t>(h) },
+				VkExtent2D{ .width = image.width, .height = image.height },
 				VK_FORMAT_R8G8B8A8_UNORM,
 				VK_IMAGE_TILING_OPTIMAL,
 				VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
 				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				Helpers::Unmapped
+				Helpers::Unmapped,
+				Helpers::MemoryCategory::Textures
 			));
 			mat_to_normal_tex[&it.second] = uint32_t(normal_map_textures.size() - 1);
-			rtg.helpers.transfer_to_image(pixels.get(), byte_size, normal_map_textures.back());
+			normal_map_uploads.emplace_back(rtg.helpers.transfer_to_image_async(image.rgba.get(), byte_size, normal_map_textures.back()));
 
 			std::cout << "[Materials.cpp]: Loaded normal map '" << nm->path
-				<< "' (" << w << "x" << h << ")" << std::endl;
+				<< "' (" << image.width << "x" << image.height << ")" << std::endl;
 		}
 		else
 		{
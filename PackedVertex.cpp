@@ -0,0 +1,134 @@
+#include "PackedVertex.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+static std::array<VkVertexInputBindingDescription, 1> bindings {
+    VkVertexInputBindingDescription {
+        .binding = 0,
+        .stride = sizeof(PackedVertex),
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+    }
+};
+
+// (same locations as PosNorTexVertex; objects.vert decodes these when PACKED_VERTICES is set)
+static std::array<VkVertexInputAttributeDescription, 4> attributes {
+    VkVertexInputAttributeDescription {
+        .location = 0,
+        .binding = 0,
+        .format = VK_FORMAT_R16G16B16A16_UNORM,
+        .offset = offsetof(PackedVertex, Position),
+    },
+    VkVertexInputAttributeDescription{
+        .location = 1,
+        .binding = 0,
+        .format = VK_FORMAT_R16G16_SNORM,
+        .offset = offsetof(PackedVertex, Normal),
+    },
+    VkVertexInputAttributeDescription{
+        .location = 2,
+        .binding = 0,
+        .format = VK_FORMAT_R16G16_SNORM,
+        .offset = offsetof(PackedVertex, Tangent),
+    },
+    VkVertexInputAttributeDescription{
+        .location = 3,
+        .binding = 0,
+        .format = VK_FORMAT_R16G16_SFLOAT,
+        .offset = offsetof(PackedVertex, TexCoord),
+    },
+};
+
+const VkPipelineVertexInputStateCreateInfo PackedVertex::array_input_state {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+    .vertexBindingDescriptionCount = uint32_t(bindings.size()),
+    .pVertexBindingDescriptions = bindings.data(),
+    .vertexAttributeDescriptionCount = uint32_t(attributes.size()),
+    .pVertexAttributeDescriptions = attributes.data(),
+};
+
+// origin and extent of axis k of an aabb (an empty, flat, or non-finite axis gets extent 0):
+static void aabb_axis(float const min[3], float const max[3], uint32_t k, float *origin, float *extent) {
+    *origin = std::isfinite(min[k]) ? min[k] : 0.0f;
+    *extent = max[k] - *origin;
+    if (!(std::isfinite(*extent) && *extent > 0.0f)) *extent = 0.0f;
+}
+
+static uint16_t unorm16(float v) {
+    if (!(v > 0.0f)) return 0; // (including NaN)
+    return uint16_t(std::min(v, 1.0f) * 65535.0f + 0.5f);
+}
+
+static int16_t snorm16(float v) {
+    if (std::isnan(v)) return 0;
+    return int16_t(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+}
+
+// round-to-nearest-even float -> IEEE half conversion (overflows to infinity, keeps NaNs):
+static uint16_t half(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, 4);
+    uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+    uint32_t magnitude = bits & 0x7fffffff;
+
+    if (magnitude > 0x7f800000) return uint16_t(sign | 0x7e00); // NaN
+    if (magnitude >= 0x477ff000) return uint16_t(sign | 0x7c00); // rounds past 65504 (or is infinite)
+    if (magnitude < 0x38800000) {
+        // below 2^-14 is subnormal in half, in units of 2^-24 (the default rounding mode is to nearest even):
+        float a;
+        std::memcpy(&a, &magnitude, 4);
+        return uint16_t(sign | uint16_t(std::nearbyint(a * 16777216.0f)));
+    }
+    // rebias the exponent (127 -> 15) and round off the low 13 bits of the mantissa:
+    uint32_t h = (magnitude - 0x38000000) >> 13;
+    uint32_t rest = magnitude & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (h & 1))) h += 1;
+    return uint16_t(sign | h);
+}
+
+// octahedral encoding of a direction (Cigolle et al., "A Survey of Efficient Representations for Independent Unit Vectors", 2014):
+static void octahedral(float x, float y, float z, int16_t *out_x, int16_t *out_y) {
+    float l1 = std::abs(x) + std::abs(y) + std::abs(z);
+    if (!(l1 > 0.0f && std::isfinite(l1))) {
+        *out_x = *out_y = 0; // (decodes as +z)
+        return;
+    }
+    float u = x / l1, v = y / l1;
+    if (z < 0.0f) {
+        // fold the lower hemisphere over the diagonals (must match octahedral_decode in objects.vert):
+        float fu = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        float fv = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = fu;
+        v = fv;
+    }
+    *out_x = snorm16(u);
+    *out_y = snorm16(v);
+}
+
+PackedVertex PackedVertex::pack(PosNorTexVertex const &vertex, float const min[3], float const max[3]) {
+    float position[3] = {vertex.Position.x, vertex.Position.y, vertex.Position.z};
+    uint16_t quantized[3];
+    for (uint32_t k = 0; k < 3; ++k) {
+        float origin, extent;
+        aabb_axis(min, max, k, &origin, &extent);
+        quantized[k] = (extent > 0.0f ? unorm16((position[k] - origin) / extent) : 0);
+    }
+
+    PackedVertex packed{
+        .Position{.x = quantized[0], .y = quantized[1], .z = quantized[2], .w = uint16_t(vertex.Tangent.w < 0.0f ? 0 : 65535)},
+        .TexCoord{.s = half(vertex.TexCoord.s), .t = half(vertex.TexCoord.t)},
+    };
+    octahedral(vertex.Normal.x, vertex.Normal.y, vertex.Normal.z, &packed.Normal.x, &packed.Normal.y);
+    octahedral(vertex.Tangent.x, vertex.Tangent.y, vertex.Tangent.z, &packed.Tangent.x, &packed.Tangent.y);
+    return packed;
+}
+
+mat4 PackedVertex::local_from_packed(float const min[3], float const max[3]) {
+    float origin[3], extent[3];
+    for (uint32_t k = 0; k < 3; ++k) {
+        aabb_axis(min, max, k, &origin[k], &extent[k]);
+    }
+    return mat4_translation(origin[0], origin[1], origin[2]) * mat4_scale(extent[0], extent[1], extent[2]);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "PosNorTexVertex.hpp"
+#include "mat4.hpp"
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstdint>
+
+// A compressed PosNorTexVertex (used for scene meshes with --packed-vertices):
+struct PackedVertex {
+    struct {uint16_t x, y, z, w;} Position; // UNORM fraction of the mesh's aabb; .w is the bitangent sign (0 = -1, 65535 = +1)
+    struct {int16_t x, y;} Normal;          // SNORM octahedral encoding
+    struct {int16_t x, y;} Tangent;         // SNORM octahedral encoding
+    struct {uint16_t s, t;} TexCoord;       // half floats
+    static const VkPipelineVertexInputStateCreateInfo array_input_state;
+
+    // Quantize a vertex whose position lies in the aabb [min, max]:
+    static PackedVertex pack(PosNorTexVertex const &vertex, float const min[3], float const max[3]);
+
+    // The transform from (dequantized, in [0,1]) Position back to model space, for the same aabb:
+    static mat4 local_from_packed(float const min[3], float const max[3]);
+};
+
+static_assert(sizeof(PackedVertex) == 4*2 + 2*2 + 2*2 + 2*2, "PackedVertex is packed (20 bytes).");
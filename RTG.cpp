@@ -66,6 +66,37 @@ void RTG::Configuration::parse(int argc, char **argv) {
 			if (argi + 1 >= argc || scene_file.empty()) throw std::runtime_error("--cull requires a parameter (a culling mode name) and a scene file.");
 			argi += 1;
 			culling_mode = argv[argi];
+		} else if (arg == "--load-threads") {
+			if (argi + 1 >= argc) throw std::runtime_error("--load-threads requires a parameter (a number of threads).");
+			argi += 1;
+			std::string val = argv[argi];
+			if (val.empty() || val.find_first_not_of("0123456789") != std::string::npos || std::stoul(val) == 0) {
+				throw std::runtime_error("--load-threads should be a positive integer, got '" + val + "'.");
+			}
+			load_threads = uint32_t(std::stoul(val));
+		} else if (arg == "--no-scene-cache") {
+			scene_cache = false;
+		} else if (arg == "--weld") {
+			weld_vertices = true;
+		} else if (arg == "--optimize-meshes") {
+			optimize_meshes = true;
+		} else if (arg == "--packed-vertices") {
+			packed_vertices = true;
+		} else if (arg == "--lod") {
+			if (argi + 1 >= argc) throw std::runtime_error("--lod requires a parameter (a screen-space error in pixels).");
+			argi += 1;
+			lod_pixel_error = std::stof(argv[argi]);
+			if (!(lod_pixel_error > 0.0f)) throw std::runtime_error("--lod should be a positive number of pixels, got '" + std::string(argv[argi]) + "'.");
+		} else if (arg == "--job-threads") {
+			if (argi + 1 >= argc) throw std::runtime_error("--job-threads requires a parameter (a number of threads).");
+			argi += 1;
+			std::string val = argv[argi];
+			if (val.empty() || val.find_first_not_of("0123456789") != std::string::npos || std::stoul(val) == 0) {
+				throw std::runtime_error("--job-threads should be a positive integer, got '" + val + "'.");
+			}
+			job_threads = uint32_t(std::stoul(val));
+		} else if (arg == "--memory-report") {
+			memory_report = true;
 		} else if (arg == "--exposure") {
 			if (argi + 1 >= argc) throw std::runtime_error("--exposure requires a parameter (a float exponent).");
 			argi += 1;
@@ -85,6 +116,15 @@ void RTG::Configuration::usage(std::function< void(const char *, const char *) >
 	callback("--physical-device <name>", "Run on the named physical device (guesses, otherwise).");
 	callback("--drawing-size <w> <h>", "Set the size of the surface to draw to.");
 	callback("--headless", "Don't create a window; read events from stdin.");
+	callback("--culling <mode>", "Cull scene meshes with none, frustum (per object), or clusters (per object, then per meshlet).");
+	callback("--load-threads <n>", "Parse the scene file on <n> threads.");
+	callback("--no-scene-cache", "Always parse the scene file (instead of using or writing its .s72c cache).");
+	callback("--weld", "Merge identical vertices of non-indexed meshes and draw them indexed.");
+	callback("--optimize-meshes", "Reorder indexed meshes for vertex cache reuse, overdraw, and vertex fetch; report ACMR/ATVR.");
+	callback("--packed-vertices", "Store mesh vertices as 20-byte PackedVertex (quantized positions, octahedral normals and tangents, half-float texcoords) instead of 48-byte PosNorTexVertex.");
+	callback("--lod <pixels>", "Build simplified levels of detail of indexed meshes; draw each instance at the coarsest level whose error stays under <pixels> on screen.");
+	callback("--job-threads <n>", "Read and decode textures and repack meshes on <n> threads at startup (default: one per hardware thread).");
+	callback("--memory-report", "Print device memory use by category and heap (with the driver's budget, where supported) once the scene is resident; press 'M' to print it again.");
 }
 
 static VKAPI_ATTR VkBool32 VKAPI_CALL debug_callback(
@@ -344,6 +384,12 @@ RTG::RTG(Configuration const &configuration_) : helpers(*this) {
 	}
 
 	{	// create the `device` (logical interface to the GPU) and the `queue`s to which we can submit commands:
+		//uploads and compute get queues of their own if possible (so they can run alongside rendering):
+		// preferably from their own families, otherwise as extra queues from the graphics family if it has room
+		uint32_t graphics_queue_count = 1;
+		uint32_t transfer_queue_index = 0;
+		uint32_t compute_queue_index = 0;
+
 		{ //look up queue indices:
 			uint32_t count = 0;
 			vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &count, nullptr);
@@ -358,6 +404,16 @@ RTG::RTG(Configuration const &configuration_) : helpers(*this) {
 					if (!graphics_queue_family) graphics_queue_family = i;
 				}
 
+				//if it does transfers and nothing else, set the transfer queue family:
+				if ((queue_family.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queue_family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+					if (!transfer_queue_family) transfer_queue_family = i;
+				}
+
+				//if it does compute but not graphics, set the compute queue family:
+				if ((queue_family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+					if (!compute_queue_family) compute_queue_family = i;
+				}
+
 				if (!configuration.headless)
 				{
 					//if it has present support, set the present queue family:
@@ -381,6 +437,23 @@ RTG::RTG(Configuration const &configuration_) : helpers(*this) {
 			if (!present_queue_family) {
 				throw std::runtime_error("No queue with present support.");
 			}
+
+			//otherwise, fall back to the graphics family (every graphics family also does compute and transfer):
+			uint32_t graphics_family_queues = queue_families[graphics_queue_family.value()].queueCount;
+			if (!transfer_queue_family) {
+				transfer_queue_family = graphics_queue_family;
+				if (graphics_queue_count < graphics_family_queues) transfer_queue_index = graphics_queue_count++;
+			}
+			if (!compute_queue_family) {
+				compute_queue_family = graphics_queue_family;
+				if (graphics_queue_count < graphics_family_queues) compute_queue_index = graphics_queue_count++;
+			}
+
+			if (configuration.debug) {
+				std::cout << "Queue families: graphics " << graphics_queue_family.value() << ", present " << present_queue_family.value()
+				          << ", transfer " << transfer_queue_family.value() << " (queue " << transfer_queue_index << ")"
+				          << ", compute " << compute_queue_family.value() << " (queue " << compute_queue_index << ")." << std::endl;
+			}
 		}
 
 		//select device extensions:
@@ -394,25 +467,58 @@ RTG::RTG(Configuration const &configuration_) : helpers(*this) {
 			device_extensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 		}
 
+		{ // add the memory budget extension, if the device has it (used for memory reports):
+			uint32_t count = 0;
+			VK( vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &count, nullptr) );
+			std::vector< VkExtensionProperties > extensions(count);
+			VK( vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &count, extensions.data()) );
+			for (VkExtensionProperties const &extension : extensions) {
+				if (std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) {
+					memory_budget_supported = true;
+					device_extensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+					break;
+				}
+			}
+		}
+
 		{ //create the logical device:
 			std::vector< VkDeviceQueueCreateInfo > queue_create_infos;
 			std::set< uint32_t > unique_queue_families{
 				graphics_queue_family.value(),
-				present_queue_family.value()
+				present_queue_family.value(),
+				transfer_queue_family.value(),
+				compute_queue_family.value()
 			};
 
-			float queue_priorities[1] = { 1.0f };
+			float queue_priorities[3] = { 1.0f, 1.0f, 1.0f };
 			for (uint32_t queue_family : unique_queue_families) {
 				queue_create_infos.emplace_back(VkDeviceQueueCreateInfo{
 					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
 					.queueFamilyIndex = queue_family,
-					.queueCount = 1,
+					.queueCount = (queue_family == graphics_queue_family.value() ? graphics_queue_count : 1),
 					.pQueuePriorities = queue_priorities,
 				});
 			}
 
+			//uploads signal a timeline semaphore (core in Vulkan 1.2, but still a feature that must be turned on):
+			VkPhysicalDeviceTimelineSemaphoreFeatures timeline_semaphore_features{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+			};
+			{
+				VkPhysicalDeviceFeatures2 features{
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+					.pNext = &timeline_semaphore_features,
+				};
+				vkGetPhysicalDeviceFeatures2(physical_device, &features);
+				if (timeline_semaphore_features.timelineSemaphore != VK_TRUE) {
+					throw std::runtime_error("Device does not support timeline semaphores.");
+				}
+				timeline_semaphore_features.pNext = nullptr;
+			}
+
 			VkDeviceCreateInfo create_info{
 				.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+				.pNext = &timeline_semaphore_features,
 				.queueCreateInfoCount = uint32_t(queue_create_infos.size()),
 				.pQueueCreateInfos = queue_create_infos.data(),
 
@@ -431,6 +537,8 @@ RTG::RTG(Configuration const &configuration_) : helpers(*this) {
 
 			vkGetDeviceQueue(device, graphics_queue_family.value(), 0, &graphics_queue);
 			vkGetDeviceQueue(device, present_queue_family.value(), 0, &present_queue);
+			vkGetDeviceQueue(device, transfer_queue_family.value(), transfer_queue_index, &transfer_queue);
+			vkGetDeviceQueue(device, compute_queue_family.value(), compute_queue_index, &compute_queue);
 		}
 	}
 
@@ -561,7 +669,9 @@ void RTG::recreate_swapchain() {
 				surface_format.format,
 				VK_IMAGE_TILING_OPTIMAL,
 				VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				Helpers::Unmapped,
+				Helpers::MemoryCategory::Swapchain
 			);
 
 			// allocate buffer data: (on-CPU, will be copied to)
@@ -569,7 +679,8 @@ void RTG::recreate_swapchain() {
 				swapchain_extent.width * swapchain_extent.height * vkuFormatTexelBlockSize(surface_format.format) / vkuFormatTexelsPerBlock(surface_format.format),
 				VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				Helpers::Mapped
+				Helpers::Mapped,
+				Helpers::MemoryCategory::Swapchain
 			);
 
 			{	// create and record copy command
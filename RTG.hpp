@@ -87,6 +87,14 @@ struct RTG {
 		bool print_scene = false;		// --print
 		std::string scene_camera = "";	// --camera
 		std::string culling_mode = "";	// --cull
+		uint32_t load_threads = 1;		// --load-threads N (parse the scene on N threads)
+		bool scene_cache = true;		// --no-scene-cache (otherwise scenes are loaded through a compiled .s72c next to the .s72)
+		bool weld_vertices = false;		// --weld (give non-indexed meshes an index buffer by merging identical vertices)
+		bool optimize_meshes = false;	// --optimize-meshes (reorder indexed meshes for the vertex cache, overdraw, and vertex fetch)
+		bool packed_vertices = false;	// --packed-vertices (upload vertices as PackedVertex and decode them in objects.vert)
+		float lod_pixel_error = 0.0f;	// --lod <pixels> (simplify meshes into levels of detail; draw the coarsest within this many pixels of full detail; 0: off)
+		uint32_t job_threads = 0;		// --job-threads N (read, decode and repack scene data on N threads at startup; 0: one per hardware thread)
+		bool memory_report = false;		// --memory-report (print device memory use by category and heap once the scene is resident; 'M' prints it any time)
 
 		// A2-tone:
 		float exposure = 0.0f;				// --exposure E (multiplier is 2^E)
@@ -112,10 +120,25 @@ struct RTG {
 	std::optional< uint32_t > graphics_queue_family;
 	VkQueue graphics_queue = VK_NULL_HANDLE;
 
+	//queue for background uploads (see Helpers::transfer_to_buffer_async):
+	// from a transfer-only family (the GPU's copy engines) if there is one, otherwise a second queue from the graphics family
+	// if it has one, otherwise the same queue as graphics_queue
+	//NOTE: if transfer_queue_family != graphics_queue_family, uploads hand their targets over (see Helpers::acquire_uploads)
+	std::optional< uint32_t > transfer_queue_family;
+	VkQueue transfer_queue = VK_NULL_HANDLE;
+
+	//queue for compute work that should run alongside rendering:
+	// from a compute-without-graphics family if there is one, otherwise another queue from (or the same queue as) graphics_queue
+	std::optional< uint32_t > compute_queue_family;
+	VkQueue compute_queue = VK_NULL_HANDLE;
+
 	//queue for present operations:
 	std::optional< uint32_t > present_queue_family;
 	VkQueue present_queue = VK_NULL_HANDLE;
 
+	//VK_EXT_memory_budget is enabled (so Helpers::report_memory can show the driver's per-heap budget and usage):
+	bool memory_budget_supported = false;
+
 	//-------------------------------------------------
 	//Handles for the window and surface:
 
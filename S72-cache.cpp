@@ -0,0 +1,695 @@
+#include "S72.hpp"
+
+#include "MappedFile.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+
+//.s72c files hold a compiled S72 scene:
+// - a header (with the content hash of the .s72 file it was compiled from),
+// - a table of fixed-size records for each type of object, which refer to each other by index,
+// - a table of node references (node children, scene roots),
+// - a table of floats (driver times and values),
+// - and a string table.
+// Records are read in place from a memory mapping, so every table starts on an 8-byte boundary.
+//NOTE: caches are written in the byte order of the machine that wrote them (which is checked on load).
+
+namespace {
+	constexpr char Magic[8] = {'s', '7', '2', 'c', 'a', 'c', 'h', 'e'};
+	constexpr uint32_t Version = 1;
+	constexpr uint32_t ByteOrder = 0x01020304;
+	constexpr uint32_t None = -1U; //a missing reference
+
+	struct String { uint32_t begin, size; }; //in strings
+	struct Range { uint32_t begin, count; }; //in refs, floats, or attributes
+	struct Table { uint64_t offset, count; }; //in the file
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		uint64_t source_hash;
+
+		String scene_name;
+		Range scene_roots; //in refs
+
+		Table strings; //char
+		Table refs; //uint32_t
+		Table floats; //float
+		Table nodes, meshes, attributes, data_files, cameras, drivers, textures, materials, environments, lights;
+	};
+
+	//NOTE: objects that were referenced but never defined are stored with 'defined = 0' and no other data.
+
+	struct NodeRecord {
+		String key;
+		uint32_t defined;
+		float translation[3], rotation[4], scale[3];
+		Range children; //in refs
+		uint32_t mesh, camera, environment, light; //or None
+	};
+
+	struct MeshRecord {
+		String key;
+		uint32_t defined;
+		uint32_t topology; //VkPrimitiveTopology
+		uint32_t count;
+		uint32_t indices_src; //data file, or None if the mesh has no indices
+		uint32_t indices_offset;
+		uint32_t indices_format; //VkIndexType
+		Range attributes; //in attributes
+		uint32_t material; //or None
+	};
+
+	struct AttributeRecord {
+		String name;
+		uint32_t src; //data file
+		uint32_t offset, stride;
+		uint32_t format; //VkFormat
+	};
+
+	struct DataFileRecord {
+		String src;
+	};
+
+	struct CameraRecord {
+		String key;
+		uint32_t defined;
+		float aspect, vfov, near, far;
+	};
+
+	struct DriverRecord {
+		String name;
+		uint32_t node;
+		uint32_t channel, interpolation;
+		Range times, values; //in floats
+	};
+
+	struct TextureRecord {
+		String key, src;
+		uint32_t type, format;
+	};
+
+	struct MaterialRecord {
+		String key;
+		uint32_t defined;
+		uint32_t normal_map, displacement_map; //textures, or None
+		uint32_t brdf; //index of the brdf's type in Material::brdf
+		//brdf parameters, which are either values or textures (if the *_map is not None):
+		float albedo[3];
+		uint32_t albedo_map;
+		float roughness;
+		uint32_t roughness_map;
+		float metalness;
+		uint32_t metalness_map;
+	};
+
+	struct EnvironmentRecord {
+		String key;
+		uint32_t defined;
+		uint32_t radiance; //texture
+	};
+
+	struct LightRecord {
+		String key;
+		uint32_t defined;
+		float tint[3];
+		uint32_t shadow;
+		uint32_t source; //index of the source's type in Light::source
+		float parameters[5]; //the source's parameters, in the order they are declared
+	};
+
+	//number the objects in a scene's map (in iteration order):
+	template< typename T >
+	struct Numbering {
+		std::vector< std::pair< std::string const *, T const * > > objects;
+		std::unordered_map< T const *, uint32_t > index;
+
+		explicit Numbering(S72::NameMap< T > const &map) {
+			objects.reserve(map.size());
+			index.reserve(map.size());
+			for (auto const &[key, value] : map) {
+				index.emplace(&value, uint32_t(objects.size()));
+				objects.emplace_back(&key, &value);
+			}
+		}
+		uint32_t operator()(T const *object) const {
+			return object ? index.at(object) : None;
+		}
+	};
+
+	//get a table of records from a mapped cache:
+	template< typename T >
+	std::span< T const > get_table(std::string_view file, Table const &table) {
+		if (table.offset % alignof(T) != 0 || table.offset > file.size() || table.count > (file.size() - table.offset) / sizeof(T)) {
+			throw std::runtime_error("table is out of range.");
+		}
+		return std::span< T const >(reinterpret_cast< T const * >(file.data() + table.offset), size_t(table.count));
+	}
+}
+
+//folder that an s72 file's paths are relative to:
+static std::string scene_folder(std::string const &scene_file) {
+	auto pos = scene_file.find_last_of("\\/");
+	if (pos == std::string::npos) return "";
+	return scene_file.substr(0, pos+1);
+}
+
+uint64_t S72::content_hash(std::string_view data) {
+	//(multiply + xor-shift, eight bytes at a time, so it can be run on every load)
+	uint64_t hash = 0xcbf29ce484222325ULL ^ uint64_t(data.size());
+	size_t i = 0;
+	for (; i + 8 <= data.size(); i += 8) {
+		uint64_t word;
+		std::memcpy(&word, data.data() + i, 8);
+		hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+		hash ^= hash >> 29;
+	}
+	for (; i < data.size(); ++i) {
+		hash = (hash ^ uint8_t(data[i])) * 0x9e3779b97f4a7c15ULL;
+		hash ^= hash >> 29;
+	}
+	return hash;
+}
+
+void S72::write_cache(std::string const &cache_file, uint64_t source_hash) const {
+	Numbering node_index(nodes);
+	Numbering mesh_index(meshes);
+	Numbering data_file_index(data_files);
+	Numbering camera_index(cameras);
+	Numbering texture_index(textures);
+	Numbering material_index(materials);
+	Numbering environment_index(environments);
+	Numbering light_index(lights);
+
+	std::string strings;
+	auto add_string = [&](std::string const &str) {
+		String ret{ .begin = uint32_t(strings.size()), .size = uint32_t(str.size()) };
+		strings += str;
+		return ret;
+	};
+
+	std::vector< uint32_t > refs;
+	auto add_refs = [&](std::vector< Node * > const &list) {
+		Range ret{ .begin = uint32_t(refs.size()), .count = uint32_t(list.size()) };
+		for (Node const *node : list) {
+			refs.emplace_back(node_index(node));
+		}
+		return ret;
+	};
+
+	std::vector< float > floats;
+	auto add_floats = [&](std::vector< float > const &list) {
+		Range ret{ .begin = uint32_t(floats.size()), .count = uint32_t(list.size()) };
+		floats.insert(floats.end(), list.begin(), list.end());
+		return ret;
+	};
+
+	Header header{};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.byte_order = ByteOrder;
+	header.source_hash = source_hash;
+	header.scene_name = add_string(scene.name);
+	header.scene_roots = add_refs(scene.roots);
+
+	std::vector< NodeRecord > node_records;
+	node_records.reserve(node_index.objects.size());
+	for (auto const &[key, node] : node_index.objects) {
+		NodeRecord &record = node_records.emplace_back(NodeRecord{});
+		record.key = add_string(*key);
+		record.defined = (node->name != "");
+		if (!record.defined) continue;
+		record.translation[0] = node->translation.x;
+		record.translation[1] = node->translation.y;
+		record.translation[2] = node->translation.z;
+		record.rotation[0] = node->rotation.x;
+		record.rotation[1] = node->rotation.y;
+		record.rotation[2] = node->rotation.z;
+		record.rotation[3] = node->rotation.w;
+		record.scale[0] = node->scale.x;
+		record.scale[1] = node->scale.y;
+		record.scale[2] = node->scale.z;
+		record.children = add_refs(node->children);
+		record.mesh = mesh_index(node->mesh);
+		record.camera = camera_index(node->camera);
+		record.environment = environment_index(node->environment);
+		record.light = light_index(node->light);
+	}
+
+	std::vector< MeshRecord > mesh_records;
+	std::vector< AttributeRecord > attribute_records;
+	mesh_records.reserve(mesh_index.objects.size());
+	for (auto const &[key, mesh] : mesh_index.objects) {
+		MeshRecord &record = mesh_records.emplace_back(MeshRecord{});
+		record.key = add_string(*key);
+		record.defined = (mesh->name != "");
+		if (!record.defined) continue;
+		record.topology = uint32_t(mesh->topology);
+		record.count = mesh->count;
+		record.indices_src = None;
+		if (mesh->indices) {
+			record.indices_src = data_file_index(&mesh->indices->src);
+			record.indices_offset = mesh->indices->offset;
+			record.indices_format = uint32_t(mesh->indices->format);
+		}
+		record.attributes = Range{ .begin = uint32_t(attribute_records.size()), .count = uint32_t(mesh->attributes.size()) };
+		for (auto const &[name, attribute] : mesh->attributes) {
+			attribute_records.emplace_back(AttributeRecord{
+				.name = add_string(name),
+				.src = data_file_index(&attribute.src),
+				.offset = attribute.offset,
+				.stride = attribute.stride,
+				.format = uint32_t(attribute.format),
+			});
+		}
+		record.material = material_index(mesh->material);
+	}
+
+	std::vector< DataFileRecord > data_file_records;
+	data_file_records.reserve(data_file_index.objects.size());
+	for (auto const &[key, data_file] : data_file_index.objects) {
+		data_file_records.emplace_back(DataFileRecord{ .src = add_string(*key) });
+	}
+
+	std::vector< CameraRecord > camera_records;
+	camera_records.reserve(camera_index.objects.size());
+	for (auto const &[key, camera] : camera_index.objects) {
+		CameraRecord &record = camera_records.emplace_back(CameraRecord{});
+		record.key = add_string(*key);
+		record.defined = (camera->name != "");
+		if (!record.defined) continue;
+		Camera::Perspective const &perspective = std::get< Camera::Perspective >(camera->projection);
+		record.aspect = perspective.aspect;
+		record.vfov = perspective.vfov;
+		record.near = perspective.near;
+		record.far = perspective.far;
+	}
+
+	std::vector< DriverRecord > driver_records;
+	driver_records.reserve(drivers.size());
+	for (Driver const &driver : drivers) {
+		driver_records.emplace_back(DriverRecord{
+			.name = add_string(driver.name),
+			.node = node_index(&driver.node),
+			.channel = uint32_t(driver.channel),
+			.interpolation = uint32_t(driver.interpolation),
+			.times = add_floats(driver.times),
+			.values = add_floats(driver.values),
+		});
+	}
+
+	std::vector< TextureRecord > texture_records;
+	texture_records.reserve(texture_index.objects.size());
+	for (auto const &[key, texture] : texture_index.objects) {
+		texture_records.emplace_back(TextureRecord{
+			.key = add_string(*key),
+			.src = add_string(texture->src),
+			.type = uint32_t(texture->type),
+			.format = uint32_t(texture->format),
+		});
+	}
+
+	std::vector< MaterialRecord > material_records;
+	material_records.reserve(material_index.objects.size());
+	for (auto const &[key, material] : material_index.objects) {
+		MaterialRecord &record = material_records.emplace_back(MaterialRecord{});
+		record.key = add_string(*key);
+		record.defined = (material->name != "");
+		if (!record.defined) continue;
+		record.normal_map = texture_index(material->normal_map);
+		record.displacement_map = texture_index(material->displacement_map);
+		record.brdf = uint32_t(material->brdf.index());
+		record.albedo_map = record.roughness_map = record.metalness_map = None;
+
+		auto set_albedo = [&](std::variant< color, Texture * > const &albedo) {
+			if (Texture * const *texture = std::get_if< Texture * >(&albedo)) {
+				record.albedo_map = texture_index(*texture);
+			} else {
+				color const &c = std::get< color >(albedo);
+				record.albedo[0] = c.r;
+				record.albedo[1] = c.g;
+				record.albedo[2] = c.b;
+			}
+		};
+		auto set_float = [&](std::variant< float, Texture * > const &parameter, float *value, uint32_t *map) {
+			if (Texture * const *texture = std::get_if< Texture * >(&parameter)) {
+				*map = texture_index(*texture);
+			} else {
+				*value = std::get< float >(parameter);
+			}
+		};
+		if (Material::PBR const *pbr = std::get_if< Material::PBR >(&material->brdf)) {
+			set_albedo(pbr->albedo);
+			set_float(pbr->roughness, &record.roughness, &record.roughness_map);
+			set_float(pbr->metalness, &record.metalness, &record.metalness_map);
+		} else if (Material::Lambertian const *lambertian = std::get_if< Material::Lambertian >(&material->brdf)) {
+			set_albedo(lambertian->albedo);
+		}
+	}
+
+	std::vector< EnvironmentRecord > environment_records;
+	environment_records.reserve(environment_index.objects.size());
+	for (auto const &[key, environment] : environment_index.objects) {
+		EnvironmentRecord &record = environment_records.emplace_back(EnvironmentRecord{});
+		record.key = add_string(*key);
+		record.defined = (environment->name != "");
+		if (!record.defined) continue;
+		record.radiance = texture_index(environment->radiance);
+	}
+
+	std::vector< LightRecord > light_records;
+	light_records.reserve(light_index.objects.size());
+	for (auto const &[key, light] : light_index.objects) {
+		LightRecord &record = light_records.emplace_back(LightRecord{});
+		record.key = add_string(*key);
+		record.defined = (light->name != "");
+		if (!record.defined) continue;
+		record.tint[0] = light->tint.r;
+		record.tint[1] = light->tint.g;
+		record.tint[2] = light->tint.b;
+		record.shadow = light->shadow;
+		record.source = uint32_t(light->source.index());
+		if (Light::Sun const *sun = std::get_if< Light::Sun >(&light->source)) {
+			record.parameters[0] = sun->angle;
+			record.parameters[1] = sun->strength;
+		} else if (Light::Sphere const *sphere = std::get_if< Light::Sphere >(&light->source)) {
+			record.parameters[0] = sphere->radius;
+			record.parameters[1] = sphere->power;
+			record.parameters[2] = sphere->limit;
+		} else if (Light::Spot const *spot = std::get_if< Light::Spot >(&light->source)) {
+			record.parameters[0] = spot->radius;
+			record.parameters[1] = spot->power;
+			record.parameters[2] = spot->limit;
+			record.parameters[3] = spot->fov;
+			record.parameters[4] = spot->blend;
+		}
+	}
+
+	if (strings.size() > None || refs.size() > None || floats.size() > None) {
+		throw std::runtime_error("scene is too large to cache.");
+	}
+
+	//lay out the file:
+	std::vector< char > file(sizeof(Header), '\0');
+	auto add_table = [&](auto const &list) {
+		file.resize((file.size() + 7) & ~size_t(7), '\0');
+		Table table{ .offset = file.size(), .count = list.size() };
+		char const *bytes = reinterpret_cast< char const * >(list.data());
+		file.insert(file.end(), bytes, bytes + list.size() * sizeof(list[0]));
+		return table;
+	};
+	header.strings = add_table(strings);
+	header.refs = add_table(refs);
+	header.floats = add_table(floats);
+	header.nodes = add_table(node_records);
+	header.meshes = add_table(mesh_records);
+	header.attributes = add_table(attribute_records);
+	header.data_files = add_table(data_file_records);
+	header.cameras = add_table(camera_records);
+	header.drivers = add_table(driver_records);
+	header.textures = add_table(texture_records);
+	header.materials = add_table(material_records);
+	header.environments = add_table(environment_records);
+	header.lights = add_table(light_records);
+	std::memcpy(file.data(), &header, sizeof(Header));
+
+	//write to a temporary file and then rename it, so a partly-written cache is never read:
+	std::string temp_file = cache_file + ".tmp";
+	{
+		std::ofstream out(temp_file, std::ios::binary);
+		out.write(file.data(), file.size());
+		if (!out) throw std::runtime_error("failed to write '" + temp_file + "'.");
+	}
+	std::error_code error;
+	std::filesystem::rename(temp_file, cache_file, error);
+	if (error) {
+		std::filesystem::remove(temp_file, error);
+		throw std::runtime_error("failed to rename '" + temp_file + "' to '" + cache_file + "'.");
+	}
+}
+
+//rebuild a scene from a mapped cache:
+// returns std::nullopt if the cache was written for other contents (or by another version of this code)
+// throws if the cache is damaged
+static std::optional< S72 > read_cache(std::string_view file, uint64_t source_hash, std::string const &folder) {
+	if (file.size() < sizeof(Header)) throw std::runtime_error("file is too small.");
+	Header header;
+	std::memcpy(&header, file.data(), sizeof(Header));
+	if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) throw std::runtime_error("file is not a scene cache.");
+	if (header.version != Version || header.byte_order != ByteOrder || header.source_hash != source_hash) return std::nullopt;
+
+	std::span< char const > strings = get_table< char >(file, header.strings);
+	std::span< uint32_t const > refs = get_table< uint32_t >(file, header.refs);
+	std::span< float const > floats = get_table< float >(file, header.floats);
+
+	auto string = [&](String const &s) {
+		if (s.begin > strings.size() || s.size > strings.size() - s.begin) throw std::runtime_error("string is out of range.");
+		return std::string(strings.data() + s.begin, s.size);
+	};
+	auto check_range = [](Range const &r, size_t size) {
+		if (r.begin > size || r.count > size - r.begin) throw std::runtime_error("range is out of bounds.");
+	};
+	auto lookup = [](auto const &objects, uint32_t i) {
+		if (i >= objects.size()) throw std::runtime_error("reference is out of range.");
+		return objects[i];
+	};
+	auto lookup_optional = [&](auto const &objects, uint32_t i) {
+		return (i == None ? nullptr : lookup(objects, i));
+	};
+	auto check_enum = [](uint32_t value, uint32_t count) {
+		if (value >= count) throw std::runtime_error("enum value is out of range.");
+		return value;
+	};
+
+	S72 s72;
+
+	//make every object first, so that references can be resolved as they are read:
+	// (returns the objects by index)
+	auto make_objects = [&]< typename T, typename Record >(S72::NameMap< T > &map, std::span< Record const > records) {
+		std::vector< T * > objects;
+		objects.reserve(records.size());
+		map.reserve(records.size());
+		for (Record const &record : records) {
+			auto [at, inserted] = map.try_emplace(string(record.key));
+			if (!inserted) throw std::runtime_error("object is stored twice.");
+			objects.emplace_back(&at->second);
+		}
+		return objects;
+	};
+
+	auto node_records = get_table< NodeRecord >(file, header.nodes);
+	auto mesh_records = get_table< MeshRecord >(file, header.meshes);
+	auto attribute_records = get_table< AttributeRecord >(file, header.attributes);
+	auto data_file_records = get_table< DataFileRecord >(file, header.data_files);
+	auto camera_records = get_table< CameraRecord >(file, header.cameras);
+	auto driver_records = get_table< DriverRecord >(file, header.drivers);
+	auto texture_records = get_table< TextureRecord >(file, header.textures);
+	auto material_records = get_table< MaterialRecord >(file, header.materials);
+	auto environment_records = get_table< EnvironmentRecord >(file, header.environments);
+	auto light_records = get_table< LightRecord >(file, header.lights);
+
+	std::vector< S72::Node * > nodes = make_objects(s72.nodes, node_records);
+	std::vector< S72::Mesh * > meshes = make_objects(s72.meshes, mesh_records);
+	std::vector< S72::Camera * > cameras = make_objects(s72.cameras, camera_records);
+	std::vector< S72::Material * > materials = make_objects(s72.materials, material_records);
+	std::vector< S72::Environment * > environments = make_objects(s72.environments, environment_records);
+	std::vector< S72::Light * > lights = make_objects(s72.lights, light_records);
+
+	std::vector< S72::DataFile * > data_files;
+	data_files.reserve(data_file_records.size());
+	s72.data_files.reserve(data_file_records.size());
+	for (DataFileRecord const &record : data_file_records) {
+		std::string src = string(record.src);
+		auto [at, inserted] = s72.data_files.try_emplace(src, S72::DataFile{ .src = src, .path = folder + src });
+		if (!inserted) throw std::runtime_error("object is stored twice.");
+		data_files.emplace_back(&at->second);
+	}
+
+	std::vector< S72::Texture * > textures;
+	textures.reserve(texture_records.size());
+	s72.textures.reserve(texture_records.size());
+	for (TextureRecord const &record : texture_records) {
+		std::string src = string(record.src);
+		auto [at, inserted] = s72.textures.try_emplace(string(record.key), S72::Texture{
+			.src = src,
+			.type = S72::Texture::Type(check_enum(record.type, 2)),
+			.format = S72::Texture::Format(check_enum(record.format, 3)),
+			.path = folder + src,
+		});
+		if (!inserted) throw std::runtime_error("object is stored twice.");
+		textures.emplace_back(&at->second);
+	}
+
+	auto node_list = [&](Range const &range) {
+		check_range(range, refs.size());
+		std::vector< S72::Node * > list;
+		list.reserve(range.count);
+		for (uint32_t i = range.begin; i < range.begin + range.count; ++i) {
+			list.emplace_back(lookup(nodes, refs[i]));
+		}
+		return list;
+	};
+	auto float_list = [&](Range const &range) {
+		check_range(range, floats.size());
+		return std::vector< float >(floats.begin() + range.begin, floats.begin() + range.begin + range.count);
+	};
+
+	s72.scene.name = string(header.scene_name);
+	s72.scene.roots = node_list(header.scene_roots);
+
+	for (size_t i = 0; i < node_records.size(); ++i) {
+		NodeRecord const &record = node_records[i];
+		if (!record.defined) continue;
+		S72::Node &node = *nodes[i];
+		node.name = string(record.key);
+		node.translation = S72::vec3{ .x = record.translation[0], .y = record.translation[1], .z = record.translation[2] };
+		node.rotation = S72::quat{ .x = record.rotation[0], .y = record.rotation[1], .z = record.rotation[2], .w = record.rotation[3] };
+		node.scale = S72::vec3{ .x = record.scale[0], .y = record.scale[1], .z = record.scale[2] };
+		node.children = node_list(record.children);
+		node.mesh = lookup_optional(meshes, record.mesh);
+		node.camera = lookup_optional(cameras, record.camera);
+		node.environment = lookup_optional(environments, record.environment);
+		node.light = lookup_optional(lights, record.light);
+	}
+
+	for (size_t i = 0; i < mesh_records.size(); ++i) {
+		MeshRecord const &record = mesh_records[i];
+		if (!record.defined) continue;
+		S72::Mesh &mesh = *meshes[i];
+		mesh.name = string(record.key);
+		mesh.topology = VkPrimitiveTopology(record.topology);
+		mesh.count = record.count;
+		if (record.indices_src != None) {
+			mesh.indices.emplace(S72::Mesh::Indices{
+				.src = *lookup(data_files, record.indices_src),
+				.offset = record.indices_offset,
+				.format = VkIndexType(record.indices_format),
+			});
+		}
+		check_range(record.attributes, attribute_records.size());
+		for (uint32_t a = record.attributes.begin; a < record.attributes.begin + record.attributes.count; ++a) {
+			AttributeRecord const &attribute = attribute_records[a];
+			mesh.attributes.emplace(string(attribute.name), S72::Mesh::Attribute{
+				.src = *lookup(data_files, attribute.src),
+				.offset = attribute.offset,
+				.stride = attribute.stride,
+				.format = VkFormat(attribute.format),
+			});
+		}
+		mesh.material = lookup_optional(materials, record.material);
+	}
+
+	for (size_t i = 0; i < camera_records.size(); ++i) {
+		CameraRecord const &record = camera_records[i];
+		if (!record.defined) continue;
+		S72::Camera &camera = *cameras[i];
+		camera.name = string(record.key);
+		camera.projection = S72::Camera::Perspective{
+			.aspect = record.aspect,
+			.vfov = record.vfov,
+			.near = record.near,
+			.far = record.far,
+		};
+	}
+
+	s72.drivers.reserve(driver_records.size());
+	for (DriverRecord const &record : driver_records) {
+		s72.drivers.emplace_back(S72::Driver{
+			.name = string(record.name),
+			.node = *lookup(nodes, record.node),
+			.channel = S72::Driver::Channel(check_enum(record.channel, 3)),
+			.times = float_list(record.times),
+			.values = float_list(record.values),
+			.interpolation = S72::Driver::Interpolation(check_enum(record.interpolation, 3)),
+		});
+	}
+
+	for (size_t i = 0; i < material_records.size(); ++i) {
+		MaterialRecord const &record = material_records[i];
+		if (!record.defined) continue;
+		S72::Material &material = *materials[i];
+		material.name = string(record.key);
+		material.normal_map = lookup_optional(textures, record.normal_map);
+		material.displacement_map = lookup_optional(textures, record.displacement_map);
+
+		auto albedo = [&]() -> std::variant< S72::color, S72::Texture * > {
+			if (record.albedo_map != None) return lookup(textures, record.albedo_map);
+			return S72::color{ .r = record.albedo[0], .g = record.albedo[1], .b = record.albedo[2] };
+		};
+		auto parameter = [&](float value, uint32_t map) -> std::variant< float, S72::Texture * > {
+			if (map != None) return lookup(textures, map);
+			return value;
+		};
+		switch (check_enum(record.brdf, 4)) {
+			case 0: material.brdf = S72::Material::PBR{
+				.albedo = albedo(),
+				.roughness = parameter(record.roughness, record.roughness_map),
+				.metalness = parameter(record.metalness, record.metalness_map),
+			}; break;
+			case 1: material.brdf = S72::Material::Lambertian{ .albedo = albedo() }; break;
+			case 2: material.brdf = S72::Material::Mirror{}; break;
+			case 3: material.brdf = S72::Material::Environment{}; break;
+		}
+	}
+
+	for (size_t i = 0; i < environment_records.size(); ++i) {
+		EnvironmentRecord const &record = environment_records[i];
+		if (!record.defined) continue;
+		S72::Environment &environment = *environments[i];
+		environment.name = string(record.key);
+		environment.radiance = lookup(textures, record.radiance);
+	}
+
+	for (size_t i = 0; i < light_records.size(); ++i) {
+		LightRecord const &record = light_records[i];
+		if (!record.defined) continue;
+		S72::Light &light = *lights[i];
+		light.name = string(record.key);
+		light.tint = S72::color{ .r = record.tint[0], .g = record.tint[1], .b = record.tint[2] };
+		light.shadow = record.shadow;
+		float const *p = record.parameters;
+		switch (check_enum(record.source, 3)) {
+			case 0: light.source = S72::Light::Sun{ .angle = p[0], .strength = p[1] }; break;
+			case 1: light.source = S72::Light::Sphere{ .radius = p[0], .power = p[1], .limit = p[2] }; break;
+			case 2: light.source = S72::Light::Spot{ .radius = p[0], .power = p[1], .limit = p[2], .fov = p[3], .blend = p[4] }; break;
+		}
+	}
+
+	return s72;
+}
+
+S72 S72::load_cached(std::string const &file, uint32_t threads) {
+	std::string cache_file = file + "c";
+
+	uint64_t source_hash;
+	{
+		MappedFile source(file);
+		source_hash = content_hash(source.view());
+	}
+
+	if (std::filesystem::exists(cache_file)) {
+		try {
+			MappedFile cache(cache_file);
+			if (std::optional< S72 > s72 = read_cache(cache.view(), source_hash, scene_folder(file))) {
+				return std::move(*s72);
+			}
+		} catch (std::exception &e) {
+			std::cerr << "WARNING: ignoring scene cache '" << cache_file << "': " << e.what() << std::endl;
+		}
+	}
+
+	S72 s72 = load(file, threads);
+
+	try {
+		s72.write_cache(cache_file, source_hash);
+	} catch (std::exception &e) {
+		std::cerr << "WARNING: failed to write scene cache '" << cache_file << "': " << e.what() << std::endl;
+	}
+
+	return s72;
+}
@@ -0,0 +1,213 @@
+//S72::dense() -- builds the index-based copy of a scene (S72::Dense; see S72.hpp).
+
+#include "S72.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+using Index = S72::Dense::Index;
+
+//assigns indices to one type of object (the pointer-to-index map is only needed during the conversion):
+template< typename T >
+struct Numbering {
+	std::vector< T const * > order;
+	std::unordered_map< T const *, Index > index;
+
+	Index add(T const *t) {
+		auto ret = index.emplace(t, Index(order.size()));
+		if (ret.second) order.emplace_back(t);
+		return ret.first->second;
+	}
+
+	Index operator[](T const *t) const {
+		if (t == nullptr) return S72::Dense::None;
+		auto f = index.find(t);
+		if (f == index.end()) throw std::runtime_error("S72::dense(): reference to an object that isn't in the scene.");
+		return f->second;
+	}
+};
+
+//number all the objects in a map, in order of their keys (so indices don't depend on hash table order):
+template< typename T >
+Numbering< T > number_by_key(S72::NameMap< T > const &map) {
+	std::vector< std::pair< std::string const *, T const * > > sorted;
+	sorted.reserve(map.size());
+	for (auto const &[key, t] : map) {
+		sorted.emplace_back(&key, &t);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](auto const &a, auto const &b) {
+		return *a.first < *b.first;
+	});
+
+	Numbering< T > numbering;
+	numbering.order.reserve(sorted.size());
+	numbering.index.reserve(sorted.size());
+	for (auto const &[key, t] : sorted) {
+		numbering.add(t);
+	}
+	return numbering;
+}
+
+} //namespace
+
+S72::Dense S72::dense() const {
+	Dense dense;
+	dense.scene_name = scene.name;
+
+	//nodes are numbered depth-first from the roots, so a frame's traversal walks 'nodes' mostly front-to-back:
+	Numbering< Node > node_numbering;
+	node_numbering.order.reserve(nodes.size());
+	node_numbering.index.reserve(nodes.size());
+	{
+		//(explicit stack because node hierarchies can be very deep)
+		std::vector< Node const * > stack(scene.roots.rbegin(), scene.roots.rend());
+		while (!stack.empty()) {
+			Node const *node = stack.back();
+			stack.pop_back();
+			if (node_numbering.index.count(node)) continue; //already numbered through another parent
+			node_numbering.add(node);
+			stack.insert(stack.end(), node->children.rbegin(), node->children.rend());
+		}
+	}
+	//...followed by nodes that aren't reachable from the roots (in name order):
+	Numbering< Node > by_name = number_by_key(nodes);
+	for (Node const *node : by_name.order) {
+		node_numbering.add(node);
+	}
+
+	Numbering< Mesh > mesh_numbering = number_by_key(meshes);
+	Numbering< DataFile > data_file_numbering = number_by_key(data_files);
+	Numbering< Camera > camera_numbering = number_by_key(cameras);
+	Numbering< Material > material_numbering = number_by_key(materials);
+	Numbering< Texture > texture_numbering = number_by_key(textures);
+	Numbering< Environment > environment_numbering = number_by_key(environments);
+	Numbering< Light > light_numbering = number_by_key(lights);
+
+	dense.roots.reserve(scene.roots.size());
+	for (Node const *root : scene.roots) {
+		dense.roots.emplace_back(node_numbering[root]);
+	}
+
+	dense.nodes.reserve(node_numbering.order.size());
+	for (Node const *node : node_numbering.order) {
+		Dense::Node &out = dense.nodes.emplace_back();
+		out.name = node->name;
+		out.translation = node->translation;
+		out.rotation = node->rotation;
+		out.scale = node->scale;
+		out.children_begin = Index(dense.children.size());
+		out.children_count = Index(node->children.size());
+		for (Node const *child : node->children) {
+			dense.children.emplace_back(node_numbering[child]);
+		}
+		out.mesh = mesh_numbering[node->mesh];
+		out.camera = camera_numbering[node->camera];
+		out.environment = environment_numbering[node->environment];
+		out.light = light_numbering[node->light];
+	}
+
+	dense.meshes.reserve(mesh_numbering.order.size());
+	for (Mesh const *mesh : mesh_numbering.order) {
+		Dense::Mesh &out = dense.meshes.emplace_back();
+		out.name = mesh->name;
+		out.topology = mesh->topology;
+		out.count = mesh->count;
+		if (mesh->indices) {
+			out.indices = Dense::Mesh::Indices{
+				.src = data_file_numbering[&mesh->indices->src],
+				.offset = mesh->indices->offset,
+				.format = mesh->indices->format,
+			};
+		}
+		out.attributes.reserve(mesh->attributes.size());
+		for (auto const &[name, attribute] : mesh->attributes) {
+			out.attributes.emplace_back(Dense::Mesh::Attribute{
+				.name = name,
+				.src = data_file_numbering[&attribute.src],
+				.offset = attribute.offset,
+				.stride = attribute.stride,
+				.format = attribute.format,
+			});
+		}
+		std::sort(out.attributes.begin(), out.attributes.end(), [](Dense::Mesh::Attribute const &a, Dense::Mesh::Attribute const &b) {
+			return a.name < b.name;
+		});
+		out.material = material_numbering[mesh->material];
+	}
+
+	dense.data_files.reserve(data_file_numbering.order.size());
+	for (DataFile const *data_file : data_file_numbering.order) {
+		dense.data_files.emplace_back(*data_file);
+	}
+
+	dense.cameras.reserve(camera_numbering.order.size());
+	for (Camera const *camera : camera_numbering.order) {
+		dense.cameras.emplace_back(*camera);
+	}
+
+	dense.drivers.reserve(drivers.size());
+	for (Driver const &driver : drivers) {
+		dense.drivers.emplace_back(Dense::Driver{
+			.name = driver.name,
+			.node = node_numbering[&driver.node],
+			.channel = driver.channel,
+			.times = driver.times,
+			.values = driver.values,
+			.interpolation = driver.interpolation,
+		});
+	}
+
+	//material parameters are either a value or a texture:
+	auto parameter = [&](auto const &value) {
+		using Value = std::variant_alternative_t< 0, std::decay_t< decltype(value) > >;
+		std::variant< Value, Index > out;
+		if (auto texture = std::get_if< Texture * >(&value)) out = texture_numbering[*texture];
+		else out = std::get< Value >(value);
+		return out;
+	};
+
+	dense.materials.reserve(material_numbering.order.size());
+	for (Material const *material : material_numbering.order) {
+		Dense::Material &out = dense.materials.emplace_back();
+		out.name = material->name;
+		out.normal_map = texture_numbering[material->normal_map];
+		out.displacement_map = texture_numbering[material->displacement_map];
+		if (auto pbr = std::get_if< Material::PBR >(&material->brdf)) {
+			out.brdf = Dense::Material::PBR{
+				.albedo = parameter(pbr->albedo),
+				.roughness = parameter(pbr->roughness),
+				.metalness = parameter(pbr->metalness),
+			};
+		} else if (auto lambertian = std::get_if< Material::Lambertian >(&material->brdf)) {
+			out.brdf = Dense::Material::Lambertian{
+				.albedo = parameter(lambertian->albedo),
+			};
+		} else if (std::holds_alternative< Material::Mirror >(material->brdf)) {
+			out.brdf = Dense::Material::Mirror{};
+		} else if (std::holds_alternative< Material::Environment >(material->brdf)) {
+			out.brdf = Dense::Material::Environment{};
+		}
+	}
+
+	dense.textures.reserve(texture_numbering.order.size());
+	for (Texture const *texture : texture_numbering.order) {
+		dense.textures.emplace_back(*texture);
+	}
+
+	dense.environments.reserve(environment_numbering.order.size());
+	for (Environment const *environment : environment_numbering.order) {
+		dense.environments.emplace_back(Dense::Environment{
+			.name = environment->name,
+			.radiance = texture_numbering[environment->radiance],
+		});
+	}
+
+	dense.lights.reserve(light_numbering.order.size());
+	for (Light const *light : light_numbering.order) {
+		dense.lights.emplace_back(*light);
+	}
+
+	return dense;
+}
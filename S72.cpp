@@ -1,16 +1,22 @@
 #include "S72.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <exception>
 #include <iostream>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <thread>
 #include <unordered_map>
 
 //functions that do the inverse of those in vk_enum_string_helper.h :
 
 //used for mesh topologies:
-VkPrimitiveTopology topology_to_VkPrimitiveTopology(std::string const &topology) {
-	static std::map< std::string, VkPrimitiveTopology > const map = {
+VkPrimitiveTopology topology_to_VkPrimitiveTopology(std::string_view topology) {
+	static std::map< std::string, VkPrimitiveTopology, std::less<> > const map = {
 #define DO( X ) { #X, VK_PRIMITIVE_TOPOLOGY_ ## X }
 		DO( POINT_LIST ),
 		DO( LINE_LIST ),
@@ -26,14 +32,14 @@ VkPrimitiveTopology topology_to_VkPrimitiveTopology(std::string const &topology)
 #undef DO
 	};
 	auto f = map.find(topology);
-	if (f == map.end()) throw new std::runtime_error("Unrecognized topology \"" + topology + "\".");
+	if (f == map.end()) throw new std::runtime_error("Unrecognized topology \"" + std::string(topology) + "\".");
 	return f->second;
 }
 
 
 //used for index formats:
-VkIndexType format_to_VkIndexType(std::string const &format) {
-	static std::map< std::string, VkIndexType > const map = {
+VkIndexType format_to_VkIndexType(std::string_view format) {
+	static std::map< std::string, VkIndexType, std::less<> > const map = {
 #define DO( X ) { #X, VK_INDEX_TYPE_ ## X }
 		DO( UINT16 ),
 		DO( UINT32 ),
@@ -42,14 +48,14 @@ VkIndexType format_to_VkIndexType(std::string const &format) {
 #undef DO
 	};
 	auto f = map.find(format);
-	if (f == map.end()) throw new std::runtime_error("Unrecognized index format \"" + format + "\".");
+	if (f == map.end()) throw new std::runtime_error("Unrecognized index format \"" + std::string(format) + "\".");
 	return f->second;
 }
 
 
 //used for vertex data formats:
-VkFormat format_to_VkFormat(std::string const &format) {
-	static std::map< std::string, VkFormat > const map = {
+VkFormat format_to_VkFormat(std::string_view format) {
+	static std::map< std::string, VkFormat, std::less<> > const map = {
 #define DO( X ) { #X, VK_FORMAT_ ## X }
 		//formats for which VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT is always set.
 		// see: https://registry.khronos.org/vulkan/specs/latest/html/vkspec.html#features-required-format-support
@@ -106,194 +112,554 @@ VkFormat format_to_VkFormat(std::string const &format) {
 #undef DO
 	};
 	auto f = map.find(format);
-	if (f == map.end()) throw new std::runtime_error("Unrecognized index format \"" + format + "\".");
+	if (f == map.end()) throw new std::runtime_error("Unrecognized index format \"" + std::string(format) + "\".");
 	return f->second;
 }
 
 
 //helpers used in loading:
 
-//warn if any members of an object haven't been handled (+ deleted):
-void warn_on_unhandled(std::map< std::string, sejp::value > &object, std::string const &what) {
-	if (object.empty()) return;
-	std::cerr << "WARNING: " << what << " contained unhandled properties: ";
+//where loading warnings are written:
+// (threads loading part of a file collect their warnings so they can be printed in file order)
+static thread_local std::ostream *warnings = &std::cerr;
+
+//an object's members, borrowed from the parsed document, with a record of which have been handled:
+// (so handled members can be "erased" -- and unhandled ones reported -- without copying the object)
+//NOTE: 'what' arguments below are functions that build a description of the value for error messages,
+//      so the description is only made if there is an error.
+struct Members {
+	sejp::object_view object;
+	uint64_t handled = 0; //bit i is set once member i has been handled
+	std::vector< bool > handled_more; //(for members past the first 64; only allocated if needed)
+
+	Members() = default;
+	explicit Members(sejp::object_view const &object_) : object(object_) { }
+
+	using iterator = sejp::object_view::iterator;
+	iterator begin() const { return object.begin(); }
+	iterator end() const { return object.end(); }
+
+	bool is_handled(iterator const &f) const {
+		size_t i = size_t(f - object.begin());
+		if (i < 64) return (handled >> i) & 1;
+		else return i - 64 < handled_more.size() && handled_more[i - 64];
+	}
+	//unhandled member with a given key (or end()):
+	iterator find(std::string_view key) const {
+		iterator f = object.find(key);
+		if (f != object.end() && is_handled(f)) return object.end();
+		return f;
+	}
+	bool contains(std::string_view key) const { return find(key) != end(); }
+	//unhandled member's value; throws if missing:
+	sejp::value at(std::string_view key) const {
+		iterator f = find(key);
+		if (f == end()) throw std::out_of_range("no member \"" + std::string(key) + "\"");
+		return f->second;
+	}
+	//mark a member as handled:
+	void erase(iterator const &f) {
+		assert(f != end());
+		size_t i = size_t(f - object.begin());
+		if (i < 64) {
+			handled |= (uint64_t(1) << i);
+		} else {
+			handled_more.resize(object.size() - 64);
+			handled_more[i - 64] = true;
+		}
+	}
+};
+
+//find the object with a given name, or add an (empty) placeholder for it:
+// (only makes a key string if the name is new)
+template< typename T >
+T &find_or_add(S72::NameMap< T > &map, std::string_view name) {
+	auto f = map.find(name);
+	if (f != map.end()) return f->second;
+	return map.try_emplace(std::string(name)).first->second;
+}
+
+//warn if any members of an object (or float arrays read from it) haven't been handled (+ deleted):
+template< typename What >
+void warn_on_unhandled(Members const &object, What const &what, std::map< std::string, std::vector< float > > const &float_arrays = {}) {
+	bool any_unhandled = !float_arrays.empty();
+	for (auto f = object.begin(); f != object.end() && !any_unhandled; ++f) {
+		any_unhandled = !object.is_handled(f);
+	}
+	if (!any_unhandled) return;
+
+	std::vector< std::string_view > keys;
+	for (auto f = object.begin(); f != object.end(); ++f) {
+		if (!object.is_handled(f)) keys.emplace_back(f->first);
+	}
+	for (auto const &[key, value] : float_arrays) {
+		keys.emplace_back(key);
+	}
+	std::sort(keys.begin(), keys.end());
+
+	*warnings << "WARNING: " << what() << " contained unhandled properties: ";
 	bool first = true;
-	for (auto const &[key, value] : object) {
-		if (!first) std::cerr << ", ";
+	for (auto const &key : keys) {
+		if (!first) *warnings << ", ";
 		first = false;
-		std::cerr << key;
+		*warnings << key;
 	}
-	std::cerr << '.' << std::endl;
+	*warnings << '.' << std::endl;
 }
 
-//pull out a string property of a sejp object as a string.
+//pull out a string property of a sejp object.
 // throws if the property is missing
-// deletes property from the object and returns the value if all is well
-std::string extract_string(std::map< std::string, sejp::value > *object_, std::string const &key, std::string const &what) {
+// marks property as handled and returns the value (a view of the document's storage) if all is well
+template< typename What >
+std::string_view extract_string(Members *object_, std::string_view key, What const &what) {
 	assert(object_);
 	auto &object = *object_;
 
-	std::string string;
-	try {
-		string = object.at(key).as_string().value();
-	} catch (std::exception &) {
-		throw std::runtime_error(what + " is missing or not a string.");
+	auto f = object.find(key);
+	std::optional< std::string_view > string;
+	if (f != object.end()) string = f->second.as_string();
+	if (!string) {
+		throw std::runtime_error(what() + " is missing or not a string.");
 	}
-	object.erase(object.find(key));
-	return string;
+	object.erase(f);
+	return *string;
 };
 
 //pull out a number property of a sejp object as an uint32_t.
 // throws if the property is missing or can't fit in a uint32_t
-// deletes property from the object and returns the value if all is well
-uint32_t extract_uint32_t(std::map< std::string, sejp::value > *object_, std::string const &key, std::string const &what) {
+// marks property as handled and returns the value if all is well
+template< typename What >
+uint32_t extract_uint32_t(Members *object_, std::string_view key, What const &what) {
 	assert(object_);
 	auto &object = *object_;
 
-	double number;
-	try {
-		number = object.at(key).as_number().value();
-	} catch (std::exception &) {
-		throw std::runtime_error(what + " is not a number.");
+	auto f = object.find(key);
+	std::optional< double > number;
+	if (f != object.end()) number = f->second.as_number();
+	if (!number) {
+		throw std::runtime_error(what() + " is not a number.");
 	}
-	if (std::round(number) != number || number < 0.0 || number > double(std::numeric_limits< uint32_t >::max())) {
-		throw std::runtime_error(what + " does not fit in an unsigned 32-bit integer.");
+	if (std::round(*number) != *number || *number < 0.0 || *number > double(std::numeric_limits< uint32_t >::max())) {
+		throw std::runtime_error(what() + " does not fit in an unsigned 32-bit integer.");
 	}
-	object.erase(object.find(key));
-	return uint32_t(number);
+	object.erase(f);
+	return uint32_t(*number);
 };
 
 
 //pull out a number property of a sejp object as a float.
 // throws if the property is missing
-// deletes property from the object and returns the value if all is well
-float extract_float(std::map< std::string, sejp::value > *object_, std::string const &key, std::string const &what) {
+// marks property as handled and returns the value if all is well
+template< typename What >
+float extract_float(Members *object_, std::string_view key, What const &what) {
 	assert(object_);
 	auto &object = *object_;
 
-	double number;
-	try {
-		number = object.at(key).as_number().value();
-	} catch (std::exception &) {
-		throw std::runtime_error(what + " is not a number.");
+	auto f = object.find(key);
+	std::optional< double > number;
+	if (f != object.end()) number = f->second.as_number();
+	if (!number) {
+		throw std::runtime_error(what() + " is not a number.");
 	}
-	object.erase(object.find(key));
-	return float(number);
+	object.erase(f);
+	return float(*number);
 };
 
 
-//pull out an array property of a sejp object as a vector of float.
-// throws if the property is missing or contains non-number data
-// deletes property from the object and returns the value if all is well
-std::vector< float > extract_float_vector(std::map< std::string, sejp::value > *object_, std::string const &key, std::string const &what) {
-	assert(object_);
-	auto &object = *object_;
+//pull out an array of numbers that was read straight into floats (see S72Events, below).
+// throws if the property is missing (or wasn't an array of numbers, so wasn't read into floats)
+// deletes property from the arrays and returns the value (moved, not copied) if all is well
+template< typename What >
+std::vector< float > extract_float_array(std::map< std::string, std::vector< float > > *arrays_, std::string const &key, What const &what) {
+	assert(arrays_);
+	auto &arrays = *arrays_;
 
-	std::vector< float > ret;
-	try {
-		std::vector< sejp::value > const &array = object.at(key).as_array().value();
-		ret.reserve(array.size());
-		for (sejp::value const &value : array) {
-			ret.emplace_back(float(value.as_number().value()));
-		}
-	} catch (std::exception &) {
-		throw std::runtime_error(what + " is not an array of numbers.");
+	auto f = arrays.find(key);
+	if (f == arrays.end()) {
+		throw std::runtime_error(what() + " is not an array of numbers.");
 	}
-	object.erase(object.find(key));
+	std::vector< float > ret = std::move(f->second);
+	arrays.erase(f);
 	return ret;
 };
 
 
 //parse a texture map property of a sejp object into an S72's texture storage
 // throws if the property is missing or doesn't parse as a texture
-// deletes property from the object and returns a reference to the S72's textures container on success
-S72::Texture &extract_map(std::map< std::string, sejp::value > *object_, std::string const &key, S72 *s72_, std::string const &what) {
+// marks property as handled and returns a reference to the S72's textures container on success
+template< typename What >
+S72::Texture &extract_map(Members *object_, std::string_view key, S72 *s72_, What const &what) {
 	assert(object_);
 	auto &object = *object_;
 	assert(s72_);
 	auto &s72 = *s72_;
 
-	std::map< std::string, sejp::value > obj;
+	Members obj;
 	try {
-		obj = object.at(key).as_object().value();
+		obj = Members(object.at(key).as_object().value());
 	} catch (std::exception &) {
-		throw std::runtime_error(what + " is not an object.");
+		throw std::runtime_error(what() + " is not an object.");
 	}
 
-	std::string src = extract_string(&obj, "src", what + "'s src");
+	std::string_view src = extract_string(&obj, "src", [&]{ return what() + "'s src"; });
 	S72::Texture::Type type = S72::Texture::Type::flat;
 	if (obj.contains("type")) {
-		static std::map< std::string, S72::Texture::Type > string_to_type{
+		static std::map< std::string, S72::Texture::Type, std::less<> > string_to_type{
 			{"2D", S72::Texture::Type::flat},
 			{"cube", S72::Texture::Type::cube},
 		};
 
-		std::string str = extract_string(&obj, "type", what + "'s type");
-		try {
-			type = string_to_type.at(str);
-		} catch (std::exception &) {
-			throw std::runtime_error(what + "'s type \"" + str + "\" is not a recognized texture type.");
+		std::string_view str = extract_string(&obj, "type", [&]{ return what() + "'s type"; });
+		auto f = string_to_type.find(str);
+		if (f == string_to_type.end()) {
+			throw std::runtime_error(what() + "'s type \"" + std::string(str) + "\" is not a recognized texture type.");
 		}
+		type = f->second;
 	}
 
 	S72::Texture::Format format = S72::Texture::Format::linear;
 	if (obj.contains("format")) {
-		static std::map< std::string, S72::Texture::Format > string_to_format{
+		static std::map< std::string, S72::Texture::Format, std::less<> > string_to_format{
 			{"linear", S72::Texture::Format::linear},
 			{"srgb", S72::Texture::Format::srgb},
 			{"rgbe", S72::Texture::Format::rgbe},
 		};
 
-		std::string str = extract_string(&obj, "format", what + "'s format");
-		try {
-			format = string_to_format.at(str);
-		} catch (std::exception &) {
-			throw std::runtime_error(what + "'s format \"" + str + "\" is not a recognized texture format.");
+		std::string_view str = extract_string(&obj, "format", [&]{ return what() + "'s format"; });
+		auto f = string_to_format.find(str);
+		if (f == string_to_format.end()) {
+			throw std::runtime_error(what() + "'s format \"" + std::string(str) + "\" is not a recognized texture format.");
 		}
+		format = f->second;
 	}
 
 	warn_on_unhandled(obj, what);
 
 	object.erase(object.find(key));
 
-	std::string texture_key = src + ", format " + std::to_string(int(type)) + ", type " + std::to_string(int(format));
+	std::string texture_key = std::string(src) + ", format " + std::to_string(int(type)) + ", type " + std::to_string(int(format));
 
-	return s72.textures.emplace(texture_key, S72::Texture{.src = src, .type = type, .format = format}).first->second;
+	if (auto f = s72.textures.find(texture_key); f != s72.textures.end()) return f->second;
+	return s72.textures.emplace(texture_key, S72::Texture{.src = std::string(src), .type = type, .format = format}).first->second;
 }
 
 
-S72 S72::load(std::string const &scene_file) {
+//Receives the parse events for an s72 file.
+// Each object in the top-level array is built into a (small) document of its own and handed to
+// on_object, so only one object's worth of generic JSON data is held at a time; and the "times"
+// and "values" arrays of objects (the bulk of animation-heavy scenes) are read straight into floats.
+struct S72Events : sejp::handler {
+	std::function< void(sejp::object_view const &object, std::map< std::string, std::vector< float > > &float_arrays, size_t i) > on_object;
+
+	uint32_t depth = 0; //containers currently open (the top-level array is depth 1, its objects are depth 2)
+	size_t index = 0; //index of the current element of the top-level array
+
+	sejp::document_builder object; //current top-level object
+	std::map< std::string, std::vector< float > > float_arrays; //current top-level object's float arrays
+
+	//the key of a top-level object's member is held back until it is clear whether its value is a float array:
+	std::string key;
+	bool have_key = false;
+
+	//the current array's numbers are held as read (and only narrowed to floats once the whole array turns out to be numbers):
+	bool floats = false;
+	std::vector< double > numbers;
+	std::string floats_key;
+
+	//helpers:
+	//the float array turned out to hold something other than numbers, so send it on as a regular value:
+	// (where it will be reported as an error or unhandled property, as appropriate)
+	void not_numbers() {
+		object.on_key(floats_key);
+		object.on_array_begin();
+		for (double number : numbers) {
+			object.on_number(number);
+		}
+		float_arrays.erase(floats_key);
+		floats = false;
+	}
+	//values directly in the top-level array should be objects (after the magic value):
+	void not_object() const {
+		if (depth == 0) throw std::runtime_error("Top-level value of s72 file should be an array.");
+		if (index == 0) throw std::runtime_error("First element of s72 array should be \"s72-v2\".");
+		throw std::runtime_error("Array element " + std::to_string(index) + " is not an object.");
+	}
+	//a value is starting inside a top-level object, so pass on any held-back key:
+	void member_value() {
+		if (depth == 2 && have_key) {
+			object.on_key(key);
+			have_key = false;
+		}
+	}
+
+	void on_object_begin() override {
+		if (floats) not_numbers();
+		if (depth <= 1) {
+			if (depth == 0 || index == 0) not_object();
+			float_arrays.clear();
+		}
+		member_value();
+		object.on_object_begin();
+		depth += 1;
+	}
+	void on_key(std::string_view key_) override {
+		if (depth == 2) {
+			key = key_;
+			have_key = true;
+		} else {
+			object.on_key(key_);
+		}
+	}
+	void on_object_end() override {
+		object.on_object_end();
+		depth -= 1;
+		if (depth == 1) {
+			sejp::document document = object.finish();
+			on_object(document.root().as_object().value(), float_arrays, index);
+			index += 1;
+		}
+	}
+	void on_array_begin() override {
+		if (floats) not_numbers();
+		if (depth <= 1) {
+			if (depth == 1) not_object();
+			depth = 1; //top-level array
+			return;
+		}
+		if (depth == 2 && have_key && (key == "times" || key == "values")) {
+			floats_key = key;
+			floats = true;
+			numbers.clear();
+			have_key = false;
+			depth += 1;
+			return;
+		}
+		member_value();
+		object.on_array_begin();
+		depth += 1;
+	}
+	void on_array_end() override {
+		if (floats) {
+			//(if a key is repeated, the last value wins -- as in sejp's documents)
+			std::vector< float > &array = float_arrays[floats_key];
+			array.clear();
+			array.reserve(numbers.size());
+			for (double number : numbers) {
+				array.emplace_back(float(number));
+			}
+			floats = false;
+		} else if (depth == 1) {
+			if (index == 0) not_object(); //(missing magic value)
+		} else {
+			object.on_array_end();
+		}
+		depth -= 1;
+	}
+	void on_string(std::string_view str) override {
+		if (floats) not_numbers();
+		if (depth <= 1) {
+			//check magic value:
+			if (depth == 1 && index == 0 && str == "s72-v2") {
+				index = 1;
+				return;
+			}
+			not_object();
+		}
+		member_value();
+		object.on_string(str);
+	}
+	void on_number(double number) override {
+		if (floats) {
+			numbers.emplace_back(number);
+			return;
+		}
+		if (depth <= 1) not_object();
+		member_value();
+		object.on_number(number);
+	}
+	void on_bool(bool b) override {
+		if (floats) not_numbers();
+		if (depth <= 1) not_object();
+		member_value();
+		object.on_bool(b);
+	}
+	void on_null() override {
+		if (floats) not_numbers();
+		if (depth <= 1) not_object();
+		member_value();
+		object.on_null();
+	}
+};
 
-	S72 s72; //the loaded scene, will be returned at end of function
 
-	sejp::value json = sejp::load(scene_file);
+//find (or make) the object in 'into' that has the same name as each object in 'from':
+template< typename T >
+static std::unordered_map< T const *, T * > match_objects(S72::NameMap< T > &into, S72::NameMap< T > const &from) {
+	std::unordered_map< T const *, T * > ret;
+	ret.reserve(from.size());
+	for (auto const &[key, value] : from) {
+		ret.emplace(&value, &into[key]);
+	}
+	return ret;
+}
 
-	std::optional< std::vector< sejp::value > > array = json.as_array();
+//move the objects loaded into 'from' into 'into', pointing references at the objects in 'into':
+// (used by S72::load to combine the scenes loaded by each thread; 'from' holds objects from later in the file)
+// throws if both scenes define an object with the same name
+static void merge_scene(S72 &into, S72 &from) {
+	//references may have made (unnamed) placeholder objects, so every object needs a match:
+	auto nodes = match_objects(into.nodes, from.nodes);
+	auto meshes = match_objects(into.meshes, from.meshes);
+	auto data_files = match_objects(into.data_files, from.data_files);
+	auto cameras = match_objects(into.cameras, from.cameras);
+	auto materials = match_objects(into.materials, from.materials);
+	auto textures = match_objects(into.textures, from.textures);
+	auto environments = match_objects(into.environments, from.environments);
+	auto lights = match_objects(into.lights, from.lights);
+
+	auto remap = [](auto const &map, auto *ptr) {
+		return ptr ? map.at(ptr) : nullptr;
+	};
 
-	//fetch top-level array from scene file:
-	if (!array) {
-		throw std::runtime_error("Top-level value of s72 file should be an array.");
+	if (from.scene.name != "") {
+		if (into.scene.name != "") {
+			throw std::runtime_error("Multiple \"SCENE\" objects in s72 file.");
+		}
+		into.scene.name = from.scene.name;
+		for (S72::Node *root : from.scene.roots) {
+			into.scene.roots.emplace_back(nodes.at(root));
+		}
 	}
 
-	//check magic value:
-	if (!(array->size() >= 1 && array->at(0).as_string() && array->at(0).as_string().value() == "s72-v2")) {
-		throw std::runtime_error("First element of s72 array should be \"s72-v2\".");
+	for (auto &[name, node] : from.nodes) {
+		if (node.name == "") continue; //(placeholder)
+		S72::Node &to = *nodes.at(&node);
+		if (to.name != "") {
+			throw std::runtime_error("Multiple \"NODE\" objects with name \"" + name + "\".");
+		}
+		to.name = node.name;
+		to.translation = node.translation;
+		to.rotation = node.rotation;
+		to.scale = node.scale;
+		to.children.reserve(node.children.size());
+		for (S72::Node *child : node.children) {
+			to.children.emplace_back(nodes.at(child));
+		}
+		to.mesh = remap(meshes, node.mesh);
+		to.camera = remap(cameras, node.camera);
+		to.environment = remap(environments, node.environment);
+		to.light = remap(lights, node.light);
+	}
+
+	for (auto &[name, mesh] : from.meshes) {
+		if (mesh.name == "") continue; //(placeholder)
+		S72::Mesh &to = *meshes.at(&mesh);
+		if (to.name != "") {
+			throw std::runtime_error("Multiple \"MESH\" objects with name \"" + name + "\".");
+		}
+		to.name = mesh.name;
+		to.topology = mesh.topology;
+		to.count = mesh.count;
+		if (mesh.indices) {
+			to.indices.emplace(S72::Mesh::Indices{
+				.src = *data_files.at(&mesh.indices->src),
+				.offset = mesh.indices->offset,
+				.format = mesh.indices->format,
+			});
+		}
+		for (auto const &[key, attribute] : mesh.attributes) {
+			to.attributes.emplace(key, S72::Mesh::Attribute{
+				.src = *data_files.at(&attribute.src),
+				.offset = attribute.offset,
+				.stride = attribute.stride,
+				.format = attribute.format,
+			});
+		}
+		to.material = remap(materials, mesh.material);
+	}
+
+	for (auto &[name, camera] : from.cameras) {
+		if (camera.name == "") continue; //(placeholder)
+		S72::Camera &to = *cameras.at(&camera);
+		if (to.name != "") {
+			throw std::runtime_error("Multiple \"CAMERA\" objects with name \"" + name + "\".");
+		}
+		to = std::move(camera);
+	}
+
+	//(drivers are applied in file order, and 'from' comes later in the file)
+	into.drivers.reserve(into.drivers.size() + from.drivers.size());
+	for (auto &driver : from.drivers) {
+		into.drivers.emplace_back(S72::Driver{
+			.name = std::move(driver.name),
+			.node = *nodes.at(&driver.node),
+			.channel = driver.channel,
+			.times = std::move(driver.times),
+			.values = std::move(driver.values),
+			.interpolation = driver.interpolation,
+		});
+	}
+
+	//textures are keyed by everything they hold, so matching ones are the same:
+	for (auto &[key, texture] : from.textures) {
+		*textures.at(&texture) = texture;
 	}
 
-	//parse the remaining objects;
-	for (size_t i = 1; i < array->size(); i++) {
+	for (auto &[name, material] : from.materials) {
+		if (material.name == "") continue; //(placeholder)
+		S72::Material &to = *materials.at(&material);
+		if (to.name != "") {
+			throw std::runtime_error("Multiple \"MATERIAL\" objects with name \"" + name + "\".");
+		}
+		to = std::move(material);
+		to.normal_map = remap(textures, to.normal_map);
+		to.displacement_map = remap(textures, to.displacement_map);
+		auto remap_parameter = [&](auto &parameter) {
+			if (S72::Texture **texture = std::get_if< S72::Texture * >(&parameter)) {
+				*texture = textures.at(*texture);
+			}
+		};
+		if (S72::Material::PBR *pbr = std::get_if< S72::Material::PBR >(&to.brdf)) {
+			remap_parameter(pbr->albedo);
+			remap_parameter(pbr->roughness);
+			remap_parameter(pbr->metalness);
+		} else if (S72::Material::Lambertian *lambertian = std::get_if< S72::Material::Lambertian >(&to.brdf)) {
+			remap_parameter(lambertian->albedo);
+		}
+	}
+
+	for (auto &[name, environment] : from.environments) {
+		if (environment.name == "") continue; //(placeholder)
+		S72::Environment &to = *environments.at(&environment);
+		if (to.name != "") {
+			throw std::runtime_error("Multiple \"ENVIRONMENT\" objects with name \"" + name + "\".");
+		}
+		to.name = environment.name;
+		to.radiance = textures.at(environment.radiance);
+	}
 
-		//make a copy of the object and erase members as they are parsed:
-		std::map< std::string, sejp::value > object;
-		try {
-			object = array->at(i).as_object().value();
-		} catch (std::exception &) {
-			throw std::runtime_error("Array element " + std::to_string(i) + " is not an object.");
+	for (auto &[name, light] : from.lights) {
+		if (light.name == "") continue; //(placeholder)
+		S72::Light &to = *lights.at(&light);
+		if (to.name != "") {
+			throw std::runtime_error("Multiple \"LIGHT\" objects with name \"" + name + "\".");
 		}
+		to = std::move(light);
+	}
+}
+
+
+S72 S72::load(std::string const &scene_file, uint32_t threads) {
+
+	//load one object from the file's top-level array into a scene:
+	auto load_object = [](S72 &s72, sejp::object_view const &object_view, std::map< std::string, std::vector< float > > &float_arrays, size_t i) {
+
+		//borrow the object's members and mark them as handled as they are parsed:
+		Members object(object_view);
 
 		//All objects must have a "type" and "name":
-		std::string type = extract_string(&object, "type", "Object at index " + std::to_string(i) + "'s \"type\"");
-		std::string name = extract_string(&object, "name", "Object at index " + std::to_string(i) + "'s \"name\"");
+		std::string_view type = extract_string(&object, "type", [&]{ return "Object at index " + std::to_string(i) + "'s \"type\""; });
+		std::string name(extract_string(&object, "name", [&]{ return "Object at index " + std::to_string(i) + "'s \"name\""; }));
 
 		if (type == "SCENE") {
 			//reference to the object we are parsing into:
@@ -309,18 +675,13 @@ S72 S72::load(std::string const &scene_file) {
 
 			//"roots" is optional:
 			if (auto f = object.find("roots"); f != object.end()) {
-				std::vector< std::string > refs;
-				try {
-					std::vector< sejp::value > const &vec = f->second.as_array().value();
-					for (auto const &value : vec) {
-						refs.emplace_back(value.as_string().value());
-					}
-				} catch (std::exception &) {
-					throw std::runtime_error("Scene \"" + name + "\"'s roots are not an array of strings.");
-				}
-				scene.roots.reserve(refs.size());
-				for (auto const &ref : refs) {
-					scene.roots.emplace_back(&s72.nodes[ref]); //NOTE: creates new (empty) nodes if not yet parsed; will check for this later
+				std::optional< sejp::array_view > vec = f->second.as_array();
+				if (!vec) throw std::runtime_error("Scene \"" + name + "\"'s roots are not an array of strings.");
+				scene.roots.reserve(vec->size());
+				for (auto const &value : *vec) {
+					std::optional< std::string_view > ref = value.as_string();
+					if (!ref) throw std::runtime_error("Scene \"" + name + "\"'s roots are not an array of strings.");
+					scene.roots.emplace_back(&find_or_add(s72.nodes, *ref)); //NOTE: creates new (empty) nodes if not yet parsed; will check for this later
 				}
 				object.erase(f);
 			}
@@ -338,7 +699,7 @@ S72 S72::load(std::string const &scene_file) {
 
 			if (auto f = object.find("translation"); f != object.end()) {
 				try {
-					std::vector< sejp::value > const &vec = f->second.as_array().value();
+					sejp::array_view vec = f->second.as_array().value();
 					node.translation = vec3{
 						.x = float(vec.at(0).as_number().value()),
 						.y = float(vec.at(1).as_number().value()),
@@ -353,7 +714,7 @@ S72 S72::load(std::string const &scene_file) {
 
 			if (auto f = object.find("rotation"); f != object.end()) {
 				try {
-					std::vector< sejp::value > const &vec = f->second.as_array().value();
+					sejp::array_view vec = f->second.as_array().value();
 					node.rotation = quat{
 						.x = float(vec.at(0).as_number().value()),
 						.y = float(vec.at(1).as_number().value()),
@@ -369,7 +730,7 @@ S72 S72::load(std::string const &scene_file) {
 
 			if (auto f = object.find("scale"); f != object.end()) {
 				try {
-					std::vector< sejp::value > const &vec = f->second.as_array().value();
+					sejp::array_view vec = f->second.as_array().value();
 					node.scale = vec3{
 						.x = float(vec.at(0).as_number().value()),
 						.y = float(vec.at(1).as_number().value()),
@@ -383,64 +744,59 @@ S72 S72::load(std::string const &scene_file) {
 			}
 
 			if (auto f = object.find("children"); f != object.end()) {
-				std::vector< std::string > refs;
-				try {
-					std::vector< sejp::value > const &vec = f->second.as_array().value();
-					for (auto const &value : vec) {
-						refs.emplace_back(value.as_string().value());
-					}
-				} catch (std::exception &) {
-					throw std::runtime_error("Node \"" + name + "\"'s children should be an array of strings.");
-				}
+				std::optional< sejp::array_view > vec = f->second.as_array();
+				if (!vec) throw std::runtime_error("Node \"" + name + "\"'s children should be an array of strings.");
 				//create/fixup pointers to other nodes:
-				node.children.reserve(refs.size());
-				for (auto const &ref : refs) {
-					node.children.emplace_back(&s72.nodes[ref]);
+				node.children.reserve(vec->size());
+				for (auto const &value : *vec) {
+					std::optional< std::string_view > ref = value.as_string();
+					if (!ref) throw std::runtime_error("Node \"" + name + "\"'s children should be an array of strings.");
+					node.children.emplace_back(&find_or_add(s72.nodes, *ref));
 				}
 				object.erase(f);
 			}
 
 			if (auto f = object.find("mesh"); f != object.end()) {
-				std::string ref;
+				std::string_view ref;
 				try {
 					ref = f->second.as_string().value();
 				} catch (std::exception &) {
 					throw std::runtime_error("Node \"" + name + "\"'s mesh should be a string.");
 				}
-				node.mesh = &s72.meshes[ref];
+				node.mesh = &find_or_add(s72.meshes, ref);
 				object.erase(f);
 			}
 
 			if (auto f = object.find("camera"); f != object.end()) {
-				std::string ref;
+				std::string_view ref;
 				try {
 					ref = f->second.as_string().value();
 				} catch (std::exception &) {
 					throw std::runtime_error("Node \"" + name + "\"'s camera should be a string.");
 				}
-				node.camera = &s72.cameras[ref];
+				node.camera = &find_or_add(s72.cameras, ref);
 				object.erase(f);
 			}
 
 			if (auto f = object.find("environment"); f != object.end()) {
-				std::string ref;
+				std::string_view ref;
 				try {
 					ref = f->second.as_string().value();
 				} catch (std::exception &) {
 					throw std::runtime_error("Node \"" + name + "\"'s environment should be a string.");
 				}
-				node.environment = &s72.environments[ref];
+				node.environment = &find_or_add(s72.environments, ref);
 				object.erase(f);
 			}
 
 			if (auto f = object.find("light"); f != object.end()) {
-				std::string ref;
+				std::string_view ref;
 				try {
 					ref = f->second.as_string().value();
 				} catch (std::exception &) {
 					throw std::runtime_error("Node \"" + name + "\"'s light should be a string.");
 				}
-				node.light = &s72.lights[ref];
+				node.light = &find_or_add(s72.lights, ref);
 				object.erase(f);
 			}
 
@@ -456,34 +812,34 @@ S72 S72::load(std::string const &scene_file) {
 			//mark as parsed:
 			mesh.name = name;
 
-			std::string topology = extract_string(&object, "topology", "Mesh \"" + name + "\"'s topology");
+			std::string_view topology = extract_string(&object, "topology", [&]{ return "Mesh \"" + name + "\"'s topology"; });
 			mesh.topology = topology_to_VkPrimitiveTopology(topology);
 
-			mesh.count = extract_uint32_t(&object, "count", "Mesh \"" + name + "\"'s count");
+			mesh.count = extract_uint32_t(&object, "count", [&]{ return "Mesh \"" + name + "\"'s count"; });
 
 			if (auto f = object.find("indices"); f != object.end()) {
-				std::map< std::string, sejp::value > obj;
+				Members obj;
 				try {
-					obj = f->second.as_object().value();
+					obj = Members(f->second.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Mesh \"" + name + "\"'s indices should be an object.");
 				}
 
-				std::string src = extract_string(&obj, "src", "Mesh \"" + name + "\"'s indices.src");
-				uint32_t offset = extract_uint32_t(&obj, "offset", "Mesh \"" + name + "\"'s indices.offset");
-				std::string format = extract_string(&obj, "format", "Mesh \"" + name + "\"'s indices.format");
+				std::string_view src = extract_string(&obj, "src", [&]{ return "Mesh \"" + name + "\"'s indices.src"; });
+				uint32_t offset = extract_uint32_t(&obj, "offset", [&]{ return "Mesh \"" + name + "\"'s indices.offset"; });
+				std::string_view format = extract_string(&obj, "format", [&]{ return "Mesh \"" + name + "\"'s indices.format"; });
 				mesh.indices.emplace(Mesh::Indices{
-					.src = s72.data_files[src],
+					.src = find_or_add(s72.data_files, src),
 					.offset = offset,
 					.format = format_to_VkIndexType(format),
 				});
 
-				warn_on_unhandled(obj, "Mesh \"" + name + "\"'s indices");
+				warn_on_unhandled(obj, [&]{ return "Mesh \"" + name + "\"'s indices"; });
 
 				object.erase(f);
 			}
 
-			std::map< std::string, sejp::value > attributes;
+			sejp::object_view attributes;
 			try {
 				attributes = object.at("attributes").as_object().value();
 			} catch (std::exception &) {
@@ -491,37 +847,39 @@ S72 S72::load(std::string const &scene_file) {
 			}
 			object.erase(object.find("attributes"));
 
-			for (auto const &[key, value] : attributes) {
-				std::map< std::string, sejp::value > obj;
+			mesh.attributes.reserve(attributes.size());
+			for (auto const &[key_view, value] : attributes) {
+				std::string key(key_view);
+				Members obj;
 				try {
-					obj = value.as_object().value();
+					obj = Members(value.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Mesh \"" + name + "\"'s attribute \"" + key + "\" is not an object.");
 				}
 
-				std::string src = extract_string(&obj, "src", "Mesh \"" + name + "\"'s attribute \"" + key + "\"'s src");
-				uint32_t offset = extract_uint32_t(&obj, "offset", "Mesh \"" + name + "\"'s attribute \"" + key + "\"' offset");
-				uint32_t stride = extract_uint32_t(&obj, "stride", "Mesh \"" + name + "\"'s attribute \"" + key + "\"' stride");
-				std::string format = extract_string(&obj, "format", "Mesh \"" + name + "\"'s attribute \"" + key + "\"'s format");
+				std::string_view src = extract_string(&obj, "src", [&]{ return "Mesh \"" + name + "\"'s attribute \"" + key + "\"'s src"; });
+				uint32_t offset = extract_uint32_t(&obj, "offset", [&]{ return "Mesh \"" + name + "\"'s attribute \"" + key + "\"' offset"; });
+				uint32_t stride = extract_uint32_t(&obj, "stride", [&]{ return "Mesh \"" + name + "\"'s attribute \"" + key + "\"' stride"; });
+				std::string_view format = extract_string(&obj, "format", [&]{ return "Mesh \"" + name + "\"'s attribute \"" + key + "\"'s format"; });
 				mesh.attributes.emplace(key, Mesh::Attribute{
-					.src = s72.data_files[src],
+					.src = find_or_add(s72.data_files, src),
 					.offset = offset,
 					.stride = stride,
 					.format = format_to_VkFormat(format),
 				});
 
-				warn_on_unhandled(obj, "Mesh \"" + name + "\"'s attribute \"" + key + "\"");
+				warn_on_unhandled(obj, [&]{ return "Mesh \"" + name + "\"'s attribute \"" + key + "\""; });
 			}
 
 			if (auto f = object.find("material"); f != object.end()) {
-				std::string material;
+				std::string_view material;
 				try {
 					material = f->second.as_string().value();
 				} catch (std::exception &) {
 					throw std::runtime_error("Mesh \"" + name + "\"'s material is not a string.");
 				}
 				object.erase(f);
-				mesh.material = &s72.materials[material];
+				mesh.material = &find_or_add(s72.materials, material);
 			}
 
 		} else if (type == "CAMERA") {
@@ -544,25 +902,25 @@ S72 S72::load(std::string const &scene_file) {
 				}
 				have_projection = true;
 
-				std::map< std::string, sejp::value > obj;
+				Members obj;
 				try {
-					obj = f->second.as_object().value();
+					obj = Members(f->second.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Camera \"" + name + "\"'s projection is not an object.");
 				}
 
 				Camera::Perspective perspective;
 
-				perspective.aspect = extract_float(&obj, "aspect", "Camera \"" + name + "\"'s projection.aspect");
-				perspective.vfov = extract_float(&obj, "vfov", "Camera \"" + name + "\"'s projection.vfov");
-				perspective.near = extract_float(&obj, "near", "Camera \"" + name + "\"'s projection.near");
+				perspective.aspect = extract_float(&obj, "aspect", [&]{ return "Camera \"" + name + "\"'s projection.aspect"; });
+				perspective.vfov = extract_float(&obj, "vfov", [&]{ return "Camera \"" + name + "\"'s projection.vfov"; });
+				perspective.near = extract_float(&obj, "near", [&]{ return "Camera \"" + name + "\"'s projection.near"; });
 				if (obj.contains("far")) {
-					perspective.far = extract_float(&obj, "far", "Camera \"" + name + "\"'s projection.far");
+					perspective.far = extract_float(&obj, "far", [&]{ return "Camera \"" + name + "\"'s projection.far"; });
 				}
 
 				camera.projection = perspective;
 
-				warn_on_unhandled(obj, "Material \"" + name + "\"'s perspective");
+				warn_on_unhandled(obj, [&]{ return "Material \"" + name + "\"'s perspective"; });
 
 				object.erase(f);
 			}
@@ -574,32 +932,32 @@ S72 S72::load(std::string const &scene_file) {
 		} else if (type == "DRIVER") {
 			//NOTE: not building into an existing object because we need to have a node reference ready when constructing.
 
-			std::string node = extract_string(&object, "node", "Driver \"" + name + "\"'s node");
+			std::string_view node = extract_string(&object, "node", [&]{ return "Driver \"" + name + "\"'s node"; });
 
 			Driver::Channel channel;
 			{ //get channel:
-				static std::map< std::string, Driver::Channel > string_to_channel{
+				static std::map< std::string, Driver::Channel, std::less<> > string_to_channel{
 					{"translation", Driver::Channel::translation},
 					{"rotation", Driver::Channel::rotation},
 					{"scale", Driver::Channel::scale},
 				};
 
-				std::string str = extract_string(&object, "channel", "Driver \"" + name + "\"'s channel");
-				try {
-					channel = string_to_channel.at(str);
-				} catch (std::exception &) {
-					throw std::runtime_error("Driver \"" + name + "\"'s channel \"" + str + "\" is not a recognized channel name.");
+				std::string_view str = extract_string(&object, "channel", [&]{ return "Driver \"" + name + "\"'s channel"; });
+				auto f = string_to_channel.find(str);
+				if (f == string_to_channel.end()) {
+					throw std::runtime_error("Driver \"" + name + "\"'s channel \"" + std::string(str) + "\" is not a recognized channel name.");
 				}
+				channel = f->second;
 			}
 
-			std::vector< float > times = extract_float_vector(&object, "times", "Driver \"" + name + "\"'s times");
+			std::vector< float > times = extract_float_array(&float_arrays, "times", [&]{ return "Driver \"" + name + "\"'s times"; });
 			for (size_t t = 1; t < times.size(); ++t) {
 				if (times[t-1] > times[t]) {
 					throw std::runtime_error("Driver \"" + name + "\"'s times are not non-decreasing.");
 				}
 			}
 
-			std::vector< float > values = extract_float_vector(&object, "values", "Driver \"" + name + "\"'s values");
+			std::vector< float > values = extract_float_array(&float_arrays, "values", [&]{ return "Driver \"" + name + "\"'s values"; });
 
 			//check that times/values counts are consistent with channel type:
 			if (channel == Driver::Channel::translation || channel == Driver::Channel::scale) {
@@ -616,23 +974,23 @@ S72 S72::load(std::string const &scene_file) {
 
 			Driver::Interpolation interpolation = Driver::Interpolation::LINEAR;
 			if(object.contains("interpolation")){
-				static std::map< std::string, Driver::Interpolation > string_to_interpolation{
+				static std::map< std::string, Driver::Interpolation, std::less<> > string_to_interpolation{
 					{"STEP", Driver::Interpolation::STEP},
 					{"LINEAR", Driver::Interpolation::LINEAR},
 					{"SLERP", Driver::Interpolation::SLERP},
 				};
 
-				std::string str = extract_string(&object, "interpolation", "Driver \"" + name + "\"'s interpolation");
-				try {
-					interpolation = string_to_interpolation.at(str);
-				} catch (std::exception &) {
-					throw std::runtime_error("Driver \"" + name + "\"'s interpolation \"" + str + "\" is not a recognized interpolation name.");
+				std::string_view str = extract_string(&object, "interpolation", [&]{ return "Driver \"" + name + "\"'s interpolation"; });
+				auto f = string_to_interpolation.find(str);
+				if (f == string_to_interpolation.end()) {
+					throw std::runtime_error("Driver \"" + name + "\"'s interpolation \"" + std::string(str) + "\" is not a recognized interpolation name.");
 				}
+				interpolation = f->second;
 			}
 
 			s72.drivers.emplace_back(Driver{
 				.name = name,
-				.node = s72.nodes[node],
+				.node = find_or_add(s72.nodes, node),
 				.channel = channel,
 				.times = std::move(times),
 				.values = std::move(values),
@@ -650,10 +1008,10 @@ S72 S72::load(std::string const &scene_file) {
 			material.name = name;
 
 			if (object.contains("normalMap")) {
-				material.normal_map = &extract_map(&object, "normalMap", &s72, "Material \"" + name + "\"'s normalMap");
+				material.normal_map = &extract_map(&object, "normalMap", &s72, [&]{ return "Material \"" + name + "\"'s normalMap"; });
 			}
 			if (object.contains("displacementMap")) {
-				material.displacement_map = &extract_map(&object, "displacementMap", &s72, "Material \"" + name + "\"'s displacementMap");
+				material.displacement_map = &extract_map(&object, "displacementMap", &s72, [&]{ return "Material \"" + name + "\"'s displacementMap"; });
 			}
 
 			bool have_brdf = false;
@@ -664,9 +1022,9 @@ S72 S72::load(std::string const &scene_file) {
 				}
 				have_brdf = true;
 
-				std::map< std::string, sejp::value > obj;
+				Members obj;
 				try {
-					obj = b->second.as_object().value();
+					obj = Members(b->second.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Material \"" + name + "\"'s pbr is not an object.");
 				}
@@ -674,10 +1032,10 @@ S72 S72::load(std::string const &scene_file) {
 				Material::PBR pbr;
 
 				if (auto f = obj.find("albedo"); f != obj.end()) {
-					if (std::optional< std::vector< sejp::value > > arr = f->second.as_array()) {
+					if (std::optional< sejp::array_view > arr = f->second.as_array()) {
 						//3-vector of color
 						try {
-							std::vector< sejp::value > const &vec = arr.value();
+							sejp::array_view vec = arr.value();
 							pbr.albedo = color{
 								.r = float(vec.at(0).as_number().value()),
 								.g = float(vec.at(1).as_number().value()),
@@ -689,7 +1047,7 @@ S72 S72::load(std::string const &scene_file) {
 						}
 						obj.erase(f);
 					} else {
-						pbr.albedo = &extract_map(&obj, "albedo", &s72, "Material \"" + name + "\"'s pbr.albedo");
+						pbr.albedo = &extract_map(&obj, "albedo", &s72, [&]{ return "Material \"" + name + "\"'s pbr.albedo"; });
 					}
 				}
 
@@ -698,7 +1056,7 @@ S72 S72::load(std::string const &scene_file) {
 						pbr.roughness = float(number.value());
 						obj.erase(f);
 					} else {
-						pbr.roughness = &extract_map(&obj, "roughness", &s72, "Material \"" + name + "\"'s pbr.roughness");
+						pbr.roughness = &extract_map(&obj, "roughness", &s72, [&]{ return "Material \"" + name + "\"'s pbr.roughness"; });
 					}
 				}
 
@@ -707,13 +1065,13 @@ S72 S72::load(std::string const &scene_file) {
 						pbr.metalness = float(number.value());
 						obj.erase(f);
 					} else {
-						pbr.metalness = &extract_map(&obj, "metalness", &s72, "Material \"" + name + "\"'s pbr.metalness");
+						pbr.metalness = &extract_map(&obj, "metalness", &s72, [&]{ return "Material \"" + name + "\"'s pbr.metalness"; });
 					}
 				}
 
 				material.brdf = pbr;
 
-				warn_on_unhandled(obj, "Material \"" + name + "\"'s pbr");
+				warn_on_unhandled(obj, [&]{ return "Material \"" + name + "\"'s pbr"; });
 
 				object.erase(b);
 			}
@@ -724,9 +1082,9 @@ S72 S72::load(std::string const &scene_file) {
 				}
 				have_brdf = true;
 
-				std::map< std::string, sejp::value > obj;
+				Members obj;
 				try {
-					obj = b->second.as_object().value();
+					obj = Members(b->second.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Material \"" + name + "\"'s lambertian is not an object.");
 				}
@@ -734,10 +1092,10 @@ S72 S72::load(std::string const &scene_file) {
 				Material::Lambertian lambertian;
 
 				if (auto f = obj.find("albedo"); f != obj.end()) {
-					if (std::optional< std::vector< sejp::value > > arr = f->second.as_array()) {
+					if (std::optional< sejp::array_view > arr = f->second.as_array()) {
 						//3-vector of color
 						try {
-							std::vector< sejp::value > const &vec = arr.value();
+							sejp::array_view vec = arr.value();
 							lambertian.albedo = color{
 								.r = float(vec.at(0).as_number().value()),
 								.g = float(vec.at(1).as_number().value()),
@@ -749,13 +1107,13 @@ S72 S72::load(std::string const &scene_file) {
 						}
 						obj.erase(f);
 					} else {
-						lambertian.albedo = &extract_map(&obj, "albedo", &s72, "Material \"" + name + "\"'s lambertian.albedo");
+						lambertian.albedo = &extract_map(&obj, "albedo", &s72, [&]{ return "Material \"" + name + "\"'s lambertian.albedo"; });
 					}
 				}
 
 				material.brdf = lambertian;
 
-				warn_on_unhandled(obj, "Material \"" + name + "\"'s lambertian");
+				warn_on_unhandled(obj, [&]{ return "Material \"" + name + "\"'s lambertian"; });
 
 				object.erase(b);
 			}
@@ -766,9 +1124,9 @@ S72 S72::load(std::string const &scene_file) {
 				}
 				have_brdf = true;
 
-				std::map< std::string, sejp::value > obj;
+				Members obj;
 				try {
-					obj = b->second.as_object().value();
+					obj = Members(b->second.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Material \"" + name + "\"'s mirror is not an object.");
 				}
@@ -779,7 +1137,7 @@ S72 S72::load(std::string const &scene_file) {
 
 				material.brdf = mirror;
 
-				warn_on_unhandled(obj, "Material \"" + name + "\"'s mirror");
+				warn_on_unhandled(obj, [&]{ return "Material \"" + name + "\"'s mirror"; });
 
 				object.erase(b);
 			}
@@ -790,9 +1148,9 @@ S72 S72::load(std::string const &scene_file) {
 				}
 				have_brdf = true;
 
-				std::map< std::string, sejp::value > obj;
+				Members obj;
 				try {
-					obj = b->second.as_object().value();
+					obj = Members(b->second.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Material \"" + name + "\"'s environment is not an object.");
 				}
@@ -803,7 +1161,7 @@ S72 S72::load(std::string const &scene_file) {
 
 				material.brdf = environment;
 
-				warn_on_unhandled(obj, "Material \"" + name + "\"'s environment");
+				warn_on_unhandled(obj, [&]{ return "Material \"" + name + "\"'s environment"; });
 
 				object.erase(b);
 			}
@@ -823,7 +1181,7 @@ S72 S72::load(std::string const &scene_file) {
 			//mark as parsed:
 			environment.name = name;
 
-			environment.radiance = &extract_map(&object, "radiance", &s72, "Environment \"" + name + "\"'s radiance");
+			environment.radiance = &extract_map(&object, "radiance", &s72, [&]{ return "Environment \"" + name + "\"'s radiance"; });
 
 			if (environment.radiance->type != Texture::Type::cube) {
 				throw std::runtime_error("Environment \"" + name + "\"'s radiance is not a cube.");
@@ -842,7 +1200,7 @@ S72 S72::load(std::string const &scene_file) {
 
 			if (auto f = object.find("tint"); f != object.end()) {
 				try {
-					std::vector< sejp::value > const &vec = f->second.as_array().value();
+					sejp::array_view vec = f->second.as_array().value();
 					light.tint = color{
 						.r = float(vec.at(0).as_number().value()),
 						.g = float(vec.at(1).as_number().value()),
@@ -855,7 +1213,7 @@ S72 S72::load(std::string const &scene_file) {
 				object.erase(f);
 			}
 			if (object.contains("shadow")){
-				light.shadow = extract_uint32_t(&object, "shadow", "Light \"" + name + "\"'s shadow");
+				light.shadow = extract_uint32_t(&object, "shadow", [&]{ return "Light \"" + name + "\"'s shadow"; });
 			}
 
 			bool have_source = false;
@@ -866,21 +1224,21 @@ S72 S72::load(std::string const &scene_file) {
 				}
 				have_source = true;
 
-				std::map< std::string, sejp::value > obj;
+				Members obj;
 				try {
-					obj = f->second.as_object().value();
+					obj = Members(f->second.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Light \"" + name + "\"'s sun is not an object.");
 				}
 
 				Light::Sun sun;
 
-				sun.angle = extract_float(&obj, "angle", "Light \"" + name + "\"'s sun's angle");
-				sun.strength = extract_float(&obj, "strength", "Light \"" + name + "\"'s sun's strength");
+				sun.angle = extract_float(&obj, "angle", [&]{ return "Light \"" + name + "\"'s sun's angle"; });
+				sun.strength = extract_float(&obj, "strength", [&]{ return "Light \"" + name + "\"'s sun's strength"; });
 
 				light.source = sun;
 
-				warn_on_unhandled(obj, "Light \"" + name + "\"'s sun");
+				warn_on_unhandled(obj, [&]{ return "Light \"" + name + "\"'s sun"; });
 				object.erase(f);
 			}
 			if (auto f = object.find("sphere"); f != object.end()) {
@@ -889,24 +1247,24 @@ S72 S72::load(std::string const &scene_file) {
 				}
 				have_source = true;
 
-				std::map< std::string, sejp::value > obj;
+				Members obj;
 				try {
-					obj = f->second.as_object().value();
+					obj = Members(f->second.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Light \"" + name + "\"'s sphere is not an object.");
 				}
 
 				Light::Sphere sphere;
 
-				sphere.radius = extract_float(&obj, "radius", "Light \"" + name + "\"'s sphere's radius");
-				sphere.power = extract_float(&obj, "power", "Light \"" + name + "\"'s sphere's power");
+				sphere.radius = extract_float(&obj, "radius", [&]{ return "Light \"" + name + "\"'s sphere's radius"; });
+				sphere.power = extract_float(&obj, "power", [&]{ return "Light \"" + name + "\"'s sphere's power"; });
 				if (obj.contains("limit")) {
-					sphere.limit = extract_float(&obj, "limit", "Light \"" + name + "\"'s sphere's limit");
+					sphere.limit = extract_float(&obj, "limit", [&]{ return "Light \"" + name + "\"'s sphere's limit"; });
 				}
 
 				light.source = sphere;
 
-				warn_on_unhandled(obj, "Light \"" + name + "\"'s sphere");
+				warn_on_unhandled(obj, [&]{ return "Light \"" + name + "\"'s sphere"; });
 				object.erase(f);
 			}
 			if (auto f = object.find("spot"); f != object.end()) {
@@ -915,26 +1273,26 @@ S72 S72::load(std::string const &scene_file) {
 				}
 				have_source = true;
 
-				std::map< std::string, sejp::value > obj;
+				Members obj;
 				try {
-					obj = f->second.as_object().value();
+					obj = Members(f->second.as_object().value());
 				} catch (std::exception &) {
 					throw std::runtime_error("Light \"" + name + "\"'s spot is not an object.");
 				}
 
 				Light::Spot spot;
 
-				spot.radius = extract_float(&obj, "radius", "Light \"" + name + "\"'s spot's radius");
-				spot.power = extract_float(&obj, "power", "Light \"" + name + "\"'s spot's power");
+				spot.radius = extract_float(&obj, "radius", [&]{ return "Light \"" + name + "\"'s spot's radius"; });
+				spot.power = extract_float(&obj, "power", [&]{ return "Light \"" + name + "\"'s spot's power"; });
 				if (obj.contains("limit")) {
-					spot.limit = extract_float(&obj, "limit", "Light \"" + name + "\"'s spot's limit");
+					spot.limit = extract_float(&obj, "limit", [&]{ return "Light \"" + name + "\"'s spot's limit"; });
 				}
-				spot.fov = extract_float(&obj, "fov", "Light \"" + name + "\"'s spot's fov");
-				spot.blend = extract_float(&obj, "blend", "Light \"" + name + "\"'s spot's blend");
+				spot.fov = extract_float(&obj, "fov", [&]{ return "Light \"" + name + "\"'s spot's fov"; });
+				spot.blend = extract_float(&obj, "blend", [&]{ return "Light \"" + name + "\"'s spot's blend"; });
 
 				light.source = spot;
 
-				warn_on_unhandled(obj, "Light \"" + name + "\"'s spot");
+				warn_on_unhandled(obj, [&]{ return "Light \"" + name + "\"'s spot"; });
 				object.erase(f);
 			}
 
@@ -942,9 +1300,92 @@ S72 S72::load(std::string const &scene_file) {
 				throw std::runtime_error("Light \"" + name + "\" is missing a source.");
 			}
 		} else {
-			std::cerr << "WARNING: ignoring object \"" << name << "\" of unrecognized type \"" << type << "\"." << std::endl;
+			*warnings << "WARNING: ignoring object \"" << name << "\" of unrecognized type \"" << type << "\"." << std::endl;
+		}
+		warn_on_unhandled(object, [&]{ return "Object \"" + name + "\""; }, float_arrays);
+	};
+
+	S72 s72; //the loaded scene, will be returned at end of function
+
+	if (threads <= 1) {
+		//parse each object in the file's top-level array as it is read:
+		S72Events events;
+		events.on_object = [&](sejp::object_view const &object, std::map< std::string, std::vector< float > > &float_arrays, size_t i) {
+			load_object(s72, object, float_arrays, i);
+		};
+		sejp::load(scene_file, events);
+	} else {
+		//find where each element of the file's top-level array starts and ends,
+		// then load runs of elements on several threads, each into a scene of its own:
+		std::string buffer = sejp::read_file(scene_file);
+
+		std::optional< std::vector< std::string_view > > elements = sejp::split_array(buffer);
+		if (!elements) throw std::runtime_error("Top-level value of s72 file should be an array.");
+		if (elements->empty()) throw std::runtime_error("First element of s72 array should be \"s72-v2\".");
+
+		struct Part {
+			size_t begin = 0, end = 0; //range of elements
+			S72 s72;
+			std::ostringstream warnings;
+			std::exception_ptr error;
+		};
+		std::vector< Part > parts(std::min< size_t >(threads, elements->size()));
+
+		{ //split the elements into runs of about the same number of bytes:
+			size_t total = 0;
+			for (std::string_view element : *elements) {
+				total += element.size();
+			}
+			size_t e = 0;
+			size_t bytes = 0;
+			for (size_t p = 0; p < parts.size(); ++p) {
+				parts[p].begin = e;
+				size_t target = total * (p + 1) / parts.size();
+				while (e < elements->size() && (p + 1 == parts.size() || bytes < target)) {
+					bytes += (*elements)[e].size();
+					e += 1;
+				}
+				parts[p].end = e;
+			}
+		}
+
+		auto load_part = [&](Part &part) {
+			warnings = &part.warnings;
+			try {
+				S72Events events;
+				events.on_object = [&](sejp::object_view const &object, std::map< std::string, std::vector< float > > &float_arrays, size_t i) {
+					load_object(part.s72, object, float_arrays, i);
+				};
+				for (size_t e = part.begin; e < part.end; ++e) {
+					//(each element is parsed as if it were read inside the top-level array)
+					events.depth = 1;
+					events.index = e;
+					sejp::parse((*elements)[e], events);
+				}
+			} catch (...) {
+				part.error = std::current_exception();
+			}
+			warnings = &std::cerr;
+		};
+
+		std::vector< std::thread > workers;
+		workers.reserve(parts.size() - 1);
+		for (size_t p = 1; p < parts.size(); ++p) {
+			workers.emplace_back(load_part, std::ref(parts[p]));
+		}
+		load_part(parts[0]);
+		for (auto &worker : workers) {
+			worker.join();
+		}
+
+		//combine the parts in file order, stopping at the first error:
+		// (NOTE: a name defined in two parts is only caught here, after the later part's warnings have been printed)
+		s72 = std::move(parts[0].s72);
+		for (size_t p = 0; p < parts.size(); ++p) {
+			std::cerr << parts[p].warnings.str();
+			if (p > 0) merge_scene(s72, parts[p].s72);
+			if (parts[p].error) std::rethrow_exception(parts[p].error);
 		}
-		warn_on_unhandled(object, "Object \"" + name + "\"");
 	}
 
 
@@ -6,9 +6,12 @@
 #include <vulkan/vulkan_core.h>
 #include <vulkan/vulkan.h>
 
+#include <cstdint>
+#include <functional>
 #include <limits>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -48,7 +51,21 @@ struct S72 {
 
 	//-------------------------------------------------
 
-	static S72 load(std::string const &file); //NOTE: throws on error
+	//NOTE: throws on error
+	//NOTE: if threads > 1, the objects in the file are parsed on that many threads (then combined)
+	static S72 load(std::string const &file, uint32_t threads = 1);
+
+	//compiled binary scenes ("file.s72c", written next to "file.s72"; see S72-cache.cpp):
+	//NOTE: load_cached uses file's cache if it was compiled from file's current contents,
+	//      otherwise it calls load() and (tries to) write the cache
+	//NOTE: loading from a cache doesn't repeat load()'s warnings about unhandled properties
+	static S72 load_cached(std::string const &file, uint32_t threads = 1);
+	void write_cache(std::string const &cache_file, uint64_t source_hash) const; //NOTE: throws on error
+	static uint64_t content_hash(std::string_view data); //fast (not cryptographic) hash used to match caches to files
+
+	//index-based copy of the scene for code that walks it every frame (see S72::Dense, below):
+	struct Dense;
+	Dense dense() const;
 
 	S72() = default; //empty scene
 
@@ -60,6 +77,14 @@ struct S72 {
 	S72(S72 &&) = default;
 	S72 &operator=(S72 &&) = default;
 
+	//objects are stored in maps by name, which can be searched with a std::string_view (without making a std::string):
+	struct NameHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view name) const { return std::hash< std::string_view >{}(name); }
+	};
+	template< typename T >
+	using NameMap = std::unordered_map< std::string, T, NameHash, std::equal_to<> >;
+
 	//forward declarations so we can write the scene's objects in the same order as in the spec:
 	struct Node;
 	struct Mesh;
@@ -97,7 +122,7 @@ struct S72 {
 		Environment *environment = nullptr;
 		Light *light = nullptr;
 	};
-	std::unordered_map< std::string, Node > nodes;
+	NameMap< Node > nodes;
 
 	//zero or more "MESH"s, all with unique names:
 	struct Mesh {
@@ -122,7 +147,7 @@ struct S72 {
 
 		Material *material = nullptr; //optional, null if not specified
 	};
-	std::unordered_map< std::string, Mesh > meshes;
+	NameMap< Mesh > meshes;
 
 	//data files referenced by meshes:
 	struct DataFile {
@@ -132,7 +157,7 @@ struct S72 {
 		std::string path; //path to data file, taking into account path to s72 file (relative to current working directory)
 	};
 	//we organize the data files by "src" so that multiple attributes with the same src resolve to the same DataFile:
-	std::unordered_map< std::string, DataFile > data_files;
+	NameMap< DataFile > data_files;
 
 	//zero or more "CAMERA"s, all with unique names:
 	struct Camera {
@@ -149,7 +174,7 @@ struct S72 {
 
 		std::variant< Perspective > projection;
 	};
-	std::unordered_map< std::string, Camera > cameras;
+	NameMap< Camera > cameras;
 
 	//zero or more "DRIVER"s, all with unique names:
 	struct Driver {
@@ -198,7 +223,7 @@ struct S72 {
 
 		std::variant< PBR, Lambertian, Mirror, Environment > brdf;
 	};
-	std::unordered_map< std::string, Material > materials;
+	NameMap< Material > materials;
 
 	//textures referenced by materials:
 	struct Texture {
@@ -217,7 +242,7 @@ struct S72 {
 		std::string path; //path to data file, taking into account path to s72 file (relative to current working directory)
 	};
 	//we organize textures by src + type + format, so that two materials using to the same image *in the same way* end up referring to the same texture object:
-	std::unordered_map< std::string, Texture > textures;
+	NameMap< Texture > textures;
 
 	//zero or more Environments, all with unique names:
 	struct Environment {
@@ -225,7 +250,7 @@ struct S72 {
 
 		Texture *radiance; //NOTE: always of type "cube"; will always be non-null once scene has been loaded
 	};
-	std::unordered_map< std::string, Environment > environments;
+	NameMap< Environment > environments;
 
 	//zero or more "LIGHT"s, all with unique names:
 	struct Light {
@@ -254,5 +279,117 @@ struct S72 {
 		};
 		std::variant< Sun, Sphere, Spot > source;
 	};
-	std::unordered_map< std::string, Light > lights;
+	NameMap< Light > lights;
+};
+
+//-------------------------------------------------
+//S72::Dense is an index-based copy of an S72 scene, built with S72::dense():
+// - objects of each type are stored contiguously, in vectors;
+// - references are 32-bit indices into those vectors (Dense::None if not specified);
+// - nodes are stored in depth-first order from the scene's roots, and a node's children are a contiguous range of 'children'.
+//
+//Names are kept for printing and debugging, but there is no name lookup; that is only needed while loading.
+//Objects that are pointer-free in S72 (cameras, data files, textures, lights) are copied as-is.
+//Placeholders (objects that were referenced but never defined) are copied too, so every index is valid.
+struct S72::Dense {
+	using Index = uint32_t;
+	static constexpr Index None = ~Index(0);
+
+	std::string scene_name;
+	std::vector< Index > roots; //indices into 'nodes'
+
+	struct Node {
+		std::string name;
+
+		vec3 translation = vec3{ .x = 0.0f, .y = 0.0f, .z = 0.0f };
+		quat rotation = quat{ .x = 0.0f, .y = 0.0f, .z = 0.0f, .w = 1.0f };
+		vec3 scale = vec3{ .x = 1.0f, .y = 1.0f, .z = 1.0f };
+
+		//children are children[children_begin, children_begin + children_count):
+		Index children_begin = 0;
+		Index children_count = 0;
+
+		//optional, None if not specified:
+		Index mesh = None;
+		Index camera = None;
+		Index environment = None;
+		Index light = None;
+	};
+	std::vector< Node > nodes;
+	std::vector< Index > children; //indices into 'nodes'; an array (not implied by node order) because a node may have several parents
+
+	struct Mesh {
+		std::string name;
+
+		VkPrimitiveTopology topology;
+		uint32_t count;
+		struct Indices {
+			Index src; //data_files
+			uint32_t offset;
+			VkIndexType format;
+		};
+		std::optional< Indices > indices;
+
+		struct Attribute {
+			std::string name;
+			Index src; //data_files
+			uint32_t offset;
+			uint32_t stride;
+			VkFormat format;
+		};
+		std::vector< Attribute > attributes; //sorted by name
+
+		Index material = None;
+	};
+	std::vector< Mesh > meshes;
+
+	std::vector< DataFile > data_files;
+
+	std::vector< Camera > cameras;
+
+	struct Driver {
+		std::string name;
+
+		Index node;
+		S72::Driver::Channel channel;
+
+		std::vector< float > times;
+		std::vector< float > values;
+
+		S72::Driver::Interpolation interpolation = S72::Driver::Interpolation::LINEAR;
+	};
+	std::vector< Driver > drivers; //in file order (the order they are applied)
+
+	struct Material {
+		std::string name;
+
+		Index normal_map = None; //textures
+		Index displacement_map = None; //textures
+
+		//as in S72::Material, with Index in place of Texture *:
+		struct PBR {
+			std::variant< color, Index > albedo = color{.r = 1.0f, .g = 1.0f, .b = 1.0f};
+			std::variant< float, Index > roughness = 1.0f;
+			std::variant< float, Index > metalness = 0.0f;
+		};
+		struct Lambertian {
+			std::variant< color, Index > albedo = color{.r = 1.0f, .g = 1.0f, .b = 1.0f};
+		};
+		using Mirror = S72::Material::Mirror;
+		using Environment = S72::Material::Environment;
+
+		std::variant< PBR, Lambertian, Mirror, Environment > brdf;
+	};
+	std::vector< Material > materials;
+
+	std::vector< Texture > textures;
+
+	struct Environment {
+		std::string name;
+
+		Index radiance; //textures
+	};
+	std::vector< Environment > environments;
+
+	std::vector< Light > lights;
 };
@@ -0,0 +1,781 @@
+#include "../Tutorial.hpp"
+#include "../mesh_optimize.hpp"
+#include "../vertex_convert.hpp"
+
+#include <vulkan/vk_enum_string_helper.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <future>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Where one vertex attribute is read from, and how it becomes PosNorTexVertex's format for that attribute:
+struct AttributeSource {
+	const uint8_t* data = nullptr;	// first element, in a .b72 mapping (or a MeshCopy's vertices); nullptr if the mesh doesn't have the attribute
+	uint32_t stride = 0;
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	AttributeConverter convert = nullptr;	// (see vertex_convert.hpp)
+	size_t available = 0;	// bytes from data to the end of its file
+};
+
+// Where one mesh's vertices (and indices) are read from:
+struct MeshSource {
+	std::string const *name;
+	Tutorial::SceneMesh *scene_mesh;
+	AttributeSource position, normal, tangent, texcoord;	// (attributes may each come from their own file, in any s72 vertex format)
+	bool canonical;	// the data already is PosNorTexVertex, starting at position.data (copied as a block)
+	uint32_t vertex_count;
+	const uint8_t* index_data = nullptr;	// nullptr if the mesh isn't indexed
+	VkIndexType index_type = VK_INDEX_TYPE_UINT32;
+	uint32_t index_count = 0;
+	bool weld = false;	// build indices by merging identical vertices (see weld_vertices)
+	bool optimize = false;	// reorder triangles and vertices (see optimize_mesh)
+	bool meshlets = false;	// split into meshlets for cluster culling (see build_meshlets)
+	bool lods = false;	// build coarser levels of detail (see build_lods)
+	bool copy = false;	// read into a MeshCopy first (to weld or optimize, or so meshlets and levels of detail can read float positions)
+};
+
+// model-space aabb of some vertices:
+struct Bounds {
+	float min_x = INFINITY, min_y = INFINITY, min_z = INFINITY;
+	float max_x = -INFINITY, max_y = -INFINITY, max_z = -INFINITY;
+};
+
+// Convert vertices [begin, end) of a mesh to PosNorTexVertex (into out[0 .. end - begin)), one attribute at a time:
+void read_vertices(MeshSource const &r, uint32_t begin, uint32_t end, PosNorTexVertex *out)
+{
+	auto read = [&](AttributeSource const &attribute, size_t offset, std::initializer_list<float> fallback) {
+		uint8_t *dst = reinterpret_cast<uint8_t *>(out) + offset;
+		if (attribute.data != nullptr) {
+			attribute.convert(attribute.data + size_t(begin) * attribute.stride, attribute.stride, dst, sizeof(PosNorTexVertex), end - begin);
+		} else {
+			for (uint32_t i = begin; i < end; ++i) {
+				std::memcpy(dst + size_t(i - begin) * sizeof(PosNorTexVertex), fallback.begin(), fallback.size() * sizeof(float));
+			}
+		}
+	};
+	read(r.position, offsetof(PosNorTexVertex, Position), {0.0f, 0.0f, 0.0f});
+	read(r.normal,   offsetof(PosNorTexVertex, Normal),   {0.0f, 0.0f, 1.0f});
+	read(r.tangent,  offsetof(PosNorTexVertex, Tangent),  {1.0f, 0.0f, 0.0f, 1.0f});
+	read(r.texcoord, offsetof(PosNorTexVertex, TexCoord), {0.0f, 0.0f});
+}
+
+// Model-space aabb of count PosNorTexVertex-layout vertices (positions at the start of each 48-byte vertex):
+//  (NaN coordinates are skipped, like std::min/std::max with the running bound first)
+Bounds position_bounds(const uint8_t *vertices, uint32_t count)
+{
+	static_assert(offsetof(PosNorTexVertex, Position) == 0 && sizeof(PosNorTexVertex) >= 16, "loads 16 bytes from the start of each vertex");
+	float lo[4], hi[4];
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	// one unaligned load per vertex gets (x, y, z, Normal.x); the fourth lane is ignored:
+	__m128 vmin = _mm_set1_ps(INFINITY);
+	__m128 vmax = _mm_set1_ps(-INFINITY);
+	for (uint32_t i = 0; i < count; ++i) {
+		__m128 p = _mm_loadu_ps(reinterpret_cast<const float *>(vertices + size_t(i) * sizeof(PosNorTexVertex)));
+		vmin = _mm_min_ps(p, vmin); // (returns the second operand if either is NaN)
+		vmax = _mm_max_ps(p, vmax);
+	}
+	_mm_storeu_ps(lo, vmin);
+	_mm_storeu_ps(hi, vmax);
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+	// (vminq/vmaxq propagate NaN, so select with compares instead)
+	float32x4_t vmin = vdupq_n_f32(INFINITY);
+	float32x4_t vmax = vdupq_n_f32(-INFINITY);
+	for (uint32_t i = 0; i < count; ++i) {
+		float32x4_t p = vld1q_f32(reinterpret_cast<const float *>(vertices + size_t(i) * sizeof(PosNorTexVertex)));
+		vmin = vbslq_f32(vcltq_f32(p, vmin), p, vmin);
+		vmax = vbslq_f32(vcgtq_f32(p, vmax), p, vmax);
+	}
+	vst1q_f32(lo, vmin);
+	vst1q_f32(hi, vmax);
+#else
+	for (uint32_t k = 0; k < 3; ++k) {
+		lo[k] = INFINITY;
+		hi[k] = -INFINITY;
+	}
+	for (uint32_t i = 0; i < count; ++i) {
+		const float *pos = reinterpret_cast<const float *>(vertices + size_t(i) * sizeof(PosNorTexVertex));
+		for (uint32_t k = 0; k < 3; ++k) {
+			lo[k] = std::min(lo[k], pos[k]);
+			hi[k] = std::max(hi[k], pos[k]);
+		}
+	}
+#endif
+	return Bounds{
+		.min_x = lo[0], .min_y = lo[1], .min_z = lo[2],
+		.max_x = hi[0], .max_y = hi[1], .max_z = hi[2],
+	};
+}
+
+// An in-memory copy of an indexed mesh (welded, optimized, or converted), uploaded instead of the file's data:
+struct MeshCopy {
+	std::vector<PosNorTexVertex> vertices;
+	std::vector<uint32_t> indices;
+	VertexCacheStats before, after;	// (if optimized)
+};
+
+// Read an indexed mesh's indices (widened to UINT32):
+std::vector<uint32_t> read_indices(MeshSource const &r)
+{
+	std::vector<uint32_t> indices(r.index_count);
+	for (uint32_t i = 0; i < r.index_count; ++i)
+	{
+		if (r.index_type == VK_INDEX_TYPE_UINT16) {
+			uint16_t index16;
+			std::memcpy(&index16, r.index_data + size_t(i) * 2, 2);
+			indices[i] = index16;
+		} else {
+			std::memcpy(&indices[i], r.index_data + size_t(i) * 4, 4);
+		}
+	}
+	return indices;
+}
+
+// Read a mesh's vertices and (widened) indices:
+MeshCopy copy_mesh(MeshSource const &r)
+{
+	MeshCopy copy;
+	copy.vertices.resize(r.vertex_count);
+	read_vertices(r, 0, r.vertex_count, copy.vertices.data());
+	copy.indices = read_indices(r);
+	return copy;
+}
+
+// Merge bit-identical vertices of a non-indexed mesh (using an open-addressing hash table of vertex indices):
+MeshCopy weld_vertices(MeshSource const &r)
+{
+	MeshCopy welded;
+	welded.indices.reserve(r.vertex_count);
+
+	size_t table_size = 16;
+	while (table_size < 2 * size_t(r.vertex_count)) table_size *= 2;
+	std::vector<uint32_t> table(table_size, UINT32_MAX);
+
+	std::vector<PosNorTexVertex> vertices(r.vertex_count);
+	read_vertices(r, 0, r.vertex_count, vertices.data());
+	for (PosNorTexVertex const &vertex : vertices)
+	{
+
+		// hash the 48 bytes as six 64-bit words:
+		uint64_t words[sizeof(PosNorTexVertex) / 8];
+		static_assert(sizeof(words) == sizeof(PosNorTexVertex), "PosNorTexVertex is a whole number of words");
+		std::memcpy(words, &vertex, sizeof(vertex));
+		uint64_t hash = 0;
+		for (uint64_t w : words) {
+			hash = (hash ^ w) * 0x9e3779b97f4a7c15ull;
+			hash ^= hash >> 29;
+		}
+
+		size_t slot = size_t(hash) & (table_size - 1);
+		while (table[slot] != UINT32_MAX
+			&& std::memcmp(&welded.vertices[table[slot]], &vertex, sizeof(vertex)) != 0)
+		{
+			slot = (slot + 1) & (table_size - 1);
+		}
+		if (table[slot] == UINT32_MAX)
+		{
+			table[slot] = uint32_t(welded.vertices.size());
+			welded.vertices.emplace_back(vertex);
+		}
+		welded.indices.emplace_back(table[slot]);
+	}
+
+	return welded;
+}
+
+// (a typical post-transform cache size; reordering for 16 also does well on larger caches)
+const uint32_t CacheSize = 16;
+
+// Reorder a triangle list's triangles for the post-transform cache and overdraw, then its vertices for fetch (see mesh_optimize.hpp):
+void optimize_mesh(MeshCopy &copy)
+{
+	const uint32_t vertex_count = uint32_t(copy.vertices.size());
+
+	copy.before = simulate_vertex_cache(copy.indices, vertex_count, CacheSize);
+
+	std::vector<uint32_t> cluster_starts;
+	copy.indices = tipsify(copy.indices, vertex_count, CacheSize, &cluster_starts);
+	sort_clusters_for_overdraw(copy.indices, cluster_starts, &copy.vertices[0].Position.x, sizeof(PosNorTexVertex));
+
+	std::vector<uint32_t> remap;
+	uint32_t used = reorder_vertices_for_fetch(copy.indices, vertex_count, &remap);
+	std::vector<PosNorTexVertex> reordered(used);
+	for (uint32_t v = 0; v < vertex_count; ++v)
+	{
+		if (remap[v] != UINT32_MAX) reordered[remap[v]] = copy.vertices[v];
+	}
+	copy.vertices = std::move(reordered);
+
+	copy.after = simulate_vertex_cache(copy.indices, used, CacheSize);
+}
+
+// Coarser levels of detail of an indexed triangle list (each about half the triangles of the one before, see simplify):
+struct LodChain {
+	std::vector<std::vector<uint32_t>> indices;
+	std::vector<float> errors;	// model-space distance each level may be from the full-detail surface
+};
+
+LodChain build_lods(MeshSource const &r)
+{
+	// (stop at small meshes, or when a level can't shed a quarter of its triangles, e.g. when borders and seams lock most vertices)
+	const uint32_t MaxLevels = 6;
+	const size_t MinIndices = 3 * 64;
+
+	LodChain chain;
+	std::vector<uint32_t> current = read_indices(r);
+	const float *positions = reinterpret_cast<const float *>(r.position.data);	// (float, see MeshSource::copy)
+	float error = 0.0f;
+	for (uint32_t level = 0; level < MaxLevels; ++level)
+	{
+		size_t target = current.size() / 6 * 3;
+		if (target < MinIndices) break;
+		float level_error = 0.0f;
+		std::vector<uint32_t> next = simplify(current, r.vertex_count, positions, r.position.stride, target, INFINITY, &level_error);
+		if (next.size() > current.size() / 4 * 3) break;
+
+		// (each level is simplified from the last, so their errors add up)
+		error += level_error;
+		if (r.optimize) next = tipsify(next, r.vertex_count, CacheSize, nullptr);
+		chain.indices.emplace_back(next);
+		chain.errors.emplace_back(error);
+		current = std::move(next);
+	}
+	return chain;
+}
+
+} //namespace
+
+void Tutorial::build_scene_meshes(JobPool &loader)
+{
+	// Vertices are uploaded as PosNorTexVertex, which is the A1 spec's layout (all attributes interleaved at stride 48):
+	//      POSITION  offset  0  R32G32B32_SFLOAT    (12 bytes)
+	//      NORMAL    offset 12  R32G32B32_SFLOAT    (12 bytes)
+	//      TANGENT   offset 24  R32G32B32A32_SFLOAT (16 bytes)
+	//      TEXCOORD  offset 40  R32G32_SFLOAT       ( 8 bytes)
+	// Meshes stored that way are copied as is; others (any s72 vertex formats, strides, and files) are converted attribute by attribute.
+	// Meshes may also have an index stream (UINT16 or UINT32); it is widened to UINT32 for scene_indices.
+
+	if (loaded_data.empty())
+	{
+		std::cout << "[SceneMeshes.cpp]: no binary data loaded when trying to construct scene meshes." << std::endl;
+		start_image_decodes(loader);
+		return;
+	}
+
+	// where each mesh's data comes from (filled in by the checks below; repacked by jobs after):
+	std::vector<MeshSource> sources;
+
+	for (auto& [mesh_name, mesh] : scene_S72.meshes)
+	{
+		SceneMesh scene_mesh;
+		scene_mesh.material = mesh.material;
+
+		if (mesh.attributes.find("POSITION") == mesh.attributes.end()) {
+			std::cerr << "[SceneMeshes.cpp]: Mesh '" << mesh_name << "' missing POSITION attribute, skipping.\n";
+			continue;
+		}
+
+		// find each attribute's data (read straight from its file's mapping) and the converter to PosNorTexVertex's format for it:
+		auto find_attribute = [&](char const *name, VkFormat format, AttributeSource *attribute) -> bool {
+			auto it = mesh.attributes.find(name);
+			if (it == mesh.attributes.end()) return true;	// (missing attributes get defaults, see read_vertices)
+			S72::Mesh::Attribute const &attr = it->second;
+			auto data_it = loaded_data.find(attr.src.src);
+			if (data_it == loaded_data.end()) {
+				std::cerr << "[SceneMeshes.cpp]: Mesh '" << mesh_name << "' references data file '" << attr.src.src << "' which was not loaded, skipping.\n";
+				return false;
+			}
+			attribute->convert = find_attribute_converter(attr.format, format);
+			if (attribute->convert == nullptr) {
+				std::cerr << "[SceneMeshes.cpp]: Mesh '" << mesh_name << "' has " << name << " in unsupported format " << string_VkFormat(attr.format) << ", skipping.\n";
+				return false;
+			}
+			attribute->data = reinterpret_cast<const uint8_t*>(data_it->second.data) + attr.offset;
+			attribute->stride = attr.stride;
+			attribute->format = attr.format;
+			attribute->available = (attr.offset <= data_it->second.size) ? data_it->second.size - attr.offset : 0;
+			return true;
+		};
+
+		MeshSource source{
+			.name = &mesh_name,
+			.scene_mesh = nullptr,
+			.canonical = false,
+			// Non-indexed: mesh.count is the vertex count directly
+			.vertex_count = mesh.count,
+		};
+		if (!find_attribute("POSITION", VK_FORMAT_R32G32B32_SFLOAT, &source.position)
+		 || !find_attribute("NORMAL", VK_FORMAT_R32G32B32_SFLOAT, &source.normal)
+		 || !find_attribute("TANGENT", VK_FORMAT_R32G32B32A32_SFLOAT, &source.tangent)
+		 || !find_attribute("TEXCOORD", VK_FORMAT_R32G32_SFLOAT, &source.texcoord))
+		{
+			continue;
+		}
+
+		if (mesh.indices)
+		{
+			// Indexed: mesh.count is the index count, and the vertices are the ones the indices use
+			auto index_it = loaded_data.find(mesh.indices->src.src);
+			if (index_it == loaded_data.end()) {
+				std::cerr << "[SceneMeshes.cpp]: Mesh '" << mesh_name << "' references index file '" << mesh.indices->src.src << "' which was not loaded, skipping.\n";
+				continue;
+			}
+			if (mesh.indices->format != VK_INDEX_TYPE_UINT16 && mesh.indices->format != VK_INDEX_TYPE_UINT32) {
+				std::cerr << "[SceneMeshes.cpp]: Mesh '" << mesh_name << "' has an unsupported index format, skipping.\n";
+				continue;
+			}
+			const size_t index_size = (mesh.indices->format == VK_INDEX_TYPE_UINT16) ? 2 : 4;
+			if (size_t(mesh.indices->offset) + size_t(mesh.count) * index_size > index_it->second.size) {
+				std::cerr << "[SceneMeshes.cpp]: Mesh '" << mesh_name << "' index data exceeds buffer size, skipping.\n";
+				continue;
+			}
+			source.index_data = reinterpret_cast<const uint8_t*>(index_it->second.data) + mesh.indices->offset;
+			source.index_type = mesh.indices->format;
+			source.index_count = mesh.count;
+
+			// (.b72 data has no alignment guarantees, so indices are read with memcpy)
+			uint32_t max_index = 0;
+			for (uint32_t i = 0; i < source.index_count; ++i) {
+				uint32_t index = 0;
+				if (source.index_type == VK_INDEX_TYPE_UINT16) {
+					uint16_t index16;
+					std::memcpy(&index16, source.index_data + size_t(i) * 2, 2);
+					index = index16;
+				} else {
+					std::memcpy(&index, source.index_data + size_t(i) * 4, 4);
+				}
+				max_index = std::max(max_index, index);
+			}
+			if (max_index == UINT32_MAX) {
+				std::cerr << "[SceneMeshes.cpp]: Mesh '" << mesh_name << "' uses primitive restart indices, which aren't supported, skipping.\n";
+				continue;
+			}
+			source.vertex_count = (source.index_count == 0) ? 0 : max_index + 1;
+		}
+		else if (rtg.configuration.weld_vertices)
+		{
+			source.weld = true;
+		}
+		source.optimize = rtg.configuration.optimize_meshes
+			&& (source.index_data != nullptr || source.weld)
+			&& mesh.topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST && mesh.count % 3 == 0
+			&& source.vertex_count != 0;
+		source.meshlets = rtg.configuration.culling_mode == "clusters"
+			&& (source.index_data != nullptr || source.weld)
+			&& mesh.topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST && mesh.count % 3 == 0
+			&& source.vertex_count != 0;
+		source.lods = rtg.configuration.lod_pixel_error > 0.0f
+			&& (source.index_data != nullptr || source.weld)
+			&& mesh.topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST && mesh.count % 3 == 0
+			&& source.vertex_count != 0;
+
+		// meshlets and levels of detail read float positions straight from the source, so other position formats are copied first:
+		const bool float_positions = source.position.format == VK_FORMAT_R32G32B32_SFLOAT || source.position.format == VK_FORMAT_R32G32B32A32_SFLOAT;
+		source.copy = source.weld || source.optimize || ((source.meshlets || source.lods) && !float_positions);
+
+		// Bounds check
+		auto in_bounds = [&](AttributeSource const &attribute) {
+			return attribute.data == nullptr || source.vertex_count == 0
+			    || size_t(source.vertex_count - 1) * attribute.stride + attribute_format_size(attribute.format) <= attribute.available;
+		};
+		if (!in_bounds(source.position) || !in_bounds(source.normal) || !in_bounds(source.tangent) || !in_bounds(source.texcoord)) {
+			std::cerr << "[SceneMeshes.cpp]: Mesh '" << mesh_name << "' attribute data exceeds buffer size, skipping.\n";
+			continue;
+		}
+
+		// Canonical layout: all four attributes interleaved in one file, in PosNorTexVertex's order and formats
+		auto is = [&](AttributeSource const &attribute, uint32_t offset, VkFormat format) {
+			return attribute.data == source.position.data + offset && attribute.stride == sizeof(PosNorTexVertex) && attribute.format == format;
+		};
+		source.canonical = is(source.position, offsetof(PosNorTexVertex, Position), VK_FORMAT_R32G32B32_SFLOAT)
+			&& is(source.normal, offsetof(PosNorTexVertex, Normal), VK_FORMAT_R32G32B32_SFLOAT)
+			&& is(source.tangent, offsetof(PosNorTexVertex, Tangent), VK_FORMAT_R32G32B32A32_SFLOAT)
+			&& is(source.texcoord, offsetof(PosNorTexVertex, TexCoord), VK_FORMAT_R32G32_SFLOAT);
+
+		source.scene_mesh = &(scene_meshes[mesh_name] = scene_mesh);
+		sources.emplace_back(source);
+	}	// end of the for-loop for scene mesh traversal
+
+	// weld non-indexed meshes (if --weld) and optimize indexed ones (if --optimize-meshes), then read those copies instead:
+	// (also converts meshes whose positions meshlets and levels of detail can't read directly)
+	std::vector<MeshCopy> copies(sources.size());
+	{
+		std::vector<std::pair<size_t, std::future<MeshCopy>>> copy_jobs;
+		for (size_t s = 0; s < sources.size(); ++s)
+		{
+			if (!sources[s].copy) continue;
+			copy_jobs.emplace_back(s, loader.submit([source = sources[s]]() {
+				MeshCopy copy = source.weld ? weld_vertices(source) : copy_mesh(source);
+				if (source.optimize) optimize_mesh(copy);
+				return copy;
+			}));
+		}
+
+		uint32_t welded = 0;
+		uint64_t before = 0, after = 0;
+		for (auto &[s, job] : copy_jobs)
+		{
+			copies[s] = job.get();
+			MeshSource &source = sources[s];
+			if (source.weld)
+			{
+				welded += 1;
+				before += source.vertex_count;
+				after += copies[s].vertices.size();
+			}
+			auto copied = [&](size_t offset, VkFormat format) {
+				return AttributeSource{
+					.data = reinterpret_cast<const uint8_t*>(copies[s].vertices.data()) + offset,
+					.stride = sizeof(PosNorTexVertex),
+					.format = format,
+					.convert = find_attribute_converter(format, format),
+					.available = copies[s].vertices.size() * sizeof(PosNorTexVertex) - offset,
+				};
+			};
+			source.position = copied(offsetof(PosNorTexVertex, Position), VK_FORMAT_R32G32B32_SFLOAT);
+			source.normal = copied(offsetof(PosNorTexVertex, Normal), VK_FORMAT_R32G32B32_SFLOAT);
+			source.tangent = copied(offsetof(PosNorTexVertex, Tangent), VK_FORMAT_R32G32B32A32_SFLOAT);
+			source.texcoord = copied(offsetof(PosNorTexVertex, TexCoord), VK_FORMAT_R32G32_SFLOAT);
+			source.canonical = true;
+			source.vertex_count = uint32_t(copies[s].vertices.size());
+			source.index_data = reinterpret_cast<const uint8_t*>(copies[s].indices.data());
+			source.index_type = VK_INDEX_TYPE_UINT32;
+			source.index_count = uint32_t(copies[s].indices.size());
+		}
+		if (welded != 0)
+		{
+			std::cout << "[SceneMeshes.cpp]: Welded " << welded << " mesh(es): " << before << " -> " << after << " vertices." << std::endl;
+		}
+
+		// report post-transform cache efficiency (ACMR: vertex shader runs per triangle; ATVR: runs per vertex):
+		if (rtg.configuration.optimize_meshes)
+		{
+			for (size_t s = 0; s < sources.size(); ++s)
+			{
+				std::cout << "[SceneMeshes.cpp]: Mesh '" << *sources[s].name << "': ";
+				if (sources[s].optimize)
+				{
+					std::cout << "ACMR " << copies[s].before.acmr << " -> " << copies[s].after.acmr
+					          << ", ATVR " << copies[s].before.atvr << " -> " << copies[s].after.atvr << std::endl;
+				}
+				else if (sources[s].index_data == nullptr)
+				{
+					std::cout << "not indexed (ACMR 3, ATVR 1; use --weld to index it)" << std::endl;
+				}
+				else
+				{
+					std::cout << "not optimized (not a triangle list)" << std::endl;
+				}
+			}
+		}
+	}
+
+	// --lod: simplify meshes into chains of coarser index lists (which draw from the same vertices):
+	std::vector<LodChain> lod_chains(sources.size());
+	{
+		std::vector<std::pair<size_t, std::future<LodChain>>> lod_jobs;
+		for (size_t s = 0; s < sources.size(); ++s)
+		{
+			if (!sources[s].lods) continue;
+			lod_jobs.emplace_back(s, loader.submit([source = sources[s]]() {
+				return build_lods(source);
+			}));
+		}
+		// (the jobs may be reading copies, so wait for all of them before get() can throw)
+		for (auto &[s, job] : lod_jobs) job.wait();
+		for (auto &[s, job] : lod_jobs) lod_chains[s] = job.get();
+	}
+
+	// lay out the meshes in scene_vertices and scene_indices (each mesh's levels of detail follow its own indices):
+	uint32_t total_vertices = 0, total_indices = 0;
+	for (size_t s = 0; s < sources.size(); ++s)
+	{
+		MeshSource &source = sources[s];
+		SceneMesh &scene_mesh = *source.scene_mesh;
+		scene_mesh.vertices.first = total_vertices;
+		scene_mesh.vertices.count = source.vertex_count;
+		scene_mesh.indices.first = total_indices;
+		scene_mesh.indices.count = source.index_count;
+		total_vertices += source.vertex_count;
+		total_indices += source.index_count;
+		for (size_t level = 0; level < lod_chains[s].indices.size(); ++level)
+		{
+			uint32_t count = uint32_t(lod_chains[s].indices[level].size());
+			scene_mesh.lods.emplace_back(MeshLod{
+				.indices{.first = total_indices, .count = count},
+				.error = lod_chains[s].errors[level],
+			});
+			total_indices += count;
+		}
+
+		std::cout << "[SceneMeshes.cpp]: Loaded mesh '" << *source.name << "': " << source.vertex_count << " vertices";
+		if (source.index_data) std::cout << ", " << source.index_count << " indices";
+		std::cout << " (" << (source.index_data ? source.index_count : source.vertex_count) / 3 << " triangles)";
+		if (!scene_mesh.lods.empty())
+		{
+			std::cout << ", levels of detail:";
+			for (MeshLod const &lod : scene_mesh.lods) std::cout << " " << lod.indices.count / 3;
+			std::cout << " triangles";
+		}
+		std::cout << std::endl;
+	}
+
+	// --packed-vertices: each mesh's vertices are quantized against its aabb (known once they are repacked) into PackedVertex:
+	const size_t vertex_size = rtg.configuration.packed_vertices ? sizeof(PackedVertex) : sizeof(PosNorTexVertex);
+	const size_t vertex_bytes = size_t(total_vertices) * vertex_size;
+	const size_t index_bytes = size_t(total_indices) * sizeof(uint32_t);
+
+	if (vertex_bytes != 0)
+	{
+		scene_vertices = rtg.helpers.create_buffer(
+			vertex_bytes,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			Helpers::Unmapped,
+			Helpers::MemoryCategory::SceneVertices
+		);
+	}
+	if (index_bytes != 0)
+	{
+		scene_indices = rtg.helpers.create_buffer(
+			index_bytes,
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			Helpers::Unmapped,
+			Helpers::MemoryCategory::SceneVertices
+		);
+	}
+
+	// repack with jobs of (at most) this many vertices or indices, so large meshes are split between threads:
+	const uint32_t ElementsPerJob = 1 << 16;
+
+	// upload to the GPU in the background, a batch of meshes at a time, so each mesh can draw as soon as its own batch is resident:
+	// (each batch is repacked straight into space from the staging ring, so staging memory stays the size of the ring, not the scene)
+	const size_t BatchBytes = size_t(16) << 20;
+	scene_meshlets.clear();
+	std::vector<PosNorTexVertex> unpacked;	// (--packed-vertices: the batch's vertices, before they are quantized into staging)
+	uint32_t batches = 0, meshlet_meshes = 0;
+	bool decoding = false;
+	for (size_t begin = 0, end = 0; begin < sources.size(); begin = end)
+	{
+		// (meshes are laid out in order, so a run of them is one range of scene_vertices and one of scene_indices)
+		auto vertices_first = [&](size_t s) { return s < sources.size() ? sources[s].scene_mesh->vertices.first : total_vertices; };
+		auto indices_first = [&](size_t s) { return s < sources.size() ? sources[s].scene_mesh->indices.first : total_indices; };
+		size_t batch_bytes = 0;
+		for (end = begin; end < sources.size() && (end == begin || batch_bytes < BatchBytes); ++end)
+		{
+			batch_bytes += (vertices_first(end + 1) - vertices_first(end)) * vertex_size
+			             + (indices_first(end + 1) - indices_first(end)) * sizeof(uint32_t);
+		}
+		if (batch_bytes == 0) continue;	// (nothing to draw, so nothing to wait for)
+
+		// the batch's vertices, then its indices:
+		// (one staging region, so no other upload can submit it before both copies from it are recorded)
+		const size_t batch_vertex_bytes = (vertices_first(end) - vertices_first(begin)) * vertex_size;
+		Helpers::StagingSpace space = rtg.helpers.stage(batch_bytes, 16);
+		uint32_t *batch_indices = reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(space.data) + batch_vertex_bytes);
+		PosNorTexVertex *batch_vertices = reinterpret_cast<PosNorTexVertex *>(space.data);
+		if (rtg.configuration.packed_vertices)
+		{
+			unpacked.resize(vertices_first(end) - vertices_first(begin));
+			batch_vertices = unpacked.data();
+		}
+
+		std::vector<std::pair<SceneMesh *, std::future<Bounds>>> repack_jobs;
+		std::vector<std::future<void>> index_jobs;
+		std::vector<std::pair<SceneMesh *, std::future<std::vector<Meshlet>>>> meshlet_jobs;
+
+		for (size_t s = begin; s < end; ++s)
+		{
+			MeshSource const &r = sources[s];
+			PosNorTexVertex *out = batch_vertices + (r.scene_mesh->vertices.first - vertices_first(begin));
+			for (uint32_t first = 0; first < r.vertex_count; first += ElementsPerJob)
+			{
+				uint32_t last = std::min(r.vertex_count - first, ElementsPerJob) + first;
+				repack_jobs.emplace_back(r.scene_mesh, loader.submit([r, first, last, out]() {
+					if (r.canonical)
+					{
+						// the bytes already are vertices, so this is one copy and a min/max pass:
+						const uint8_t* from = r.position.data + size_t(first) * sizeof(PosNorTexVertex);
+						std::memcpy(out + first, from, size_t(last - first) * sizeof(PosNorTexVertex));
+						return position_bounds(from, last - first);
+					}
+					// convert a cache-sized chunk at a time (so the bounds are read back from it, not from the staging buffer):
+					const uint32_t ChunkVertices = 256;
+					PosNorTexVertex chunk[ChunkVertices];
+					Bounds bounds;
+					for (uint32_t chunk_begin = first; chunk_begin < last; chunk_begin += ChunkVertices)
+					{
+						uint32_t chunk_end = std::min(last - chunk_begin, ChunkVertices) + chunk_begin;
+						read_vertices(r, chunk_begin, chunk_end, chunk);
+						std::memcpy(out + chunk_begin, chunk, size_t(chunk_end - chunk_begin) * sizeof(PosNorTexVertex));
+						Bounds chunk_bounds = position_bounds(reinterpret_cast<const uint8_t*>(chunk), chunk_end - chunk_begin);
+						bounds.min_x = std::min(bounds.min_x, chunk_bounds.min_x);
+						bounds.max_x = std::max(bounds.max_x, chunk_bounds.max_x);
+						bounds.min_y = std::min(bounds.min_y, chunk_bounds.min_y);
+						bounds.max_y = std::max(bounds.max_y, chunk_bounds.max_y);
+						bounds.min_z = std::min(bounds.min_z, chunk_bounds.min_z);
+						bounds.max_z = std::max(bounds.max_z, chunk_bounds.max_z);
+					}
+					return bounds;
+				}));
+			}
+
+			// --culling clusters: meshlets are runs of the final index order (so culling only picks sub-ranges of it):
+			if (r.meshlets)
+			{
+				meshlet_jobs.emplace_back(r.scene_mesh, loader.submit([r]() {
+					// (the meshlet size mesh shader pipelines commonly use)
+					const uint32_t MeshletVertices = 64, MeshletTriangles = 124;
+					return build_meshlets(read_indices(r), r.vertex_count,
+						reinterpret_cast<const float *>(r.position.data), r.position.stride, MeshletVertices, MeshletTriangles);
+				}));
+			}
+
+			// levels of detail are already UINT32:
+			for (size_t level = 0; level < r.scene_mesh->lods.size(); ++level)
+			{
+				std::vector<uint32_t> const &lod_indices = lod_chains[s].indices[level];
+				uint32_t *lod_out = batch_indices + (r.scene_mesh->lods[level].indices.first - indices_first(begin));
+				index_jobs.emplace_back(loader.submit([&lod_indices, lod_out]() {
+					std::memcpy(lod_out, lod_indices.data(), lod_indices.size() * sizeof(uint32_t));
+				}));
+			}
+
+			if (r.index_data == nullptr) continue;
+			uint32_t *index_out = batch_indices + (r.scene_mesh->indices.first - indices_first(begin));
+			for (uint32_t first = 0; first < r.index_count; first += ElementsPerJob)
+			{
+				uint32_t last = std::min(r.index_count - first, ElementsPerJob) + first;
+				index_jobs.emplace_back(loader.submit([r, first, last, index_out]() {
+					if (r.index_type == VK_INDEX_TYPE_UINT32) {
+						std::memcpy(index_out + first, r.index_data + size_t(first) * 4, size_t(last - first) * 4);
+					} else {
+						for (uint32_t i = first; i < last; ++i) {
+							uint16_t index16;
+							std::memcpy(&index16, r.index_data + size_t(i) * 2, 2);
+							index_out[i] = index16;
+						}
+					}
+				}));
+			}
+		}
+
+		// image decodes queue up behind the repacking, so they run while the vertices upload:
+		if (end == sources.size())
+		{
+			start_image_decodes(loader);
+			decoding = true;
+		}
+
+		// (wait for every job before calling get(), which rethrows, since they all write into the batch's memory)
+		for (auto &[scene_mesh, job] : repack_jobs) job.wait();
+		for (auto &job : index_jobs) job.wait();
+		for (auto &[scene_mesh, job] : meshlet_jobs) job.wait();
+
+		// merge each mesh's model-space aabb:
+		for (auto &[scene_mesh, job] : repack_jobs)
+		{
+			Bounds bounds = job.get();
+			scene_mesh->min_x = std::min(scene_mesh->min_x, bounds.min_x);
+			scene_mesh->max_x = std::max(scene_mesh->max_x, bounds.max_x);
+			scene_mesh->min_y = std::min(scene_mesh->min_y, bounds.min_y);
+			scene_mesh->max_y = std::max(scene_mesh->max_y, bounds.max_y);
+			scene_mesh->min_z = std::min(scene_mesh->min_z, bounds.min_z);
+			scene_mesh->max_z = std::max(scene_mesh->max_z, bounds.max_z);
+		}
+		for (auto &job : index_jobs) job.get();
+
+		// gather the meshlets (their index ranges move from mesh-relative to scene_indices-relative):
+		for (auto &[scene_mesh, job] : meshlet_jobs)
+		{
+			std::vector<Meshlet> meshlets = job.get();
+			meshlet_meshes += 1;
+			scene_mesh->first_meshlet = uint32_t(scene_meshlets.size());
+			scene_mesh->meshlet_count = uint32_t(meshlets.size());
+			for (Meshlet &meshlet : meshlets)
+			{
+				meshlet.first_index += scene_mesh->indices.first;
+				scene_meshlets.emplace_back(meshlet);
+			}
+		}
+
+		// --packed-vertices: quantize each mesh's vertices against its (now known) aabb into the staging space:
+		if (rtg.configuration.packed_vertices)
+		{
+			std::vector<std::future<void>> pack_jobs;
+			for (size_t s = begin; s < end; ++s)
+			{
+				MeshSource const &r = sources[s];
+				SceneMesh &scene_mesh = *r.scene_mesh;
+				float min[3] = {scene_mesh.min_x, scene_mesh.min_y, scene_mesh.min_z};
+				float max[3] = {scene_mesh.max_x, scene_mesh.max_y, scene_mesh.max_z};
+				scene_mesh.local_from_packed = PackedVertex::local_from_packed(min, max);
+
+				const PosNorTexVertex *in = unpacked.data() + (scene_mesh.vertices.first - vertices_first(begin));
+				PackedVertex *out = reinterpret_cast<PackedVertex *>(space.data) + (scene_mesh.vertices.first - vertices_first(begin));
+				for (uint32_t first = 0; first < r.vertex_count; first += ElementsPerJob)
+				{
+					uint32_t last = std::min(r.vertex_count - first, ElementsPerJob) + first;
+					pack_jobs.emplace_back(loader.submit([in, out, first, last, min, max]() {
+						for (uint32_t i = first; i < last; ++i)
+						{
+							out[i] = PackedVertex::pack(in[i], min, max);
+						}
+					}));
+				}
+			}
+			for (auto &job : pack_jobs) job.wait();
+			for (auto &job : pack_jobs) job.get();
+		}
+
+		if (batch_vertex_bytes != 0)
+		{
+			rtg.helpers.transfer_to_buffer_async(space, VkBufferCopy{
+				.srcOffset = 0,
+				.dstOffset = vertices_first(begin) * vertex_size,
+				.size = batch_vertex_bytes,
+			}, scene_vertices);
+		}
+		if (indices_first(end) != indices_first(begin))
+		{
+			rtg.helpers.transfer_to_buffer_async(space, VkBufferCopy{
+				.srcOffset = batch_vertex_bytes,
+				.dstOffset = indices_first(begin) * sizeof(uint32_t),
+				.size = (indices_first(end) - indices_first(begin)) * sizeof(uint32_t),
+			}, scene_indices);
+		}
+		// (each batch is its own submit, so its meshes can draw while later batches are repacked and copied)
+		uint64_t upload = rtg.helpers.flush_uploads();
+		for (size_t s = begin; s < end; ++s)
+		{
+			sources[s].scene_mesh->upload = upload;
+		}
+		batches += 1;
+	}
+	if (!decoding) start_image_decodes(loader);
+
+	if (meshlet_meshes != 0)
+	{
+		std::cout << "[SceneMeshes.cpp]: Split " << meshlet_meshes << " mesh(es) into " << scene_meshlets.size() << " meshlets." << std::endl;
+	}
+	if (batches != 0)
+	{
+		std::cout << "[SceneMeshes.cpp]: Uploading " << total_vertices << " scene vertices ("
+		          << vertex_bytes << " bytes" << (rtg.configuration.packed_vertices ? ", packed" : "") << ") and "
+		          << total_indices << " scene indices (" << index_bytes << " bytes) to GPU in " << batches << " batch(es)." << std::endl;
+	}
+
+	// the staging ring holds copies of everything now, so release the mappings:
+	loaded_data.clear();
+}	// end of build scene meshes
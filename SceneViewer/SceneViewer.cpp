@@ -14,7 +14,12 @@
 void Tutorial::load_scene()
 {
 	try {
-		scene_S72 = S72::load(rtg.configuration.scene_file.data());
+		if (rtg.configuration.scene_cache) {
+			scene_S72 = S72::load_cached(rtg.configuration.scene_file, rtg.configuration.load_threads);
+		} else {
+			scene_S72 = S72::load(rtg.configuration.scene_file, rtg.configuration.load_threads);
+		}
+		scene_dense = scene_S72.dense();
 		if (rtg.configuration.print_scene)
 		{
 			print_info(scene_S72);
@@ -27,25 +32,17 @@ void Tutorial::load_scene()
 
 void Tutorial::load_scene_binaries()
 {
-	std::cout << "\n[Tutorial.cpp]: loading .b72 binary files into memory." << std::endl;
+	std::cout << "\n[Tutorial.cpp]: mapping .b72 binary files into memory." << std::endl;
 	// iterate through all data files referenced by the scene
 	for (auto& [src_name, data_file] : scene_S72.data_files)	// <std::string, DataFile>
 	{
-		// Open file in binary mode, positioned at end
-		std::ifstream file(data_file.path, std::ios::binary | std::ios::ate);
-		
-		// Get file size (we're at end due to ios::ate)
-		size_t size = file.tellg();
-		
-		// Rewind to beginning
-		file.seekg(0, std::ios::beg);
-		
-		// Allocate buffer and read all bytes
-		std::vector<uint8_t> bytes(size);
-		file.read(reinterpret_cast<char*>(bytes.data()), size);
-		
-		// Store in map
-		loaded_data[src_name] = std::move(bytes);
+		// Map the file read-only; the OS pages it in as meshes read it (no copy through iostream buffers)
+		try {
+			loaded_data.emplace(src_name, MappedFile(data_file.path));
+		} catch (std::exception &e) {
+			// meshes that use this file will be skipped
+			std::cerr << "[Tutorial.cpp]: failed to load data file '" << src_name << "': " << e.what() << std::endl;
+		}
 	}
 
 	// === DEBUG: Print loaded binary file info ===
@@ -53,9 +50,9 @@ void Tutorial::load_scene_binaries()
 	std::cout << "Total files loaded: " << loaded_data.size() << std::endl;
 
 	size_t total_bytes = 0;
-	for (auto& [src_name, bytes] : loaded_data) {
-		std::cout << "  " << src_name << ": " << bytes.size() << " bytes" << std::endl;
-		total_bytes += bytes.size();
+	for (auto& [src_name, mapped] : loaded_data) {
+		std::cout << "  " << src_name << ": " << mapped.size << " bytes" << std::endl;
+		total_bytes += mapped.size;
 	}
 
 	std::cout << "Total bytes loaded: " << total_bytes;
@@ -122,7 +119,8 @@ void Tutorial::build_scene_materials()
 					VK_IMAGE_TILING_OPTIMAL,
 					VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,	// will sample and upload
 					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, // should be device local
-					Helpers::Unmapped
+					Helpers::Unmapped,
+					Helpers::MemoryCategory::Textures
 				));
 
 				// save to the table to be looked up
@@ -131,8 +129,8 @@ void Tutorial::build_scene_materials()
 				std::cout << "[SceneViewer.cpp]: current textures size: " << textures.size() << std::endl;
 				std::cout << "[SceneViewer.cpp]: Current mat_to_tex size: " << mat_to_tex.size() << std::endl;
 
-				// transfer data
-				rtg.helpers.transfer_to_image(data.data(), sizeof(data[0]) * data.size(), textures.back());
+				// transfer data (in the background)
+				texture_uploads.emplace_back(rtg.helpers.transfer_to_image_async(data.data(), sizeof(data[0]) * data.size(), textures.back()));
 			}
 			else if (std::holds_alternative<S72::Texture *>(lamb.albedo))
 			{
@@ -158,20 +156,12 @@ void Tutorial::build_scene_materials()
 					continue;
 				}
 
-				int w = 0, h = 0;
-				std::unique_ptr<unsigned char, void (*)(void *)> pixels(
-					stbi_load(tex->path.c_str(), &w, &h, nullptr, 4),
-					[](void *p) { stbi_image_free(p); }
-				);
-				if (!pixels)
+				// (decoded on a loader thread, see start_image_decodes)
+				DecodedImage const &image = decoded_image(tex->path, false);
+				if (!image.error.empty())
 				{
 					std::cerr << "[SceneViewer.cpp]: Failed to load texture \"" << tex->path
-						<< "\": " << stbi_failure_reason() << "\n";
-					continue;
-				}
-				if (w <= 0 || h <= 0)
-				{
-					std::cerr << "[SceneViewer.cpp]: Invalid texture dimensions for \"" << tex->path << "\".\n";
+						<< "\": " << image.error << "\n";
 					continue;
 				}
 
@@ -179,20 +169,21 @@ void Tutorial::build_scene_materials()
 					? VK_FORMAT_R8G8B8A8_SRGB
 					: VK_FORMAT_R8G8B8A8_UNORM;
 
-				size_t byte_size = static_cast<size_t>(w) * static_cast<size_t>(h) * 4u;
+				size_t byte_size = static_cast<size_t>(image.width) * image.height * 4u;
 
 				textures.emplace_back(rtg.helpers.create_image(
-					VkExtent2D{ .width = static_cast<uint32_t>(w), .height = static_cast<uint32_t>(h) },
+					VkExtent2D{ .width = image.width, .height = image.height },
 					vk_format,
 					VK_IMAGE_TILING_OPTIMAL,
 					VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
 					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-					Helpers::Unmapped
+					Helpers::Unmapped,
+					Helpers::MemoryCategory::Textures
 				));
 
 				mat_to_tex[&it.second] = uint32_t(textures.size() - 1);
 
-				rtg.helpers.transfer_to_image(pixels.get(), byte_size, textures.back());
+				texture_uploads.emplace_back(rtg.helpers.transfer_to_image_async(image.rgba.get(), byte_size, textures.back()));
 			}
 			else
 			{
@@ -224,119 +215,178 @@ void Tutorial::build_scene_materials()
 
 }	// end of build scene materials
 
-void Tutorial::traverse_node(S72::Node *node, mat4 parent_transform)
+void Tutorial::build_mesh_draws()
+{
+	mesh_draws.assign(scene_dense.meshes.size(), MeshDraw{});
+	for (uint32_t i = 0; i < scene_dense.meshes.size(); ++i)
+	{
+		// look up the mesh by name (once, here, instead of every frame)
+		auto it = scene_meshes.find(scene_dense.meshes[i].name);
+		if (it == scene_meshes.end()) continue;
+
+		MeshDraw &draw = mesh_draws[i];
+		draw.mesh = &it->second;
+		draw.material_type = MaterialType::Lambertian;
+		if (const auto *mat = it->second.material)
+		{
+			auto itt = mat_to_tex.find(mat);
+			if (itt != mat_to_tex.end() && itt->second != UINT32_MAX)
+			{
+				draw.texture = itt->second;
+			}
+
+			auto nm_it = mat_to_normal_tex.find(mat);
+			if (nm_it != mat_to_normal_tex.end())
+			{
+				draw.normal_map_texture = nm_it->second;
+			}
+
+			if (std::holds_alternative<S72::Material::Mirror>(mat->brdf))
+				draw.material_type = MaterialType::Mirror;
+			else if (std::holds_alternative<S72::Material::Environment>(mat->brdf))
+				draw.material_type = MaterialType::Environment;
+			else if (std::holds_alternative<S72::Material::PBR>(mat->brdf))
+				draw.material_type = MaterialType::PBR;
+		}
+	}
+}	// end of build_mesh_draws
+
+void Tutorial::traverse_node(S72::Dense::Index node_index, mat4 parent_transform)
 {
+	S72::Dense::Node const &node = scene_dense.nodes[node_index];
+
 	//	node's local transform = T * R * S
-	mat4 local_transform = mat4_translation(node->translation.x, node->translation.y, node->translation.z)
-						 * mat4_rotation(node->rotation.x, node->rotation.y, node->rotation.z, node->rotation.w)
-						 * mat4_scale(node->scale.x, node->scale.y, node->scale.z);
+	mat4 local_transform = mat4_translation(node.translation.x, node.translation.y, node.translation.z)
+						 * mat4_rotation(node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w)
+						 * mat4_scale(node.scale.x, node.scale.y, node.scale.z);
 
 	//	Accumulate with parent transform
 	mat4 WORLD_FROM_LOCAL = parent_transform * local_transform;
 
-	//	If this node has a mesh, emit an ObjectInstance:
-	if (node->mesh != nullptr)
+	//	If this node has a mesh (that was built, and has finished uploading), emit an ObjectInstance:
+	if (node.mesh != S72::Dense::None && mesh_draws[node.mesh].mesh != nullptr && mesh_draws[node.mesh].mesh->upload <= uploads_resident)
 	{
-		// look up the mesh by name
-		auto it = scene_meshes.find(node->mesh->name);
-		if (it != scene_meshes.end())	// found a mesh
-		{	
-			uint32_t tex = 0;
-			uint32_t nm_tex = 0;
-			MaterialType mat_type = MaterialType::Lambertian;
-			if (const auto *mat = it->second.material)
-			{
-				auto itt = mat_to_tex.find(mat);
-				if (itt != mat_to_tex.end() && itt->second != UINT32_MAX)
-				{
-					tex = itt->second;
-				}
-
-				auto nm_it = mat_to_normal_tex.find(mat);
-				if (nm_it != mat_to_normal_tex.end())
-				{
-					nm_tex = nm_it->second;
-				}
+		MeshDraw const &draw = mesh_draws[node.mesh];
+
+		mat4 WORLD_FROM_LOCAL_NORMAL = WORLD_FROM_LOCAL;
+
+		auto make_instance = [&]() -> ObjectInstance {
+			// (packed positions are fractions of the mesh's aabb, so their transforms start by scaling back to model space)
+			mat4 WORLD_FROM_VERTEX = rtg.configuration.packed_vertices ? WORLD_FROM_LOCAL * draw.mesh->local_from_packed : WORLD_FROM_LOCAL;
+			return ObjectInstance{
+				.vertices = draw.mesh->vertices,
+				.indices = draw.mesh->indices,
+				.transform {
+					.CLIP_FROM_LOCAL = CLIP_FROM_WORLD * WORLD_FROM_VERTEX,
+					.WORLD_FROM_LOCAL = WORLD_FROM_VERTEX,
+					.WORLD_FROM_LOCAL_NORMAL = mat4_inverse_transpose(WORLD_FROM_LOCAL_NORMAL),
+				},
+				// (textures that are still uploading are drawn as the placeholders)
+				.texture = texture_uploads[draw.texture] <= uploads_resident ? draw.texture : placeholder_texture,
+				.normal_map_texture = normal_map_uploads[draw.normal_map_texture] <= uploads_resident ? draw.normal_map_texture : 0,
+				.material_type = draw.material_type,
+			};
+		};
 
-				if (std::holds_alternative<S72::Material::Mirror>(mat->brdf))
-					mat_type = MaterialType::Mirror;
-				else if (std::holds_alternative<S72::Material::Environment>(mat->brdf))
-					mat_type = MaterialType::Environment;
-				else if (std::holds_alternative<S72::Material::PBR>(mat->brdf))
-					mat_type = MaterialType::PBR;
+		// --lod: swap in the coarsest level of detail that looks the same from the culling camera (bounds are computed if null)
+		auto apply_lod = [&](ObjectInstance &instance, WorldBounds const *bounds) -> uint32_t {
+			if (rtg.configuration.lod_pixel_error <= 0.0f) return 0;
+			uint32_t lod = 0;
+			lod_stats.full_triangles += (instance.indices.count != 0 ? instance.indices.count : instance.vertices.count) / 3;
+			if (!draw.mesh->lods.empty())
+			{
+				lod = select_lod(*draw.mesh, bounds ? *bounds : get_world_bounds(*draw.mesh, WORLD_FROM_LOCAL), WORLD_FROM_LOCAL);
+				if (lod != 0) instance.indices = draw.mesh->lods[lod - 1].indices;
 			}
+			lod_stats.lod_triangles += (instance.indices.count != 0 ? instance.indices.count : instance.vertices.count) / 3;
+			return lod;
+		};
 
-			mat4 WORLD_FROM_LOCAL_NORMAL = WORLD_FROM_LOCAL;
-
-			auto make_instance = [&]() -> ObjectInstance {
-				return ObjectInstance{
-					.vertices = it->second.vertices,
-					.transform {
-						.CLIP_FROM_LOCAL = CLIP_FROM_WORLD * WORLD_FROM_LOCAL,
-						.WORLD_FROM_LOCAL = WORLD_FROM_LOCAL,
-						.WORLD_FROM_LOCAL_NORMAL = mat4_inverse_transpose(WORLD_FROM_LOCAL_NORMAL),
-					},
-					.texture = tex,
-					.normal_map_texture = nm_tex,
-					.material_type = mat_type,
-				};
-			};
+		if (culling_mode == CullingMode::None)
+		{
+			ObjectInstance instance = make_instance();
+			apply_lod(instance, nullptr);
+			object_instances.emplace_back(instance);
+		}
+		else if (culling_mode == CullingMode::Frustum)
+		{
+			WorldBounds bounds = get_world_bounds(*draw.mesh, WORLD_FROM_LOCAL);
 
-			if (culling_mode == CullingMode::None)
+			if (is_inside_frustum(bounds))
 			{
-				object_instances.emplace_back(make_instance());
+				ObjectInstance instance = make_instance();
+				apply_lod(instance, &bounds);
+				object_instances.emplace_back(instance);
+				object_bounds.push_back(bounds);
+				assert(object_instances.size() == object_bounds.size() && "Size mismatch between object instances and bounds.");
 			}
-			else if (culling_mode == CullingMode::Frustum)
-			{
-				WorldBounds bounds = get_world_bounds(it->second, WORLD_FROM_LOCAL);
+		}
+		else if (culling_mode == CullingMode::Clusters)
+		{
+			WorldBounds bounds = get_world_bounds(*draw.mesh, WORLD_FROM_LOCAL);
 
-				if (is_inside_frustum(bounds))
+			if (is_inside_frustum(bounds))
+			{
+				ObjectInstance instance = make_instance();
+				uint32_t lod = apply_lod(instance, &bounds);
+				uint32_t triangles = (instance.indices.count != 0 ? instance.indices.count : instance.vertices.count) / 3;
+				cluster_culling_stats.object_triangles += triangles;
+				// (meshlets split the full-detail indices only)
+				if (lod == 0 && draw.mesh->meshlet_count != 0)
 				{
-					object_instances.emplace_back(make_instance());
+					triangles = cull_meshlets(*draw.mesh, WORLD_FROM_LOCAL, instance) / 3;
+				}
+				if (triangles != 0)
+				{
+					cluster_culling_stats.cluster_triangles += triangles;
+					object_instances.emplace_back(instance);
 					object_bounds.push_back(bounds);
 					assert(object_instances.size() == object_bounds.size() && "Size mismatch between object instances and bounds.");
 				}
 			}
-			else
-			{
-				std::cerr << "[Tutorial.cpp]: traversing the scene graph with unknown culling mode, exiting." << std::endl;
-				std::exit(1);
-			}
-		}	// end of mesh found in scene_meshes
+		}
+		else
+		{
+			std::cerr << "[Tutorial.cpp]: traversing the scene graph with unknown culling mode, exiting." << std::endl;
+			std::exit(1);
+		}
 	}
 
-	//	Recurse into children, passing WORLD_FROM_LOCAL as their parent_transform
-	for (auto& child_node : node->children)
+	//	Recurse into children (a contiguous range of scene_dense.children), passing WORLD_FROM_LOCAL as their parent_transform
+	for (uint32_t c = 0; c < node.children_count; ++c)
 	{
-		traverse_node(child_node, WORLD_FROM_LOCAL);
+		traverse_node(scene_dense.children[node.children_begin + c], WORLD_FROM_LOCAL);
 	}
 
 }	// end of traverse_node
 
-void Tutorial::collect_cameras(S72::Node *node, mat4 parent_transform, bool log_new_cameras)
+void Tutorial::collect_cameras(S72::Dense::Index node_index, mat4 parent_transform, bool log_new_cameras)
 {
-	mat4 local_transform = mat4_translation(node->translation.x, node->translation.y, node->translation.z)
-						 * mat4_rotation(node->rotation.x, node->rotation.y, node->rotation.z, node->rotation.w)
-						 * mat4_scale(node->scale.x, node->scale.y, node->scale.z);
+	S72::Dense::Node const &node = scene_dense.nodes[node_index];
+
+	mat4 local_transform = mat4_translation(node.translation.x, node.translation.y, node.translation.z)
+						 * mat4_rotation(node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w)
+						 * mat4_scale(node.scale.x, node.scale.y, node.scale.z);
 
 	mat4 WORLD_FROM_LOCAL = parent_transform * local_transform;
 	
 	//	If this node has a camera, emit a SceneCamera:
-	if (node->camera != nullptr)
+	if (node.camera != S72::Dense::None)
 	{
+		S72::Camera *camera = &scene_dense.cameras[node.camera];
 		scene_cameras.emplace_back(
 			SceneCamera{
-				.camera = node->camera,
+				.camera = camera,
 				.WORLD_FROM_CAMERA = WORLD_FROM_LOCAL,
 			});
 		if (log_new_cameras) {
-			std::cout << "[Tutorial.cpp]: Emplacing camera: {" << node->camera->name << "} into scene_cameras." << std::endl;
+			std::cout << "[Tutorial.cpp]: Emplacing camera: {" << camera->name << "} into scene_cameras." << std::endl;
 		}
 	}
 
-	for (auto &child_node : node->children)
+	for (uint32_t c = 0; c < node.children_count; ++c)
 	{
-		collect_cameras(child_node, WORLD_FROM_LOCAL, log_new_cameras);
+		collect_cameras(scene_dense.children[node.children_begin + c], WORLD_FROM_LOCAL, log_new_cameras);
 	}
 
 }	// end of collect_cameras
@@ -344,7 +394,7 @@ void Tutorial::collect_cameras(S72::Node *node, mat4 parent_transform, bool log_
 void Tutorial::refresh_scene_cameras()
 {
 	scene_cameras.clear();
-	for (S72::Node *root : scene_S72.scene.roots)
+	for (S72::Dense::Index root : scene_dense.roots)
 	{
 		collect_cameras(root, mat4_identity(), false);
 	}
@@ -496,6 +546,99 @@ bool Tutorial::is_inside_frustum(WorldBounds &bounds)
 
 }	// end of is_inside_frustum
 
+uint32_t Tutorial::cull_meshlets(SceneMesh const &mesh, mat4 const &world_from_local, ObjectInstance &instance)
+{
+	// bounding spheres go to world space for the frustum test (the radius grows with the largest axis scale):
+	float scale2 = 0.0f;
+	for (int c = 0; c < 3; ++c) {
+		float const *axis = &world_from_local[4 * c];
+		scale2 = std::max(scale2, axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	}
+	float scale = std::sqrt(scale2);
+	float plane_length[6];
+	for (int i = 0; i < 6; ++i) {
+		plane_length[i] = std::sqrt(frustum_planes[i][0] * frustum_planes[i][0] + frustum_planes[i][1] * frustum_planes[i][1] + frustum_planes[i][2] * frustum_planes[i][2]);
+	}
+
+	// backface cones are tested in model space, since which side of a triangle's plane the eye is on survives any affine transform;
+	// except that a mirroring transform (negative determinant) swaps which side is the front, so those skip the cone test:
+	float const *m = world_from_local.data();
+	float determinant = m[0] * (m[5] * m[10] - m[6] * m[9])
+	                  - m[4] * (m[1] * m[10] - m[2] * m[9])
+	                  + m[8] * (m[1] * m[6] - m[2] * m[5]);
+	bool test_cones = determinant > 0.0f;
+	vec4 eye = mat4_inverse(world_from_local) * vec4{culling_eye[0], culling_eye[1], culling_eye[2], 1.0f};
+
+	instance.first_range = uint32_t(object_index_ranges.size());
+	instance.range_count = 0;
+	uint32_t kept = 0;
+	for (uint32_t i = mesh.first_meshlet; i < mesh.first_meshlet + mesh.meshlet_count; ++i)
+	{
+		Meshlet const &meshlet = scene_meshlets[i];
+
+		vec4 center = world_from_local * vec4{meshlet.center[0], meshlet.center[1], meshlet.center[2], 1.0f};
+		bool visible = true;
+		for (int p = 0; p < 6 && visible; ++p) {
+			float distance = frustum_planes[p][0] * center[0] + frustum_planes[p][1] * center[1] + frustum_planes[p][2] * center[2] + frustum_planes[p][3];
+			visible = distance >= -meshlet.radius * scale * plane_length[p];
+		}
+
+		if (visible && test_cones) {
+			float to_apex[3] = {meshlet.cone_apex[0] - eye[0], meshlet.cone_apex[1] - eye[1], meshlet.cone_apex[2] - eye[2]};
+			float length = std::sqrt(to_apex[0] * to_apex[0] + to_apex[1] * to_apex[1] + to_apex[2] * to_apex[2]);
+			float along = to_apex[0] * meshlet.cone_axis[0] + to_apex[1] * meshlet.cone_axis[1] + to_apex[2] * meshlet.cone_axis[2];
+			visible = !(length > 0.0f && along >= meshlet.cone_cutoff * length);
+		}
+
+		if (!visible) continue;
+		kept += meshlet.index_count;
+
+		// neighboring meshlets are contiguous in the index buffer, so runs of visible ones are one draw:
+		if (instance.range_count != 0 && object_index_ranges.back().first + object_index_ranges.back().count == meshlet.first_index) {
+			object_index_ranges.back().count += meshlet.index_count;
+		} else {
+			object_index_ranges.emplace_back(ObjectIndices{.first = meshlet.first_index, .count = meshlet.index_count});
+			instance.range_count += 1;
+		}
+	}
+	return kept;
+
+}	// end of cull_meshlets
+
+uint32_t Tutorial::select_lod(SceneMesh const &mesh, WorldBounds const &bounds, mat4 const &world_from_local)
+{
+	// the world-space aabb's bounding sphere, and its distance from the culling eye:
+	float center[3] = {
+		0.5f * (bounds.min_x + bounds.max_x),
+		0.5f * (bounds.min_y + bounds.max_y),
+		0.5f * (bounds.min_z + bounds.max_z),
+	};
+	float half[3] = {
+		0.5f * (bounds.max_x - bounds.min_x),
+		0.5f * (bounds.max_y - bounds.min_y),
+		0.5f * (bounds.max_z - bounds.min_z),
+	};
+	float radius = std::sqrt(half[0] * half[0] + half[1] * half[1] + half[2] * half[2]);
+	float to_eye[3] = {center[0] - culling_eye[0], center[1] - culling_eye[1], center[2] - culling_eye[2]};
+	float distance = std::sqrt(to_eye[0] * to_eye[0] + to_eye[1] * to_eye[1] + to_eye[2] * to_eye[2]) - radius;
+	if (!(distance > 0.0f)) return 0;	// (the eye is inside the bounds: full detail)
+
+	// model-space errors grow by (at most) the largest axis scale; the bounds' near side has the most pixels per world unit:
+	float scale2 = 0.0f;
+	for (int c = 0; c < 3; ++c) {
+		float const *axis = &world_from_local[4 * c];
+		scale2 = std::max(scale2, axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	}
+	float pixels_per_unit = std::sqrt(scale2) * culling_pixel_scale / distance;
+
+	uint32_t lod = 0;
+	while (lod < mesh.lods.size() && mesh.lods[lod].error * pixels_per_unit <= rtg.configuration.lod_pixel_error) {
+		++lod;
+	}
+	return lod;
+
+}	// end of select_lod
+
 void Tutorial::draw_bounds(const WorldBounds &bounds)
 {
 	if (bv_mode == BoundingVolumeMode::OBB)
@@ -663,7 +806,7 @@ S72::quat Tutorial::slerp(S72::quat const &a, S72::quat const &b, float t)
     };
 }
 
-std::vector<float> Tutorial::get_lerp_value(const S72::Driver &d, float t)
+std::vector<float> Tutorial::get_lerp_value(const S72::Dense::Driver &d, float t)
 {
     int index = get_lerp_interval(d.times, t);
 
@@ -726,7 +869,7 @@ std::vector<float> Tutorial::get_lerp_value(const S72::Driver &d, float t)
 
 }   // end of get lerp value
 
-void Tutorial::apply_driver(const S72::Driver &d, float t)
+void Tutorial::apply_driver(const S72::Dense::Driver &d, float t)
 {
     std::vector<float> vals = get_lerp_value(d, t);
 	
@@ -735,10 +878,12 @@ void Tutorial::apply_driver(const S72::Driver &d, float t)
         return;
     }
 
+    S72::Dense::Node &node = scene_dense.nodes[d.node];
+
     // Apply to the node based on channel
     if (d.channel == S72::Driver::Channel::translation) {
         if (vals.size() != 3) return;
-        d.node.translation = S72::vec3{
+        node.translation = S72::vec3{
             .x = vals[0],
             .y = vals[1],
             .z = vals[2],
@@ -746,7 +891,7 @@ void Tutorial::apply_driver(const S72::Driver &d, float t)
     }
     else if (d.channel == S72::Driver::Channel::scale) {
         if (vals.size() != 3) return;
-        d.node.scale = S72::vec3{
+        node.scale = S72::vec3{
             .x = vals[0],
             .y = vals[1],
             .z = vals[2],
@@ -754,7 +899,7 @@ void Tutorial::apply_driver(const S72::Driver &d, float t)
     }
     else if (d.channel == S72::Driver::Channel::rotation) {
         if (vals.size() != 4) return;
-        d.node.rotation = S72::quat{
+        node.rotation = S72::quat{
             .x = vals[0],
             .y = vals[1],
             .z = vals[2],
@@ -22,11 +22,11 @@ void Tutorial::LinesPipeline::create(RTG& rtg, VkRenderPass render_pass, uint32_
 	VkShaderModule vert_module = rtg.helpers.create_shader_module(vert_code);
 	VkShaderModule frag_module = rtg.helpers.create_shader_module(frag_code);
 
-	{	// the set0_Camera layout holds a Camera structure in a uniform buffer used in the vertex shader:
+	{	// the set0_Camera layout holds a Camera structure in a (dynamically offset) uniform buffer used in the vertex shader:
 		std::array<VkDescriptorSetLayoutBinding, 1> bindings{
 			VkDescriptorSetLayoutBinding{
 				.binding = 0,
-				.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+				.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
 				.descriptorCount = 1,
 				.stageFlags = VK_SHADER_STAGE_VERTEX_BIT
 			},
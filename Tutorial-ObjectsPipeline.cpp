@@ -22,11 +22,11 @@ void Tutorial::ObjectsPipeline::create(RTG& rtg, VkRenderPass render_pass, uint3
 	VkShaderModule vert_module = rtg.helpers.create_shader_module(vert_code);
 	VkShaderModule frag_module = rtg.helpers.create_shader_module(frag_code);
 	
-	{	// the set0_World layout holds world info in a uniform buffer used in the fragment shader:
+	{	// the set0_World layout holds world info in a (dynamically offset) uniform buffer used in the fragment shader:
 		std::array< VkDescriptorSetLayoutBinding, 1 > bindings{
 			VkDescriptorSetLayoutBinding{
 				.binding = 0,
-				.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+				.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
 				.descriptorCount = 1,
 				.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
 			},
@@ -41,11 +41,11 @@ void Tutorial::ObjectsPipeline::create(RTG& rtg, VkRenderPass render_pass, uint3
 		VK( vkCreateDescriptorSetLayout(rtg.device, &create_info, nullptr, &set0_World) );
 	}
 
-	{	// the set1_Transforms layout holds an array of Transform structures in a storage buffer used in the vertex shader:
+	{	// the set1_Transforms layout holds an array of Transform structures in a (dynamically offset) storage buffer used in the vertex shader:
 		std::array< VkDescriptorSetLayoutBinding, 1> bindings{
 			VkDescriptorSetLayoutBinding{
 				.binding = 0,
-				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
 				.descriptorCount = 1,
 				.stageFlags = VK_SHADER_STAGE_VERTEX_BIT
 			},
@@ -165,12 +165,28 @@ void Tutorial::ObjectsPipeline::create(RTG& rtg, VkRenderPass render_pass, uint3
 	}	// end of create pipeline layout
 
 	{	// create pipeline
+		// --packed-vertices: objects.vert decodes PackedVertex (its PACKED_VERTICES specialization constant):
+		const bool packed_vertices = rtg.configuration.packed_vertices;
+		VkBool32 packed_vertices_constant = packed_vertices ? VK_TRUE : VK_FALSE;
+		VkSpecializationMapEntry packed_vertices_entry{
+			.constantID = 0,
+			.offset = 0,
+			.size = sizeof(VkBool32),
+		};
+		VkSpecializationInfo vert_specialization{
+			.mapEntryCount = 1,
+			.pMapEntries = &packed_vertices_entry,
+			.dataSize = sizeof(packed_vertices_constant),
+			.pData = &packed_vertices_constant,
+		};
+
 		std::array<VkPipelineShaderStageCreateInfo, 2> stages{
 			VkPipelineShaderStageCreateInfo{
 				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
 				.stage = VK_SHADER_STAGE_VERTEX_BIT,
 				.module = vert_module,
 				.pName = "main",
+				.pSpecializationInfo = &vert_specialization,
 		},
 			VkPipelineShaderStageCreateInfo{
 				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
@@ -264,7 +280,7 @@ void Tutorial::ObjectsPipeline::create(RTG& rtg, VkRenderPass render_pass, uint3
 			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
 			.stageCount = uint32_t(stages.size()),
 			.pStages = stages.data(),
-			.pVertexInputState = &Vertex::array_input_state,
+			.pVertexInputState = packed_vertices ? &PackedVertex::array_input_state : &Vertex::array_input_state,
 			.pInputAssemblyState = &input_assembly_state,
 			.pViewportState = &viewport_state,
 			.pRasterizationState = &rasterization_state,
@@ -5,11 +5,13 @@
 
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
 #include <cstring>
 #include <iostream>
+#include <thread>
 
 // Constructor
 Tutorial::Tutorial(RTG &rtg_) : rtg(rtg_) {
@@ -122,11 +124,11 @@ Tutorial::Tutorial(RTG &rtg_) : rtg(rtg_) {
 
 		std::array<VkDescriptorPoolSize, 2> pool_sizes{
 			VkDescriptorPoolSize{
-				.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+				.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
 				.descriptorCount = 2 * per_workspace,	// one descriptor per set, two set per workspace
 			},
 			VkDescriptorPoolSize{
-				.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
 				.descriptorCount = 1 * per_workspace,	// one descriptor per set, one set per workspace
 			},
 		};
@@ -142,6 +144,12 @@ Tutorial::Tutorial(RTG &rtg_) : rtg(rtg_) {
 		VK(vkCreateDescriptorPool(rtg.device, &create_info, nullptr, &descriptor_pool));
 	}
 
+	{	// per-frame data is read at dynamic offsets, so every allocation gets the stricter of the uniform and storage buffer alignments:
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(rtg.physical_device, &properties);
+		frame_alignment = std::max< VkDeviceSize >({ frame_alignment, properties.limits.minUniformBufferOffsetAlignment, properties.limits.minStorageBufferOffsetAlignment });
+	}
+
 	workspaces.resize(rtg.workspaces.size());
 	// std::cout << "workspaces.size(): " << workspaces.size() << std::endl;
 	for (Workspace &workspace : workspaces) {
@@ -158,322 +166,31 @@ Tutorial::Tutorial(RTG &rtg_) : rtg(rtg_) {
 			VK(vkAllocateCommandBuffers(rtg.device, &alloc_info, &workspace.command_buffer));
 		}
 
-		workspace.Camera_src = rtg.helpers.create_buffer(
-			sizeof(LinesPipeline::Camera),
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,	// going to have GPU copy from this memory
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,	// host-visible memory, coherent (no special sync needed)
-			Helpers::Mapped	// get a pointer to the memory
-		);
-
-		workspace.Camera = rtg.helpers.create_buffer(
-			sizeof(LinesPipeline::Camera),
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,	// going to use as a uniform buffer, also going to have GPU copy into this memory
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,	// GPU-local memory
-			Helpers::Unmapped	// don't get a pointer to the memory
-		);
-
-		{	// allocate descriptor set for Camera descriptor:
-			VkDescriptorSetAllocateInfo alloc_info {
-				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-				.descriptorPool = descriptor_pool,
-				.descriptorSetCount = 1,
-				.pSetLayouts = &lines_pipeline.set0_Camera,
+		{	// allocate descriptor sets for Camera, World, and Transforms descriptors:
+			std::array< VkDescriptorSetLayout, 3 > layouts{
+				lines_pipeline.set0_Camera,
+				objects_pipeline.set0_World,
+				objects_pipeline.set1_Transforms,
 			};
-
-			VK(vkAllocateDescriptorSets(rtg.device,	 &alloc_info, &workspace.Camera_descriptors));
-		}
-
-		workspace.World_src = rtg.helpers.create_buffer(
-			sizeof(ObjectsPipeline::World),
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			Helpers::Mapped
-		);
-		workspace.World = rtg.helpers.create_buffer(
-			sizeof(ObjectsPipeline::World),
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			Helpers::Unmapped
-		);
-
-		{ // allocate descriptor set for World descriptor
-			VkDescriptorSetAllocateInfo alloc_info{
-				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-				.descriptorPool = descriptor_pool,
-				.descriptorSetCount = 1,
-				.pSetLayouts = &objects_pipeline.set0_World,
-			};
-
-			VK( vkAllocateDescriptorSets(rtg.device, &alloc_info, &workspace.World_descriptors) );
-			// NOTE: will actually fill in this descriptor set just a bit lower
-		}
-
-		{	// allocate descriptor set for Transforms descriptor
-			VkDescriptorSetAllocateInfo alloc_info{
+			VkDescriptorSetAllocateInfo alloc_info {
 				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
 				.descriptorPool = descriptor_pool,
-				.descriptorSetCount = 1,
-				.pSetLayouts = &objects_pipeline.set1_Transforms,
+				.descriptorSetCount = uint32_t(layouts.size()),
+				.pSetLayouts = layouts.data(),
 			};
 
-			VK(vkAllocateDescriptorSets(rtg.device, &alloc_info, &workspace.Transforms_descriptors));
-
-			// NOTE: will fill in this descriptor set in render when buffers are [re-]allocated
+			std::array< VkDescriptorSet, 3 > descriptor_sets;
+			VK(vkAllocateDescriptorSets(rtg.device, &alloc_info, descriptor_sets.data()));
+			workspace.Camera_descriptors = descriptor_sets[0];
+			workspace.World_descriptors = descriptor_sets[1];
+			workspace.Transforms_descriptors = descriptor_sets[2];
 		}
-		
-		{	// point descriptor to Camera buffer:
-			VkDescriptorBufferInfo Camera_info {
-				.buffer = workspace.Camera.handle,
-				.offset = 0,
-				.range = workspace.Camera.size,
-			};
-
-			VkDescriptorBufferInfo World_info{
-				.buffer = workspace.World.handle,
-				.offset = 0,
-				.range = workspace.World.size,
-			};
 
-			std::array<VkWriteDescriptorSet, 2> writes {
-				VkWriteDescriptorSet {
-					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-					.dstSet = workspace.Camera_descriptors,
-					.dstBinding = 0,
-					.dstArrayElement = 0,
-					.descriptorCount = 1,
-					.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-					.pBufferInfo = &Camera_info,
-				},
-				VkWriteDescriptorSet{
-					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-					.dstSet = workspace.World_descriptors,
-					.dstBinding = 0,
-					.dstArrayElement = 0,
-					.descriptorCount = 1,
-					.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-					.pBufferInfo = &World_info,
-				},
-			};
-
-			vkUpdateDescriptorSets (
-				rtg.device,					// device
-				uint32_t(writes.size()),	// descriptorWriteCount
-				writes.data(),				// pDescriptorWrites
-				0,							// descriptorCopyCount
-				nullptr						// pDescriptorCopies
-			);
-		}
+		// start with room for a few hundred transforms (render grows this as needed), and point the descriptors at it:
+		workspace.Transforms_range = 64 * 1024;
+		reserve_frame_data(workspace, 128 * 1024);
 	}	// end of the for-loop for per-workspace descriptor set allocation
 
-	// A1: scene load and info print if specified
-	if (!rtg.configuration.scene_file.empty())
-	{
-		load_scene();
-	}	// end of scene load and info print
-
-	// A1: load .b72 files into memory if the scene is successfully loaded
-	if (scene_S72.scene.name.empty() && scene_S72.scene.roots.empty())
-	{
-		std::cout << "[Tutorial.cpp]: No valid scene loaded." << std::endl;
-	}
-	else
-	{
-		load_scene_binaries();
-	}	// end of loading .b72 files
-
-	{	// A1: construct scene meshes from loaded binary files and upload to the GPU
-		// Per A1 spec:
-		//  - No indices (non-indexed TRIANGLE_LIST only)
-		//  - All attributes interleaved at stride 48:
-		//      POSITION  offset  0  R32G32B32_SFLOAT    (12 bytes)
-		//      NORMAL    offset 12  R32G32B32_SFLOAT    (12 bytes)
-		//      TANGENT   offset 24  R32G32B32A32_SFLOAT (16 bytes)
-		//      TEXCOORD  offset 40  R32G32_SFLOAT       ( 8 bytes)
-
-		if (!loaded_data.empty())
-		{
-			std::vector<PosNorTexVertex> all_vertices;
-
-			for (auto& [mesh_name, mesh] : scene_S72.meshes)
-			{
-				SceneMesh scene_mesh;
-				scene_mesh.material = mesh.material;
-				scene_mesh.vertices.first = uint32_t(all_vertices.size());
-
-			auto pos_it = mesh.attributes.find("POSITION");
-			auto nor_it = mesh.attributes.find("NORMAL");
-			auto tan_it = mesh.attributes.find("TANGENT");
-			auto tex_it = mesh.attributes.find("TEXCOORD");
-
-				if (pos_it == mesh.attributes.end()) {
-					std::cerr << "[Tutorial.cpp]: Mesh '" << mesh_name << "' missing POSITION attribute, skipping.\n";
-					continue;
-				}
-
-				auto& pos_attr = pos_it->second;
-
-				// All attributes should reference the same src file with stride 48 per spec.
-				// We use POSITION's src as the base buffer.
-				auto data_it = loaded_data.find(pos_attr.src.src);
-				if (data_it == loaded_data.end()) {
-					std::cerr << "[Tutorial.cpp]: Mesh '" << mesh_name << "' references data file '" << pos_attr.src.src << "' which was not loaded, skipping.\n";
-					continue;
-				}
-				const uint8_t* base_data = data_it->second.data();
-				const size_t   base_size = data_it->second.size();
-
-				// Expected offsets within each 48-byte vertex stride:
-				const uint32_t stride   = pos_attr.stride;  // should be 48
-				const uint32_t pos_off  = pos_attr.offset;  // should be 0
-			const uint32_t nor_off  = (nor_it != mesh.attributes.end()) ? nor_it->second.offset : 12;
-			const uint32_t tan_off  = (tan_it != mesh.attributes.end()) ? tan_it->second.offset : 24;
-			const uint32_t tex_off  = (tex_it != mesh.attributes.end()) ? tex_it->second.offset : 40;
-			const bool has_tangent  = (tan_it != mesh.attributes.end());
-
-				// Non-indexed: mesh.count is the vertex count directly
-				const uint32_t vertex_count = mesh.count;
-
-				// Bounds check
-				if (pos_off + vertex_count * stride > base_size) {
-					std::cerr << "[Tutorial.cpp]: Mesh '" << mesh_name << "' attribute data exceeds buffer size, skipping.\n";
-					continue;
-				}
-
-			all_vertices.reserve(all_vertices.size() + vertex_count);
-			for (uint32_t i = 0; i < vertex_count; ++i)
-			{
-				const uint8_t* vertex_base = base_data + i * stride;
-
-				const float* pos = reinterpret_cast<const float*>(vertex_base + pos_off);
-				const float* nor = reinterpret_cast<const float*>(vertex_base + nor_off);
-				const float* tex = reinterpret_cast<const float*>(vertex_base + tex_off);
-
-				float tan_x = 1.0f, tan_y = 0.0f, tan_z = 0.0f, tan_w = 1.0f;
-				if (has_tangent) {
-					const float* tan = reinterpret_cast<const float*>(vertex_base + tan_off);
-					tan_x = tan[0]; tan_y = tan[1]; tan_z = tan[2]; tan_w = tan[3];
-				}
-
-				// model-space aabb
-				scene_mesh.min_x = std::min(scene_mesh.min_x, pos[0]);
-				scene_mesh.max_x = std::max(scene_mesh.max_x, pos[0]);
-				scene_mesh.min_y = std::min(scene_mesh.min_y, pos[1]);
-				scene_mesh.max_y = std::max(scene_mesh.max_y, pos[1]);
-				scene_mesh.min_z = std::min(scene_mesh.min_z, pos[2]);
-				scene_mesh.max_z = std::max(scene_mesh.max_z, pos[2]);
-
-				all_vertices.push_back(PosNorTexVertex{
-					.Position{.x = pos[0], .y = pos[1], .z = pos[2]},
-					.Normal  {.x = nor[0], .y = nor[1], .z = nor[2]},
-					.Tangent {.x = tan_x,  .y = tan_y,  .z = tan_z,  .w = tan_w},
-					.TexCoord{.s = tex[0], .t = tex[1]},
-				});
-			}
-
-				scene_mesh.vertices.count = vertex_count;
-				scene_meshes[mesh_name] = scene_mesh;
-
-				std::cout << "[Tutorial.cpp]: Loaded mesh '" << mesh_name << "': " << vertex_count
-				          << " vertices (" << vertex_count / 3 << " triangles)" << std::endl;
-			}	// end of the for-loop for scene mesh traversal
-
-			// upload to the GPU
-			if (!all_vertices.empty())
-			{
-				size_t bytes = all_vertices.size() * sizeof(PosNorTexVertex);
-				scene_vertices = rtg.helpers.create_buffer(
-					bytes,
-					VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-					Helpers::Unmapped
-				);
-				rtg.helpers.transfer_to_buffer(all_vertices.data(), bytes, scene_vertices);
-
-				std::cout << "[Tutorial.cpp]: Uploaded " << all_vertices.size() << " scene vertices ("
-				          << bytes << " bytes) to GPU." << std::endl;
-			}
-		}
-		else
-		{
-			std::cout << "[Tutorial.cpp]: no binary data loaded when trying to construct scene meshes." << std::endl;
-		}
-	}	// end of scene mesh construction
-
-	{	// build materials
-
-		build_scene_materials();
-		build_normal_map_textures();
-
-	}	// end of build materials
-
-	{	// A1: build SecneCamera instances from the scene and set camera (index & mode) if specified
-		
-		// a scene file is specified
-		if (!rtg.configuration.scene_file.empty())
-		{	
-			// looking for scene cameras
-			for (auto &root : scene_S72.scene.roots)
-			{
-				collect_cameras(root, mat4_identity());
-			}
-			std::cout << "[Tutorial.cpp]: Collected " << scene_cameras.size() << " scene cameras." << std::endl;
-
-			// a scene camera is specified
-			if (!rtg.configuration.scene_camera.empty())
-			{
-				for (uint32_t i = 0; i < scene_cameras.size(); ++i) {
-					if (scene_cameras[i].camera->name == rtg.configuration.scene_camera) {
-						scene_camera_index = i;
-						break;
-					}
-				}
-
-				if (scene_camera_index == -1)
-				{
-					std::cerr << "[Tutorial.cpp]: Cannot find a scene camera with the specified name." << std::endl;
-					std::exit(1);
-				}
-				else
-				{
-					camera_mode = CameraMode::Scene;
-				}
-			}
-			else	// a scene camera is not specified
-			{
-				// no scene camera was found
-				if (scene_cameras.size() == 0)
-				{
-					std::cout << "[Tutorial.cpp]: Found no scene camera within the specified scene file." << std::endl;
-				}
-				else	// default to the first scene camera
-				{
-					scene_camera_index = 0;
-				}
-			}
-		}
-	}
-
-	{	// A1: select culling mode if specified
-		if (!rtg.configuration.culling_mode.empty())
-		{
-			if (rtg.configuration.culling_mode == "none")
-			{
-				culling_mode = CullingMode::None;
-			}
-			else if (rtg.configuration.culling_mode == "frustum")
-			{
-				culling_mode = CullingMode::Frustum;
-			}
-			else
-			{
-				std::cerr << "[Tutorial.cpp]: an unknown culling mode is specified, exiting." << std::endl;
-				std::exit(1);
-			}
-		}
-
-		std::cout << "[Tutorial.cpp]: using culling mode: " << int(culling_mode) << std::endl;
-	}	// end of culling mode selection
-
 	{	// create object vertices
 		std::vector<PosNorTexVertex> vertices;
 
@@ -572,19 +289,47 @@ Tutorial::Tutorial(RTG &rtg_) : rtg(rtg_) {
 
 		size_t bytes = vertices.size() * sizeof(vertices[0]);
 
+		// --packed-vertices: the objects pipeline reads PackedVertex, quantized against the aabb of all of these vertices:
+		std::vector<PackedVertex> packed;
+		if (rtg.configuration.packed_vertices)
+		{
+			float min[3] = {INFINITY, INFINITY, INFINITY};
+			float max[3] = {-INFINITY, -INFINITY, -INFINITY};
+			for (PosNorTexVertex const &v : vertices)
+			{
+				float position[3] = {v.Position.x, v.Position.y, v.Position.z};
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					min[k] = std::min(min[k], position[k]);
+					max[k] = std::max(max[k], position[k]);
+				}
+			}
+			packed.reserve(vertices.size());
+			for (PosNorTexVertex const &v : vertices)
+			{
+				packed.emplace_back(PackedVertex::pack(v, min, max));
+			}
+			object_local_from_packed = PackedVertex::local_from_packed(min, max);
+			bytes = packed.size() * sizeof(packed[0]);
+		}
+
 		object_vertices = rtg.helpers.create_buffer(
 			bytes,
 			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			Helpers::Unmapped
+			Helpers::Unmapped,
+			Helpers::MemoryCategory::SceneVertices
 		);
 
-		// copy data to buffer:
-		rtg.helpers.transfer_to_buffer(vertices.data(), bytes, object_vertices);
+		// copy data to buffer (waited for below, with the placeholder textures):
+		rtg.helpers.transfer_to_buffer_async(packed.empty() ? static_cast<void const *>(vertices.data()) : packed.data(), bytes, object_vertices);
 	}
 
 	{ 	// make some textures
-		textures.reserve(2);
+		// (these are small, so they upload before the first frame; the checkerboard stands in for scene textures that haven't yet)
+		// NOTE: they are made before any scene upload is queued, so waiting for them doesn't wait for the scene
+		textures.reserve(textures.size() + 2);
+		placeholder_texture = uint32_t(textures.size());
 
 		{ // texture 0 will be a dark grey / light grey checkerboard with a red square at the origin.
 			// actually make the texture:
@@ -610,11 +355,13 @@ Tutorial::Tutorial(RTG &rtg_) : rtg(rtg_) {
 				VK_IMAGE_TILING_OPTIMAL,
 				VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, //will sample and upload
 				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, //should be device-local
-				Helpers::Unmapped
+				Helpers::Unmapped,
+				Helpers::MemoryCategory::Textures
 			));
 
 			// transfer data
-			rtg.helpers.transfer_to_image(data.data(), sizeof(data[0]) * data.size(), textures.back());
+			rtg.helpers.transfer_to_image_async(data.data(), sizeof(data[0]) * data.size(), textures.back());
+			texture_uploads.emplace_back(0);
 		}
 
 		{ // texture 1 will be a classic 'xor' texture
@@ -640,14 +387,127 @@ Tutorial::Tutorial(RTG &rtg_) : rtg(rtg_) {
 				VK_IMAGE_TILING_OPTIMAL,
 				VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, //will sample and upload
 				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, //should be device-local
-				Helpers::Unmapped
+				Helpers::Unmapped,
+				Helpers::MemoryCategory::Textures
 			));
 
 			//transfer data:
-			rtg.helpers.transfer_to_image(data.data(), sizeof(data[0]) * data.size(), textures.back());
+			rtg.helpers.transfer_to_image_async(data.data(), sizeof(data[0]) * data.size(), textures.back());
+			texture_uploads.emplace_back(0);
 		}
+
+		// (and the flat normal map, which stands in for normal maps that haven't uploaded yet)
+		build_default_normal_map();
+
+		// these all went in one batch; wait for it here, so they count as resident from the first frame on:
+		rtg.helpers.wait_for_upload(rtg.helpers.flush_uploads());
 	}	// end of making some textures
 
+	// A1: scene load and info print if specified
+	if (!rtg.configuration.scene_file.empty())
+	{
+		load_scene();
+	}	// end of scene load and info print
+
+	// A1: load .b72 files into memory if the scene is successfully loaded
+	if (scene_S72.scene.name.empty() && scene_S72.scene.roots.empty())
+	{
+		std::cout << "[Tutorial.cpp]: No valid scene loaded." << std::endl;
+	}
+	else
+	{
+		load_scene_binaries();
+	}	// end of loading .b72 files
+
+	// A1: CPU-side loading (reading files, decoding images, repacking vertices) runs as jobs on these threads,
+	//  while this thread waits for each result as it needs it and does all of the uploads:
+	JobPool loader(rtg.configuration.job_threads != 0 ? rtg.configuration.job_threads : std::thread::hardware_concurrency());
+
+	{	// A1: construct scene meshes from loaded binary files and upload to the GPU
+		// (also starts the image decodes, once the mesh jobs are queued)
+		build_scene_meshes(loader);
+	}	// end of scene mesh construction
+
+	{	// build materials
+
+		build_scene_materials();
+		build_normal_map_textures();
+		build_mesh_draws();
+
+	}	// end of build materials
+
+	{	// A1: build SecneCamera instances from the scene and set camera (index & mode) if specified
+		
+		// a scene file is specified
+		if (!rtg.configuration.scene_file.empty())
+		{	
+			// looking for scene cameras
+			for (S72::Dense::Index root : scene_dense.roots)
+			{
+				collect_cameras(root, mat4_identity());
+			}
+			std::cout << "[Tutorial.cpp]: Collected " << scene_cameras.size() << " scene cameras." << std::endl;
+
+			// a scene camera is specified
+			if (!rtg.configuration.scene_camera.empty())
+			{
+				for (uint32_t i = 0; i < scene_cameras.size(); ++i) {
+					if (scene_cameras[i].camera->name == rtg.configuration.scene_camera) {
+						scene_camera_index = i;
+						break;
+					}
+				}
+
+				if (scene_camera_index == -1)
+				{
+					std::cerr << "[Tutorial.cpp]: Cannot find a scene camera with the specified name." << std::endl;
+					std::exit(1);
+				}
+				else
+				{
+					camera_mode = CameraMode::Scene;
+				}
+			}
+			else	// a scene camera is not specified
+			{
+				// no scene camera was found
+				if (scene_cameras.size() == 0)
+				{
+					std::cout << "[Tutorial.cpp]: Found no scene camera within the specified scene file." << std::endl;
+				}
+				else	// default to the first scene camera
+				{
+					scene_camera_index = 0;
+				}
+			}
+		}
+	}
+
+	{	// A1: select culling mode if specified
+		if (!rtg.configuration.culling_mode.empty())
+		{
+			if (rtg.configuration.culling_mode == "none")
+			{
+				culling_mode = CullingMode::None;
+			}
+			else if (rtg.configuration.culling_mode == "frustum")
+			{
+				culling_mode = CullingMode::Frustum;
+			}
+			else if (rtg.configuration.culling_mode == "clusters")
+			{
+				culling_mode = CullingMode::Clusters;
+			}
+			else
+			{
+				std::cerr << "[Tutorial.cpp]: an unknown culling mode is specified, exiting." << std::endl;
+				std::exit(1);
+			}
+		}
+
+		std::cout << "[Tutorial.cpp]: using culling mode: " << int(culling_mode) << std::endl;
+	}	// end of culling mode selection
+
 	{ 	// make image views for the textures
 		texture_views.reserve(textures.size());
 		for (Helpers::AllocatedImage const &image : textures) {
@@ -729,6 +589,9 @@ Tutorial::Tutorial(RTG &rtg_) : rtg(rtg_) {
 		load_lambertian_cubemap();
 	}
 
+	// every decoded image has been copied for upload, so free the CPU-side copies:
+	image_decodes.clear();
+
 	{ // create the texture descriptor pool
 		uint32_t per_texture = uint32_t(textures.size());
 		uint32_t per_normal_map = uint32_t(normal_map_textures.size());
@@ -922,6 +785,7 @@ Tutorial::~Tutorial() {
 		rtg.helpers.destroy_image(std::move(texture));
 	}
 	textures.clear();
+	texture_uploads.clear();
 
 	// A2-normal: destroy normal map views and images
 	for (VkImageView &view : normal_map_views) {
@@ -934,6 +798,7 @@ Tutorial::~Tutorial() {
 		rtg.helpers.destroy_image(std::move(nm));
 	}
 	normal_map_textures.clear();
+	normal_map_uploads.clear();
 
 	// A2-diffuse: lambertian cubemap cleanup
 	if (lambertian_cubemap_sampler != VK_NULL_HANDLE)
@@ -976,6 +841,10 @@ Tutorial::~Tutorial() {
 	{
 		rtg.helpers.destroy_buffer(std::move(scene_vertices));
 	}
+	if (scene_indices.handle != VK_NULL_HANDLE)
+	{
+		rtg.helpers.destroy_buffer(std::move(scene_indices));
+	}
 
 	if (swapchain_depth_image.handle != VK_NULL_HANDLE) {
 		destroy_framebuffers();
@@ -989,36 +858,12 @@ Tutorial::~Tutorial() {
 			workspace.command_buffer = VK_NULL_HANDLE;
 		}
 
-		// line vertices buffers get cleaned up when the application is finished
-		if (workspace.lines_vertices_src.handle != VK_NULL_HANDLE) {
-			rtg.helpers.destroy_buffer(std::move(workspace.lines_vertices_src));
-		}
-		if (workspace.lines_vertices.handle != VK_NULL_HANDLE) {
-			rtg.helpers.destroy_buffer(std::move(workspace.lines_vertices));
-		}
-
-		// Camera_descriptors freed when pool is destroyed
-		if (workspace.Camera_src.handle != VK_NULL_HANDLE) {
-			rtg.helpers.destroy_buffer(std::move(workspace.Camera_src));
-		}
-		if (workspace.Camera.handle != VK_NULL_HANDLE) {
-			rtg.helpers.destroy_buffer(std::move(workspace.Camera));
-		}
-
-		// World_descriptors freed when pool is destroyed.
-		if (workspace.World_src.handle != VK_NULL_HANDLE) {
-			rtg.helpers.destroy_buffer(std::move(workspace.World_src));
-		}
-		if (workspace.World.handle != VK_NULL_HANDLE) {
-			rtg.helpers.destroy_buffer(std::move(workspace.World));
-		}
-		
-		// Transforms_descriptors freed when pool is destroyed
-		if (workspace.Transforms_src.handle != VK_NULL_HANDLE) {
-			rtg.helpers.destroy_buffer(std::move(workspace.Transforms_src));
+		// (Camera_descriptors, World_descriptors, and Transforms_descriptors are freed when the pool is destroyed)
+		if (workspace.frame_src.handle != VK_NULL_HANDLE) {
+			rtg.helpers.destroy_buffer(std::move(workspace.frame_src));
 		}
-		if (workspace.Transforms.handle != VK_NULL_HANDLE) {
-			rtg.helpers.destroy_buffer(std::move(workspace.Transforms));
+		if (workspace.frame.handle != VK_NULL_HANDLE) {
+			rtg.helpers.destroy_buffer(std::move(workspace.frame));
 		}
 	}
 	workspaces.clear();
@@ -1062,7 +907,8 @@ void Tutorial::on_swapchain(RTG &rtg_, RTG::SwapchainEvent const &swapchain) {
 		VK_IMAGE_TILING_OPTIMAL,
 		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		Helpers::Unmapped
+		Helpers::Unmapped,
+		Helpers::MemoryCategory::Swapchain
 	);
 
 	{	// create an image view of te depth image
@@ -1121,6 +967,86 @@ void Tutorial::destroy_framebuffers() {
 	rtg.helpers.destroy_image(std::move(swapchain_depth_image));
 }
 
+void Tutorial::reserve_frame_data(Workspace &workspace, VkDeviceSize bytes) {
+	if (workspace.frame_src.handle == VK_NULL_HANDLE || workspace.frame_src.size < bytes) {
+		// (the workspace isn't in use while it is being prepared for a render, so its old buffers can go right away)
+		if (workspace.frame_src.handle != VK_NULL_HANDLE) {
+			rtg.helpers.destroy_buffer(std::move(workspace.frame_src));
+		}
+		if (workspace.frame.handle != VK_NULL_HANDLE) {
+			rtg.helpers.destroy_buffer(std::move(workspace.frame));
+		}
+
+		workspace.frame_src = rtg.helpers.create_buffer(	// CPU visible staging buffer
+			bytes,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,	// going to have GPU copy from this memory
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,	// host-visible memory, coherent (no special sync needed)
+			Helpers::Mapped,	// get a pointer to the memory
+			Helpers::MemoryCategory::Workspace
+		);
+		workspace.frame = rtg.helpers.create_buffer(	// GPU-local buffer, read as vertices, uniforms, and storage
+			bytes,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,	// GPU-local memory
+			Helpers::Unmapped,	// don't get a pointer to the memory
+			Helpers::MemoryCategory::Workspace
+		);
+	}
+
+	// the descriptors give base offset 0 and a range; render supplies where in frame the data is as dynamic offsets:
+	VkDescriptorBufferInfo Camera_info {
+		.buffer = workspace.frame.handle,
+		.offset = 0,
+		.range = sizeof(LinesPipeline::Camera),
+	};
+	VkDescriptorBufferInfo World_info {
+		.buffer = workspace.frame.handle,
+		.offset = 0,
+		.range = sizeof(ObjectsPipeline::World),
+	};
+	VkDescriptorBufferInfo Transforms_info {
+		.buffer = workspace.frame.handle,
+		.offset = 0,
+		.range = workspace.Transforms_range,
+	};
+
+	std::array< VkWriteDescriptorSet, 3 > writes {
+		VkWriteDescriptorSet {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = workspace.Camera_descriptors,
+			.dstBinding = 0,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+			.pBufferInfo = &Camera_info,
+		},
+		VkWriteDescriptorSet {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = workspace.World_descriptors,
+			.dstBinding = 0,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+			.pBufferInfo = &World_info,
+		},
+		VkWriteDescriptorSet {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = workspace.Transforms_descriptors,
+			.dstBinding = 0,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+			.pBufferInfo = &Transforms_info,
+		},
+	};
+
+	vkUpdateDescriptorSets(
+		rtg.device,
+		uint32_t(writes.size()), writes.data(),	// descriptorWrites count, data
+		0, nullptr	// descriptorCopies count, data
+	);
+}
+
 void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 	//assert that parameters are valid:
 	assert(&rtg == &rtg_);
@@ -1145,179 +1071,80 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 		VK(vkBeginCommandBuffer(workspace.command_buffer, &begin_info));
 	}
 
-	if (!lines_vertices.empty()) { // upload lines vertices:
-
-		// [re-]allocate lines buffers if needed
-		size_t needed_bytes = lines_vertices.size() * sizeof(lines_vertices[0]);
-		if (workspace.lines_vertices_src.handle == VK_NULL_HANDLE || workspace.lines_vertices_src.size < needed_bytes) {
-			// round to the next multiupole of 4k to avoid re-allocating continuously if vertex count grows slowly:
-			size_t new_bytes = ((needed_bytes + 4096) / 4096) * 4096;
-			
-			// clean up code for the buffers if they are already allocated
-			if (workspace.lines_vertices_src.handle) {
-				rtg.helpers.destroy_buffer(std::move(workspace.lines_vertices_src));
-			}
-
-			if (workspace.lines_vertices.handle) {
-				rtg.helpers.destroy_buffer(std::move(workspace.lines_vertices));
-			}
-
-			// actual allocation
-			workspace.lines_vertices_src = rtg.helpers.create_buffer(	// CPU visible staging buffer
-				new_bytes,
-				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,	// going to have GPU copy from this memory
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,	// host-visible memory, coherent (no special sync needed)
-				Helpers::Mapped	// get a pointer to the memory
-			);
-			workspace.lines_vertices = rtg.helpers.create_buffer(	// GPU-local vertex buffer
-				new_bytes,
-				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,	// going to use as vertex buffer, also going to have GPU into this memory
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,	// GPU-local memory
-				Helpers::Unmapped	// don't get a pointer to the memory
-			);
-
-			std::cout << "Re-allocated lines buffers to " << new_bytes << " bytes." << std::endl;
-
-		}	// end of resize
-
-		assert(workspace.lines_vertices_src.size == workspace.lines_vertices.size);
-		assert(workspace.lines_vertices_src.size >= needed_bytes);
+	// take ownership of anything uploaded on another queue family since the last frame (waited for at the same stages, below):
+	rtg.helpers.acquire_uploads(workspace.command_buffer, uploads_resident, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+	// this frame's data, at offsets in workspace.frame:
+	VkDeviceSize lines_vertices_offset = 0;
+	VkDeviceSize Camera_offset = 0;
+	VkDeviceSize World_offset = 0;
+	VkDeviceSize Transforms_offset = 0;
+
+	{	// make room for this frame's data: [re-]allocate the frame buffers and [re-]point the descriptors if needed
+		VkDeviceSize transforms_bytes = object_instances.size() * sizeof(ObjectsPipeline::Transform);
+		bool rewrite_descriptors = false;
+		if (transforms_bytes > workspace.Transforms_range) {
+			// round to the next multiple of 4k to avoid growing continuously if the instance count grows slowly:
+			workspace.Transforms_range = ((transforms_bytes + 4096) / 4096) * 4096;
+			rewrite_descriptors = true;
+		}
 
-		{	// host-side (CPU) copy from lines_vertices into workspace.lines_vertices_src:
-			assert(workspace.lines_vertices_src.allocation.mapped);
-			std::memcpy(workspace.lines_vertices_src.allocation.data(), lines_vertices.data(), needed_bytes);
-		
-			// device-side copy from workspace.lines_vertices_src -> workspace.lines_vertices:
-			VkBufferCopy copy_region{
-				.srcOffset = 0,
-				.dstOffset = 0,
-				.size = needed_bytes,
-			};
-			vkCmdCopyBuffer(workspace.command_buffer, workspace.lines_vertices_src.handle, workspace.lines_vertices.handle, 1, &copy_region);
+		// (upper bound, counting worst-case alignment padding before each allocation)
+		VkDeviceSize needed_bytes = 4 * frame_alignment
+			+ sizeof(LinesPipeline::Camera)
+			+ sizeof(ObjectsPipeline::World)
+			+ workspace.Transforms_range
+			+ lines_vertices.size() * sizeof(lines_vertices[0]);
+
+		if (needed_bytes > workspace.frame_src.size) {
+			// grow by at least half again, so slowly growing data doesn't re-allocate every frame:
+			VkDeviceSize new_bytes = std::max(needed_bytes, workspace.frame_src.size + workspace.frame_src.size / 2);
+			reserve_frame_data(workspace, ((new_bytes + 4096) / 4096) * 4096);
+			std::cout << "Re-allocated frame data buffers to " << workspace.frame_src.size << " bytes." << std::endl;
+		} else if (rewrite_descriptors) {
+			reserve_frame_data(workspace, workspace.frame_src.size);
 		}
+	}
 
-	}	// end of lines vertices upload
+	{	// bump-allocate and write this frame's data into frame_src:
+		workspace.frame_used = 0;
+		char *frame_data = reinterpret_cast< char * >(workspace.frame_src.allocation.data());
+		assert(workspace.frame_src.allocation.mapped);
 
-	{	// upload camera info:
 		LinesPipeline::Camera camera {
 			.CLIP_FROM_WORLD = CLIP_FROM_WORLD
 		};
-		assert(workspace.Camera_src.size == sizeof(camera));
-
-		// host-side copy into Camera_src:
-		memcpy(workspace.Camera_src.allocation.data(), &camera, sizeof(camera));
+		Camera_offset = workspace.frame_allocate(sizeof(camera), frame_alignment);
+		std::memcpy(frame_data + Camera_offset, &camera, sizeof(camera));
+
+		World_offset = workspace.frame_allocate(sizeof(world), frame_alignment);
+		std::memcpy(frame_data + World_offset, &world, sizeof(world));
+
+		// (the whole range is reserved, even if fewer transforms are used, since the descriptor covers all of it)
+		Transforms_offset = workspace.frame_allocate(workspace.Transforms_range, frame_alignment);
+		ObjectsPipeline::Transform *out = reinterpret_cast< ObjectsPipeline::Transform * >(frame_data + Transforms_offset);	// strict aliasing violation, but it doesn't matter
+		for (ObjectInstance const &inst : object_instances) {
+			*out = inst.transform;
+			++out;
+		}
 
-		// add device-side copy from Camera_src -> Camera:
-		assert(workspace.Camera_src.size == workspace.Camera.size);
-		VkBufferCopy copy_region {
-			.srcOffset = 0,
-			.dstOffset = 0,
-			.size = workspace.Camera_src.size,
-		};
-		vkCmdCopyBuffer(workspace.command_buffer, workspace.Camera_src.handle, workspace.Camera.handle, 1, &copy_region);
+		if (!lines_vertices.empty()) {
+			size_t lines_bytes = lines_vertices.size() * sizeof(lines_vertices[0]);
+			lines_vertices_offset = workspace.frame_allocate(lines_bytes, frame_alignment);
+			std::memcpy(frame_data + lines_vertices_offset, lines_vertices.data(), lines_bytes);
+		}
 	}
 
-	{	// upload world info:
-		assert(workspace.World_src.size == sizeof(world));
-
-		// host-side copy into World_src:
-		memcpy(workspace.World_src.allocation.data(), &world, sizeof(world));
-
-		// add device-side copy from World_src -> World:
-		assert(workspace.World_src.size == workspace.World.size);
+	{	// device-side copy of everything allocated this frame from frame_src -> frame:
 		VkBufferCopy copy_region{
 			.srcOffset = 0,
 			.dstOffset = 0,
-			.size = workspace.World_src.size,
+			.size = workspace.frame_used,
 		};
-		vkCmdCopyBuffer(workspace.command_buffer, workspace.World_src.handle, workspace.World.handle, 1, &copy_region);
+		vkCmdCopyBuffer(workspace.command_buffer, workspace.frame_src.handle, workspace.frame.handle, 1, &copy_region);
 	}
 
-	// resize Object Transforms buffers if needed
-	{
-		if (!object_instances.empty()){ // upload object transforms:
-			// [re-]allocate transforms buffers if needed
-			size_t needed_bytes = object_instances.size() * sizeof(ObjectsPipeline::Transform);
-			if (workspace.Transforms_src.handle == VK_NULL_HANDLE || workspace.Transforms_src.size < needed_bytes) {
-				// round to the next multiupole of 4k to avoid re-allocating continuously if vertex count grows slowly:
-				size_t new_bytes = ((needed_bytes + 4096) / 4096) * 4096;
-				
-				// clean up code for the buffers if they are already allocated
-				if (workspace.Transforms_src.handle) {
-					rtg.helpers.destroy_buffer(std::move(workspace.Transforms_src));
-				}
-
-				if (workspace.Transforms.handle) {
-					rtg.helpers.destroy_buffer(std::move(workspace.Transforms));
-				}
-
-				// actual allocation
-				workspace.Transforms_src = rtg.helpers.create_buffer(	// CPU visible staging buffer
-					new_bytes,
-					VK_BUFFER_USAGE_TRANSFER_SRC_BIT,	// going to have GPU copy from this memory
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,	// host-visible memory, coherent (no special sync needed)
-					Helpers::Mapped	// get a pointer to the memory
-				);
-				workspace.Transforms = rtg.helpers.create_buffer(	// GPU-local vertex buffer
-					new_bytes,
-					VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,	// going to use as vertex buffer, also going to have GPU into this memory
-					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,	// GPU-local memory
-					Helpers::Unmapped	// don't get a pointer to the memory
-				);
-
-				// update the descriptor set:
-				VkDescriptorBufferInfo Transforms_info {
-					.buffer = workspace.Transforms.handle,
-					.offset = 0,
-					.range = workspace.Transforms.size,
-				};
-
-				std::array< VkWriteDescriptorSet, 1> writes {
-					VkWriteDescriptorSet {
-						.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-						.dstSet = workspace.Transforms_descriptors,
-						.dstBinding = 0,
-						.dstArrayElement = 0,
-						.descriptorCount = 1,
-						.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-						.pBufferInfo = &Transforms_info,
-					},
-				};
-
-				vkUpdateDescriptorSets(
-					rtg.device,
-					uint32_t(writes.size()), writes.data(),	// descriptorWrites count, data
-					0, nullptr	// descriptorCopies count, data
-				);
-
-				std::cout << "Re-allocated object transforms buffers to " << new_bytes << " bytes." << std::endl;
-			}
-
-			assert(workspace.Transforms_src.size == workspace.Transforms.size);
-			assert(workspace.Transforms_src.size >= needed_bytes);
-			
-			{	// copy transforms into Transforms_src:
-				assert(workspace.Transforms_src.allocation.mapped);
-				ObjectsPipeline::Transform *out = reinterpret_cast<ObjectsPipeline::Transform *>(workspace.Transforms_src.allocation.data());	// strict aliasing violation, but it doesn't matter
-
-				for (ObjectInstance const &inst : object_instances) {
-					*out = inst.transform;
-					++out;
-				}
-			}	// end of copy transforms
-
-			// device-side copy from Transforms_src -> Transforms:
-			VkBufferCopy copy_region{
-				.srcOffset = 0,
-				.dstOffset = 0,
-				.size = needed_bytes,
-			};
-			vkCmdCopyBuffer(workspace.command_buffer, workspace.Transforms_src.handle, workspace.Transforms.handle, 1, &copy_region);
-		}	// end of if
-
-	}	// end of object transforms buffers resize
-
-	{	// memory barrier to make sure copies complete before rendering happens:
+	{	// memory barrier to make sure the copy completes before rendering happens:
 		VkMemoryBarrier memory_barrier{
 			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
 			.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
@@ -1326,7 +1153,7 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 		
 		vkCmdPipelineBarrier(workspace.command_buffer,
 			VK_PIPELINE_STAGE_TRANSFER_BIT,	// srcStageMask
-			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,	// dstStageMask
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,	// dstStageMask (lines vertices, Camera and Transforms, World)
 			0,	// dependencyFlags
 			1, &memory_barrier,	// memoryBarriers (count, data)
 			0, nullptr,	// bufferMemoryBarriers (count, data)
@@ -1393,13 +1220,13 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 			vkCmdDraw(workspace.command_buffer, 3, 1, 0, 0);
 		}
 
-		if (!lines_vertices.empty() && workspace.lines_vertices.handle != VK_NULL_HANDLE)
+		if (!lines_vertices.empty())
 		{	// draw with the lines pipeline:
 			vkCmdBindPipeline(workspace.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lines_pipeline.handle);
 
-			{	// use workspace.lines_vertices (offset 0) as vertex buffer binding 0:
-				std::array<VkBuffer, 1 > vertex_buffers{workspace.lines_vertices.handle};
-				std::array<VkDeviceSize, 1 > offsets{0};
+			{	// use this frame's lines vertices in workspace.frame as vertex buffer binding 0:
+				std::array<VkBuffer, 1 > vertex_buffers{workspace.frame.handle};
+				std::array<VkDeviceSize, 1 > offsets{lines_vertices_offset};
 				vkCmdBindVertexBuffers(workspace.command_buffer, 0, uint32_t(vertex_buffers.size()), vertex_buffers.data(), offsets.data());
 			}
 			
@@ -1407,13 +1234,16 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 				std::array<VkDescriptorSet, 1> descriptor_sets{
 					workspace.Camera_descriptors,	// 0: Camera
 				};
+				std::array<uint32_t, 1> dynamic_offsets{
+					uint32_t(Camera_offset),
+				};
 				vkCmdBindDescriptorSets(
 					workspace.command_buffer,	// command buffer
 					VK_PIPELINE_BIND_POINT_GRAPHICS,	// pipeline bind point
 					lines_pipeline.layout,	// pipeline layout
 					0,	// first set
 					uint32_t(descriptor_sets.size()), descriptor_sets.data(),	// descriptor sets count, ptr
-					0, nullptr	// dynamic offsets count, ptr
+					uint32_t(dynamic_offsets.size()), dynamic_offsets.data()	// dynamic offsets count, ptr
 				);
 			}
 
@@ -1421,8 +1251,8 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 			vkCmdDraw(workspace.command_buffer, uint32_t(lines_vertices.size()), 1, 0, 0);
 		}
 
-		if (!object_instances.empty())
-		{	// draw with the objects pipeline:
+		if (!object_instances.empty() && cubemap_uploads <= uploads_resident)
+		{	// draw with the objects pipeline: (once the cubemaps every material samples are resident)
 			vkCmdBindPipeline(workspace.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, objects_pipeline.handle);
 
 			{	// A1: bind the appropriate vertex buffer:
@@ -1431,6 +1261,12 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 				std::array<VkBuffer, 1> vertex_buffers{vb};
 				std::array<VkDeviceSize, 1> offsets{0};
 				vkCmdBindVertexBuffers(workspace.command_buffer, 0, uint32_t(vertex_buffers.size()), vertex_buffers.data(), offsets.data());
+
+				// indexed scene meshes (all widened to UINT32) draw from scene_indices:
+				if (scene_indices.handle != VK_NULL_HANDLE)
+				{
+					vkCmdBindIndexBuffer(workspace.command_buffer, scene_indices.handle, 0, VK_INDEX_TYPE_UINT32);
+				}
 			}
 
 			{ // bind World and Transforms descriptor set:
@@ -1438,13 +1274,17 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 					workspace.World_descriptors,	// 0: World
 					workspace.Transforms_descriptors, // 1: Transforms
 				};
+				std::array< uint32_t, 2 > dynamic_offsets{	// (in set order)
+					uint32_t(World_offset),
+					uint32_t(Transforms_offset),
+				};
 				vkCmdBindDescriptorSets(
 					workspace.command_buffer,	// command buffer
 					VK_PIPELINE_BIND_POINT_GRAPHICS,	// pipeline bind point
 					objects_pipeline.layout,	// pipeline layout
 					0,	// first set
 					uint32_t(descriptor_sets.size()), descriptor_sets.data(),	// descriptor sets count, ptr
-					0, nullptr	// dynamic offsets count, ptr
+					uint32_t(dynamic_offsets.size()), dynamic_offsets.data()	// dynamic offsets count, ptr
 				);
 			}
 
@@ -1515,7 +1355,16 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 					0, sizeof(push), &push
 				);
 
-				vkCmdDraw(workspace.command_buffer, inst.vertices.count, 1, inst.vertices.first, index);
+				if (inst.range_count != 0) {
+					for (uint32_t r = inst.first_range; r < inst.first_range + inst.range_count; ++r) {
+						ObjectIndices const &range = object_index_ranges[r];
+						vkCmdDrawIndexed(workspace.command_buffer, range.count, 1, range.first, int32_t(inst.vertices.first), index);
+					}
+				} else if (inst.indices.count != 0) {
+					vkCmdDrawIndexed(workspace.command_buffer, inst.indices.count, 1, inst.indices.first, int32_t(inst.vertices.first), index);
+				} else {
+					vkCmdDraw(workspace.command_buffer, inst.vertices.count, 1, inst.vertices.first, index);
+				}
 			}
 
 			// std::cout << "[Tutorial.cpp]: Number of object instances to draw: " << object_instances.size() << std::endl;
@@ -1529,19 +1378,32 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 
 	{	//submit `workspace.command buffer` for the GPU to run:
 		// refsol::Tutorial_render_submit(rtg, render_params, workspace.command_buffer);
-		std::array<VkSemaphore, 1> wait_semaphores {
-			render_params.image_available
-		};	// signalled when the image is done being presented and is ready to render to
-		std::array<VkPipelineStageFlags, 1> wait_stages {
-			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+		std::array<VkSemaphore, 2> wait_semaphores {
+			render_params.image_available,	// signalled when the image is done being presented and is ready to render to
+			rtg.helpers.upload_timeline,	// reaches uploads_resident once the uploads this frame draws with are done
+		};
+		std::array<VkPipelineStageFlags, 2> wait_stages {
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		};
+		std::array<uint64_t, 2> wait_values {
+			0,	// (ignored: binary semaphore)
+			uploads_resident,
 		};
 		static_assert(wait_semaphores.size() == wait_stages.size(), "every semaphore needs a stage");
+		static_assert(wait_semaphores.size() == wait_values.size(), "every semaphore needs a value");
 
 		std::array<VkSemaphore, 1> signal_semaphores {
 			render_params.image_done
 		};	// should be signalled after the rendering work in this batch is done
+		VkTimelineSemaphoreSubmitInfo timeline_info {
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+			.waitSemaphoreValueCount = uint32_t(wait_values.size()),
+			.pWaitSemaphoreValues = wait_values.data(),
+		};
 		VkSubmitInfo submit_info {
 			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.pNext = &timeline_info,
 			.waitSemaphoreCount = uint32_t(wait_semaphores.size()),
 			.pWaitSemaphores = wait_semaphores.data(),
 			.pWaitDstStageMask = wait_stages.data(),
@@ -1556,9 +1418,28 @@ void Tutorial::render(RTG &rtg_, RTG::RenderParams const &render_params) {
 		VK(vkQueueSubmit(rtg.graphics_queue, 1, &submit_info, render_params.workspace_available));
 	}
 
+	if (!startup_stats.first_frame)
+	{	// time to first frame (which may well be drawing without some meshes and textures):
+		startup_stats.first_frame = true;
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startup_stats.start).count();
+		std::cout << "[Tutorial.cpp]: First frame submitted " << ms << " ms after startup, with "
+		          << uploads_resident << " of " << rtg.helpers.upload_submitted << " upload batches resident." << std::endl;
+	}
+
 }	// end of render
 
 void Tutorial::update(float dt) {
+
+	{	// see which background uploads have finished (this frame draws with those, and its render waits for them):
+		uploads_resident = rtg.helpers.poll_uploads();
+		if (!startup_stats.resident && uploads_resident == rtg.helpers.upload_submitted)
+		{
+			startup_stats.resident = true;
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startup_stats.start).count();
+			std::cout << "[Tutorial.cpp]: All " << rtg.helpers.upload_submitted << " upload batches resident " << ms << " ms after startup." << std::endl;
+			if (rtg.configuration.debug || rtg.configuration.memory_report) rtg.helpers.report_memory(std::cout); //(the scene is all loaded and its staging buffers are freed)
+		}
+	}
 	
 	{	// modify time in every update
 		time = std::fmod(time + dt, 60.0f);
@@ -1569,7 +1450,7 @@ void Tutorial::update(float dt) {
 	{
 		// std::cout << "[Tutorial.cpp]: Number of drivers in the scene: " << scene_S72.drivers.size() << std::endl;
 		// apply drivers
-		for (const S72::Driver &drv : scene_S72.drivers) {
+		for (const S72::Dense::Driver &drv : scene_dense.drivers) {
 			apply_driver(drv, anim_time);
 		}
 		// Scene cameras use frozen WORLD_FROM_CAMERA unless we refresh from the animated node graph.
@@ -1598,6 +1479,10 @@ void Tutorial::update(float dt) {
 
 			// set culling matrix
 			CULLING_CLIP_FROM_WORLD = CLIP_FROM_WORLD;
+			culling_eye[0] = eye_x;
+			culling_eye[1] = eye_y;
+			culling_eye[2] = eye_z;
+			culling_pixel_scale = 0.5f * float(rtg.swapchain_extent.height) / std::tan(0.5f * persp.vfov);
 		} else if (camera_mode == CameraMode::User) {	// USER
 			CLIP_FROM_WORLD = perspective(
 				free_camera.fov,
@@ -1620,6 +1505,10 @@ void Tutorial::update(float dt) {
 
 			// set culling matrix
 			CULLING_CLIP_FROM_WORLD = CLIP_FROM_WORLD;
+			culling_eye[0] = eye_x;
+			culling_eye[1] = eye_y;
+			culling_eye[2] = eye_z;
+			culling_pixel_scale = 0.5f * float(rtg.swapchain_extent.height) / std::tan(0.5f * free_camera.fov);
 		} else if (camera_mode == CameraMode::Debug) {	// DBEUG
 			// clip matrix used for rendering
 			CLIP_FROM_WORLD = perspective(
@@ -2040,15 +1929,48 @@ void Tutorial::update(float dt) {
 	{	// make some objects:
 		object_instances.clear();
 		object_bounds.clear();
+		object_index_ranges.clear();
 
 		// scene loaded: create instances from scene meshes
 		if (scene_vertices.handle != VK_NULL_HANDLE)
 		{	
 			// traverse scene graph to compute proper world transforms and push object instances
-			for (auto& root : scene_S72.scene.roots)
+			for (S72::Dense::Index root : scene_dense.roots)
 			{
 				traverse_node(root, mat4_identity());
 			}
+
+			// levels of detail: report the triangles drawn (averaged over about a second) against drawing everything at full detail
+			if (rtg.configuration.lod_pixel_error > 0.0f)
+			{
+				lod_stats.frames += 1;
+				lod_stats.elapsed += dt;
+				if (lod_stats.elapsed >= 1.0f)
+				{
+					uint64_t frames = lod_stats.frames;
+					uint64_t full = lod_stats.full_triangles / frames;
+					uint64_t lod = lod_stats.lod_triangles / frames;
+					std::cout << "[Tutorial.cpp]: levels of detail drew " << lod << " triangles per frame (full detail: "
+					          << full << ", " << (full != 0 ? 100.0 * double(lod) / double(full) : 100.0) << "%)" << std::endl;
+					lod_stats = {};
+				}
+			}
+
+			// cluster culling: report the triangles drawn (averaged over about a second) against per-object culling alone
+			if (culling_mode == CullingMode::Clusters)
+			{
+				cluster_culling_stats.frames += 1;
+				cluster_culling_stats.elapsed += dt;
+				if (cluster_culling_stats.elapsed >= 1.0f)
+				{
+					uint64_t frames = cluster_culling_stats.frames;
+					uint64_t object = cluster_culling_stats.object_triangles / frames;
+					uint64_t cluster = cluster_culling_stats.cluster_triangles / frames;
+					std::cout << "[Tutorial.cpp]: cluster culling drew " << cluster << " triangles per frame (per-object culling: "
+					          << object << ", " << (object != 0 ? 100.0 * double(cluster) / double(object) : 100.0) << "%)" << std::endl;
+					cluster_culling_stats = {};
+				}
+			}
 		}
 		else	// no scene: use hardcoded plane and torus
 		{
@@ -2063,8 +1985,8 @@ void Tutorial::update(float dt) {
 				object_instances.emplace_back(ObjectInstance{
 					.vertices = plane_vertices,
 					.transform{
-						.CLIP_FROM_LOCAL = CLIP_FROM_WORLD * WORLD_FROM_LOCAL,
-						.WORLD_FROM_LOCAL = WORLD_FROM_LOCAL,
+						.CLIP_FROM_LOCAL = CLIP_FROM_WORLD * WORLD_FROM_LOCAL * object_local_from_packed,
+						.WORLD_FROM_LOCAL = WORLD_FROM_LOCAL * object_local_from_packed,
 						.WORLD_FROM_LOCAL_NORMAL = WORLD_FROM_LOCAL,
 					},
 					.texture = 1,
@@ -2085,8 +2007,8 @@ void Tutorial::update(float dt) {
 				object_instances.emplace_back(ObjectInstance{
 					.vertices = torus_vertices,
 					.transform{
-						.CLIP_FROM_LOCAL = CLIP_FROM_WORLD * WORLD_FROM_LOCAL,
-						.WORLD_FROM_LOCAL = WORLD_FROM_LOCAL,
+						.CLIP_FROM_LOCAL = CLIP_FROM_WORLD * WORLD_FROM_LOCAL * object_local_from_packed,
+						.WORLD_FROM_LOCAL = WORLD_FROM_LOCAL * object_local_from_packed,
 						.WORLD_FROM_LOCAL_NORMAL = WORLD_FROM_LOCAL,
 					},
 				});
@@ -2145,6 +2067,12 @@ void Tutorial::on_input(InputEvent const &evt) {
 		return;
 	}	// end of camera mode switch
 
+	// print device memory use (in any camera mode):
+	if (evt.type == InputEvent::KeyDown && evt.key.key == GLFW_KEY_M) {
+		rtg.helpers.report_memory(std::cout);
+		return;
+	}
+
 	//  A1: scene camera inputs
 	if (camera_mode == CameraMode::Scene)
 	{
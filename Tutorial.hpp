@@ -2,12 +2,20 @@
 
 #include "PosColVertex.hpp"
 #include "PosNorTexVertex.hpp"
+#include "PackedVertex.hpp"
 
 #include "mat4.hpp"
 
 #include "RTG.hpp"
 
 #include "S72.hpp"
+#include "MappedFile.hpp"
+#include "JobPool.hpp"
+#include "mesh_optimize.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <map>
 
 #ifdef near
 #undef near
@@ -43,28 +51,38 @@ struct Tutorial : RTG::Application {
 	//workspaces hold per-render resources:
 	struct Workspace {
 		VkCommandBuffer command_buffer = VK_NULL_HANDLE; //from the command pool above; reset at the start of every render.
-		
-		// location for lines data: (streamed to GPU per-frame)
-		Helpers::AllocatedBuffer lines_vertices_src;	// host coherent; mapped
-		Helpers::AllocatedBuffer lines_vertices;		// device-local
-
-		// location for LinesPipeline::Camera data: (streamed to GPU per-frame)
-		Helpers::AllocatedBuffer Camera_src;	// host coherent; mapped
-		Helpers::AllocatedBuffer Camera;		// device-local
-		VkDescriptorSet Camera_descriptors;		// references Camera
-
-		// location for ObjectsPipeline::World data: (streamed to GPU per-frame)
-		Helpers::AllocatedBuffer World_src;	// host coherent; mapped
-		Helpers::AllocatedBuffer World;	// device-local
-		VkDescriptorSet World_descriptors;	// references World
-		
-		// location for ObjectsPipeline::Transforms data: (streamed to GPU per-frame)
-		Helpers::AllocatedBuffer Transforms_src;	// host coherent; mapped
-		Helpers::AllocatedBuffer Transforms;	// device-local
-		VkDescriptorSet Transforms_descriptors;	// references Transforms
+
+		// all per-frame data (lines vertices, LinesPipeline::Camera, ObjectsPipeline::World and ::Transforms) is bump-allocated
+		// into frame_src every render, then copied to frame in one go: (streamed to GPU per-frame)
+		Helpers::AllocatedBuffer frame_src;	// host coherent; mapped
+		Helpers::AllocatedBuffer frame;		// device-local
+		VkDeviceSize frame_used = 0;		// bytes of frame_src allocated so far this frame
+
+		// bump-allocate size bytes at (a multiple of) alignment; the offset is the same in frame_src and frame:
+		VkDeviceSize frame_allocate(VkDeviceSize size, VkDeviceSize alignment) {
+			VkDeviceSize offset = (frame_used + alignment - 1) / alignment * alignment;
+			assert(offset + size <= frame_src.size);
+			frame_used = offset + size;
+			return offset;
+		}
+
+		// descriptor sets reference frame, and are bound with the dynamic offsets of this frame's data:
+		VkDescriptorSet Camera_descriptors;		// references a LinesPipeline::Camera
+		VkDescriptorSet World_descriptors;		// references an ObjectsPipeline::World
+		VkDescriptorSet Transforms_descriptors;	// references Transforms_range bytes of ObjectsPipeline::Transform
+		VkDeviceSize Transforms_range = 0;		// (every frame reserves this much for transforms, so the descriptor stays in bounds)
 	};
 	std::vector< Workspace > workspaces;
 
+	/** Alignment of per-frame allocations: satisfies both min{Uniform,Storage}BufferOffsetAlignment (so any of them can be a dynamic offset) */
+	VkDeviceSize frame_alignment = 16;
+
+	/**
+	 * Makes sure workspace.frame_src and workspace.frame hold at least bytes (re-allocating them if not),
+	 * then points the workspace's descriptor sets at frame (with ranges for one Camera, one World, and Transforms_range bytes)
+	 */
+	void reserve_frame_data(Workspace &workspace, VkDeviceSize bytes);
+
 	// a struct that manages a 'VkPipelineLayout' which gives the type of the global inputs to the pipeline,
 	// as well as a handle to the pipeline itself
 	struct BackgroundPipeline {
@@ -149,7 +167,7 @@ struct Tutorial : RTG::Application {
 
 		VkPipelineLayout layout = VK_NULL_HANDLE;
 
-		// vertex bindings
+		// vertex bindings (PackedVertex instead, with --packed-vertices)
 		using Vertex = PosNorTexVertex;
 
 		VkPipeline handle = VK_NULL_HANDLE;
@@ -162,10 +180,15 @@ struct Tutorial : RTG::Application {
 	//static scene resources:
 
 	Helpers::AllocatedBuffer object_vertices;	// stores vertex data for all meshes
+	mat4 object_local_from_packed = mat4_identity();	// object_vertices' PackedVertex positions -> model space (with --packed-vertices)
 	struct ObjectVertices {
 		uint32_t first = 0;	// index of the first vertex
 		uint32_t count = 0;	// count of vertices
 	};	
+	struct ObjectIndices {
+		uint32_t first = 0;	// index of the first index
+		uint32_t count = 0;	// count of indices (0 if the object isn't indexed)
+	};
 	ObjectVertices plane_vertices;
 	ObjectVertices torus_vertices;
 
@@ -174,6 +197,7 @@ struct Tutorial : RTG::Application {
 	VkSampler texture_sampler = VK_NULL_HANDLE;	// gives the sampler state (wrapping, interpolation, etc) for reading from the textures
 	VkDescriptorPool texture_descriptor_pool = VK_NULL_HANDLE;	// the pool from which we allocate texture descriptor sets
 	std::vector<VkDescriptorSet> texture_descriptors;	// allocated from texture_descriptor_pool
+	std::vector<uint64_t> texture_uploads;	// parallel to textures: the upload_timeline value at which each one is resident
 
 	//--------------------------------------------------------------------
 	//Resources that change when the swapchain is resized:
@@ -221,12 +245,15 @@ struct Tutorial : RTG::Application {
 
 	struct ObjectInstance {
 		ObjectVertices vertices;
+		ObjectIndices indices;	// (drawn with vkCmdDrawIndexed, relative to vertices.first, if count != 0)
 		ObjectsPipeline::Transform transform;
 		uint32_t texture = 0;	// an index that indicates which texture descriptor to bind when drawing each instance
 		uint32_t normal_map_texture = 0;	// index into normal_map_descriptors (0 = default flat normal)
 		MaterialType material_type = MaterialType::Lambertian;
+		uint32_t first_range = 0, range_count = 0;	// if range_count != 0, draw these object_index_ranges instead of indices
 	};
 	std::vector<ObjectInstance> object_instances;
+	std::vector<ObjectIndices> object_index_ranges;	// the meshlets that survived cluster culling, merged into runs
 
 	//--------------------------------------------------------------------
 	//Rendering function, uses all the resources above to queue work to draw a frame:
@@ -240,8 +267,12 @@ struct Tutorial : RTG::Application {
 	/** Stores the loaded scene file */
 	S72 scene_S72;
 
-	/** Stores loaded .b72 binary files that can be looked up by name: src -> raw bytes */
-	std::unordered_map<std::string, std::vector<uint8_t>> loaded_data;
+	/** Index-based copy of scene_S72 (built in load_scene); drivers animate it and it is traversed every frame */
+	S72::Dense scene_dense;
+
+	/** Read-only memory maps of the scene's .b72 binary files that can be looked up by name: src -> mapping
+	 *  (meshes are built straight from the mappings, which are released once the vertices are uploaded) */
+	std::unordered_map<std::string, MappedFile> loaded_data;
 
 	/**
 	 * Called within the constructor of Tutorial
@@ -251,31 +282,88 @@ struct Tutorial : RTG::Application {
 
 	/**
 	 * Called within the constructor of Tutorial
-	 * Tries to load .b72 files into memory
+	 * Tries to memory-map the scene's .b72 files (into loaded_data)
 	 */
 	void load_scene_binaries();
 
+	/** An image file decoded on a loader thread (handed to the main thread for upload) */
+	struct DecodedImage {
+		uint32_t width = 0, height = 0;
+		std::unique_ptr<unsigned char, void (*)(void *)> rgba{nullptr, nullptr};	// RGBA8 pixels from stbi_load (if !rgbe)
+		std::vector<float> rgba32f;		// RGBA32F pixels (if rgbe)
+		std::string error;				// why the image couldn't be loaded (no pixels if non-empty)
+	};
+
+	/** Reads and decodes an image file; rgbe images are also converted to RGBA32F (runs on any thread) */
+	static DecodedImage decode_image(std::string const &path, bool rgbe);
+
+	/** Image decodes queued by start_image_decodes: (path, rgbe) -> decode */
+	std::map<std::pair<std::string, bool>, std::shared_future<DecodedImage>> image_decodes;
+
+	/**
+	 * Called by build_scene_meshes, once the mesh jobs are queued
+	 * Queues decodes (on jobs) of the textures and cubemaps that are uploaded later, in upload order
+	 */
+	void start_image_decodes(JobPool &jobs);
+
+	/** Waits for the queued decode of an image (or decodes it now, if it wasn't queued) */
+	DecodedImage const &decoded_image(std::string const &path, bool rgbe);
+
 
 	// SHOW
 	
+	/** A simplified version of a scene mesh (drawing a subset of its triangles) */
+	struct MeshLod {
+		ObjectIndices indices;	// first & count into scene_indices
+		float error = 0.0f;		// how far (in model space) this level may be from the full-detail surface
+	};
+
 	/** Struct for storing per-mesh GPU data in a scene
-	 *  - no indices (all TRIANGLE_LIST, non-indexed)
-	 *  - fixed 48-byte interleaved layout: POSITION(12) + NORMAL(12) + TANGENT(16) + TEXCOORD(8)
+	 *  - all TRIANGLE_LIST; indexed if the mesh has indices (or was welded), otherwise drawn directly
+	 *  - 48-byte PosNorTexVertex: POSITION(12) + NORMAL(12) + TANGENT(16) + TEXCOORD(8);
+	 *    or, with --packed-vertices, 20-byte PackedVertex: UNORM POSITION relative to the aabb (decode with local_from_packed),
+	 *    octahedral NORMAL and TANGENT, half-float TEXCOORD
+	 *  - .b72 attributes may use any supported format and stride (even separate files); they are converted to this layout at load time
 	 *  - lambertian-only materials
 	 */
 	struct SceneMesh {
 		ObjectVertices vertices;		// first & count into scene_vertices buffer
+		ObjectIndices indices;			// first & count into scene_indices buffer (count is 0 if not indexed)
 		S72::Material *material;		// pointer to material (always lambertian per spec)
 		float min_x = INFINITY, min_y = INFINITY, min_z = INFINITY;		// model-sapce aabb
 		float max_x = -INFINITY, max_y = -INFINITY, max_z = -INFINITY;	// model-space aabb
+		mat4 local_from_packed = mat4_identity();	// PackedVertex positions -> model space (with --packed-vertices)
+		uint32_t first_meshlet = 0, meshlet_count = 0;	// range of scene_meshlets (with --culling clusters; count is 0 if not split)
+		std::vector<MeshLod> lods;	// coarser levels of detail, in order (with --lod)
+		uint64_t upload = 0;	// the upload_timeline value at which its vertices and indices are resident (traverse_node skips it until then)
 	};
 
+	/** Every scene mesh's meshlets (index ranges relative to scene_indices, bounds in model space) */
+	std::vector<Meshlet> scene_meshlets;
+
 	/** A hash table to look up meshes by name */
 	std::unordered_map<std::string,	SceneMesh> scene_meshes;
 
 	/** A hash table to look up texture descriptor set index by material */
 	std::unordered_map<S72::Material const *, uint32_t> mat_to_tex;
 
+	/** What to draw for one scene mesh, resolved once so that traverse_node does no lookups */
+	struct MeshDraw {
+		SceneMesh const *mesh = nullptr;	// null if the mesh wasn't built (traverse_node skips it)
+		uint32_t texture = 0;
+		uint32_t normal_map_texture = 0;
+		MaterialType material_type{};	// (Lambertian)
+	};
+
+	/** Parallel to scene_dense.meshes */
+	std::vector<MeshDraw> mesh_draws;
+
+	/**
+	 * Called after scene meshes, materials and normal maps are built
+	 * Fills mesh_draws from scene_meshes, mat_to_tex and mat_to_normal_tex
+	 */
+	void build_mesh_draws();
+
 	/**
 	 * Helper function that converts normalized rgb value to hex value
 	 * @param struct wrapping normalized rgb value
@@ -298,12 +386,22 @@ struct Tutorial : RTG::Application {
 	/** A combined vertex buffer for all scene meshes */
 	Helpers::AllocatedBuffer scene_vertices;
 
+	/** A combined UINT32 index buffer for the indexed scene meshes (indices are relative to each mesh's first vertex) */
+	Helpers::AllocatedBuffer scene_indices;
+
+	/**
+	 * Called within the constructor of Tutorial, after load_scene_binaries
+	 * Repacks the scene meshes (on loader's threads) into scene_vertices and scene_indices, fills scene_meshes,
+	 * and calls start_image_decodes once the mesh jobs are queued
+	 */
+	void build_scene_meshes(JobPool &loader);
+
 	/**
 	 * Called every frame in Tutorial::update if a scene is loaded
 	 * Recursively traverses down a scene graph from its root node,
 	 *  pushing `ObjectInstance`s and `SceneCamera`s into `object_instances` and `scene_cameras`
 	 */
-	void traverse_node(S72::Node *node, mat4 parent_transform);
+	void traverse_node(S72::Dense::Index node, mat4 parent_transform);
 
 	/** Defines different camera modes */
 	enum class CameraMode {
@@ -317,7 +415,7 @@ struct Tutorial : RTG::Application {
 
 	/** Struct that defines a scene camera */
 	struct SceneCamera {
-		S72::Camera *camera;
+		S72::Camera *camera;	// points into scene_dense.cameras
 		mat4 WORLD_FROM_CAMERA;
 	};
 
@@ -335,7 +433,7 @@ struct Tutorial : RTG::Application {
 	 * Recursively searches for scene cameras from roots of a scene graph and builds scene camera instances
 	 * @param log_new_cameras if false, skip per-camera console spam (for per-frame refresh after drivers)
 	 */
-	void collect_cameras(S72::Node *node, mat4 parent_transform, bool log_new_cameras = true);
+	void collect_cameras(S72::Dense::Index node, mat4 parent_transform, bool log_new_cameras = true);
 
 	/** Rebuild scene_cameras from the current node TRS (call after apply_driver so WORLD_FROM_CAMERA matches animation). */
 	void refresh_scene_cameras();
@@ -352,7 +450,8 @@ struct Tutorial : RTG::Application {
 	enum class CullingMode {
 		None = 0,
 		Frustum = 1,
-		Count = 2,
+		Clusters = 2,	// Frustum, then each meshlet against the frustum and its backface cone
+		Count = 3,
 	};
 	
 	/** Stores the current culling mode */
@@ -364,6 +463,44 @@ struct Tutorial : RTG::Application {
 	 */
 	void initialize_cull_mode();
 
+	/** Eye position of the culling camera (like CULLING_CLIP_FROM_WORLD, frozen in debug camera mode); used by backface cone culling and LOD selection */
+	float culling_eye[3] = {0.0f, 0.0f, 0.0f};
+
+	/** Pixels per world unit at distance 1 from the culling camera (half the drawing height over tan(vfov / 2)); used by LOD selection */
+	float culling_pixel_scale = 1.0f;
+
+	/** Triangles drawn with levels of detail vs. at full detail, summed over frames until reported */
+	struct {
+		uint64_t full_triangles = 0;
+		uint64_t lod_triangles = 0;
+		uint32_t frames = 0;
+		float elapsed = 0.0f;
+	} lod_stats;
+
+	/** Triangles drawn with cluster culling vs. with per-object culling alone, summed over frames until reported */
+	struct {
+		uint64_t object_triangles = 0;
+		uint64_t cluster_triangles = 0;
+		uint32_t frames = 0;
+		float elapsed = 0.0f;
+	} cluster_culling_stats;
+
+	/**
+	 * Streaming startup: meshes and textures upload in the background (Helpers::transfer_to_buffer_async), so frames draw right away.
+	 * Each upload's resources are used once upload_timeline reaches its value: until then, meshes are skipped and
+	 * textures are swapped for the placeholders (the checkerboard texture and the flat normal map), which are uploaded up front
+	 * (in one batch, before any scene upload is queued, so waiting for them never waits for the scene).
+	 */
+	uint64_t uploads_resident = 0;	// upload_timeline value as of this frame's update() (render waits for it)
+	uint32_t placeholder_texture = 0;	// index into textures of the checkerboard
+
+	/** Time to first frame, and until every upload was resident, reported once each */
+	struct {
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();	// (when Tutorial was constructed)
+		bool first_frame = false;
+		bool resident = false;
+	} startup_stats;
+
 	/** Stores information of 6 frustum planes in the order of left, right, buttom, top, near, far */
 	float frustum_planes[6][4];
 
@@ -422,6 +559,22 @@ struct Tutorial : RTG::Application {
 	 */
 	bool is_inside_frustum(WorldBounds &bounds);
 
+	/**
+	 * Called within traverse_node if culling mode is set to cluster culling (after the mesh passed is_inside_frustum)
+	 * Tests each of the mesh's meshlets against the frustum planes (bounding sphere) and the culling eye (backface cone),
+	 * and appends the visible ones to object_index_ranges as instance's ranges.
+	 * @return The number of indices kept
+	 */
+	uint32_t cull_meshlets(SceneMesh const &mesh, mat4 const &world_from_local, ObjectInstance &instance);
+
+	/**
+	 * Called within traverse_node for meshes with levels of detail (--lod)
+	 * Projects each level's error to the screen at the near side of the mesh's world bounds, and picks the coarsest
+	 * level that stays within rtg.configuration.lod_pixel_error pixels.
+	 * @return 0 for full detail, otherwise 1 + an index into mesh.lods
+	 */
+	uint32_t select_lod(SceneMesh const &mesh, WorldBounds const &bounds, mat4 const &world_from_local);
+
 	/**
 	 * Called every frame in Tutorial::update if has scene vertices, the camera is in debug mode, and is showing debug visuals
 	 * Draws debug visuals given a bounding volume.
@@ -487,7 +640,7 @@ struct Tutorial : RTG::Application {
 	 * @return
 	 * 	Interpolated values of length 3 (Translation / Scale) or 4 (Rotation)
 	 */
-	std::vector<float> get_lerp_value(const S72::Driver &d, float t);
+	std::vector<float> get_lerp_value(const S72::Dense::Driver &d, float t);
 
 	/**
 	 * Called every frame for every driver in update
@@ -497,7 +650,7 @@ struct Tutorial : RTG::Application {
 	 * @param t
 	 * 	The timestamp to apply at
 	 */
-	void apply_driver(const S72::Driver &d, float t);
+	void apply_driver(const S72::Dense::Driver &d, float t);
 
 	/** Stores the time value for sampling animations */
 	float anim_time = 0.0f;
@@ -553,6 +706,9 @@ struct Tutorial : RTG::Application {
 	/** Descriptor set for the lambertian cubemap */
 	VkDescriptorSet lambertian_cubemap_descriptors = VK_NULL_HANDLE;
 
+	/** The upload_timeline value at which both cubemaps are resident (every object samples them, so none draw until then) */
+	uint64_t cubemap_uploads = 0;
+
 	/**
 	 * Called within the constructor of Tutorial
 	 * Loads pre-convolved lambertian irradiance cubemaps for environments in a scene
@@ -563,9 +719,14 @@ struct Tutorial : RTG::Application {
 	// NORMAL
 
 	/**
-	 * Called within the constructor of Tutorial.
-	 * Creates a 1x1 default flat normal map and loads per-material normal maps,
-	 * populating normal_map_textures and mat_to_normal_tex.
+	 * Called within the constructor of Tutorial, with the placeholder textures (before any scene upload is queued).
+	 * Creates the 1x1 default flat normal map as normal_map_textures[0]; the constructor waits for its upload.
+	 */
+	void build_default_normal_map();
+
+	/**
+	 * Called within the constructor of Tutorial, after build_default_normal_map.
+	 * Loads per-material normal maps, populating normal_map_textures and mat_to_normal_tex.
 	 */
 	void build_normal_map_textures();
 
@@ -573,6 +734,7 @@ struct Tutorial : RTG::Application {
 	std::vector<Helpers::AllocatedImage> normal_map_textures;
 	std::vector<VkImageView> normal_map_views;
 	std::vector<VkDescriptorSet> normal_map_descriptors;
+	std::vector<uint64_t> normal_map_uploads;	// parallel to normal_map_textures, like texture_uploads
 
 	/** Maps material pointer -> index into normal_map_textures; UINT32_MAX if no normal map */
 	std::unordered_map<S72::Material const *, uint32_t> mat_to_normal_tex;
@@ -0,0 +1,533 @@
+#include "mesh_optimize.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+std::vector< uint32_t > tipsify(std::vector< uint32_t > const &indices, uint32_t vertex_count, uint32_t cache_size, std::vector< uint32_t > *cluster_starts) {
+	uint32_t triangle_count = uint32_t(indices.size() / 3);
+
+	//vertex -> triangles that use it (as offsets/list, like a CSR matrix):
+	std::vector< uint32_t > live(vertex_count, 0); //triangles not yet emitted, per vertex
+	for (uint32_t v : indices) live[v] += 1;
+	std::vector< uint32_t > adjacency_begin(vertex_count + 1, 0);
+	for (uint32_t v = 0; v < vertex_count; ++v) adjacency_begin[v + 1] = adjacency_begin[v] + live[v];
+	std::vector< uint32_t > adjacency(indices.size());
+	{
+		std::vector< uint32_t > fill(adjacency_begin.begin(), adjacency_begin.end() - 1);
+		for (uint32_t t = 0; t < triangle_count; ++t) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				adjacency[fill[indices[3 * t + c]]++] = t;
+			}
+		}
+	}
+
+	std::vector< uint32_t > cache_time(vertex_count, 0); //when each vertex last entered the cache
+	uint32_t time = cache_size + 1; //(so every vertex starts out of the cache)
+	std::vector< bool > emitted(triangle_count, false);
+	std::vector< uint32_t > dead_end; //recently used vertices, to continue from when fanning runs out
+	uint32_t cursor = 0; //next vertex to try (in input order) when dead_end is also exhausted
+
+	std::vector< uint32_t > out;
+	out.reserve(triangle_count * 3);
+	if (cluster_starts) cluster_starts->clear();
+
+	//clusters shorter than this are continued instead of ended at a dead end (so overdraw sorting moves useful-sized pieces):
+	const uint32_t MinClusterTriangles = 64;
+
+	std::vector< uint32_t > candidates;
+	uint32_t fan = 0;
+	bool jumped = true; //the first triangle starts a cluster
+	while (triangle_count != 0) {
+		//emit all of fan's remaining triangles:
+		candidates.clear();
+		for (uint32_t a = adjacency_begin[fan]; a < adjacency_begin[fan + 1]; ++a) {
+			uint32_t t = adjacency[a];
+			if (emitted[t]) continue;
+			if (jumped && cluster_starts) {
+				uint32_t start = uint32_t(out.size() / 3);
+				if (cluster_starts->empty() || start - cluster_starts->back() >= MinClusterTriangles) {
+					cluster_starts->emplace_back(start);
+				}
+			}
+			jumped = false;
+			for (uint32_t c = 0; c < 3; ++c) {
+				uint32_t v = indices[3 * t + c];
+				out.emplace_back(v);
+				dead_end.emplace_back(v);
+				candidates.emplace_back(v);
+				live[v] -= 1;
+				if (time - cache_time[v] > cache_size) {
+					cache_time[v] = time;
+					time += 1;
+				}
+			}
+			emitted[t] = true;
+		}
+
+		//next fan: the candidate that will still be in the cache after its remaining triangles are emitted, and has been in the longest:
+		int64_t best_priority = -1;
+		uint32_t next = vertex_count;
+		for (uint32_t v : candidates) {
+			if (live[v] == 0) continue;
+			int64_t priority = 0;
+			if (int64_t(time) - cache_time[v] + 2 * int64_t(live[v]) <= int64_t(cache_size)) {
+				priority = int64_t(time) - cache_time[v];
+			}
+			if (priority > best_priority) {
+				best_priority = priority;
+				next = v;
+			}
+		}
+
+		//dead end: back up through recently used vertices, then walk the input order:
+		if (next == vertex_count) {
+			while (!dead_end.empty()) {
+				uint32_t v = dead_end.back();
+				dead_end.pop_back();
+				if (live[v] > 0) {
+					next = v;
+					jumped = true;
+					break;
+				}
+			}
+		}
+		if (next == vertex_count) {
+			while (cursor < vertex_count && live[cursor] == 0) cursor += 1;
+			if (cursor == vertex_count) break; //every triangle was emitted
+			next = cursor;
+			jumped = true;
+		}
+		fan = next;
+	}
+
+	return out;
+}
+
+void sort_clusters_for_overdraw(std::vector< uint32_t > &indices, std::vector< uint32_t > const &cluster_starts, float const *positions, size_t position_stride) {
+	uint32_t triangle_count = uint32_t(indices.size() / 3);
+	if (cluster_starts.size() <= 1) return;
+
+	auto position = [&](uint32_t v) {
+		return reinterpret_cast< float const * >(reinterpret_cast< char const * >(positions) + v * position_stride);
+	};
+
+	//mesh centroid (of the used vertices, weighted by use):
+	double mesh_center[3] = {0.0, 0.0, 0.0};
+	for (uint32_t v : indices) {
+		for (uint32_t k = 0; k < 3; ++k) mesh_center[k] += position(v)[k];
+	}
+	for (uint32_t k = 0; k < 3; ++k) mesh_center[k] /= double(indices.size());
+
+	//per cluster: (area-weighted) centroid and normal; sort by how much the cluster faces outward:
+	struct Cluster {
+		uint32_t begin, end; //triangles
+		double sort_key;
+	};
+	std::vector< Cluster > clusters;
+	clusters.reserve(cluster_starts.size());
+	for (uint32_t c = 0; c < cluster_starts.size(); ++c) {
+		Cluster cluster{
+			.begin = cluster_starts[c],
+			.end = (c + 1 < cluster_starts.size() ? cluster_starts[c + 1] : triangle_count),
+			.sort_key = 0.0,
+		};
+		double center[3] = {0.0, 0.0, 0.0};
+		double normal[3] = {0.0, 0.0, 0.0};
+		double area = 0.0;
+		for (uint32_t t = cluster.begin; t < cluster.end; ++t) {
+			float const *a = position(indices[3 * t + 0]);
+			float const *b = position(indices[3 * t + 1]);
+			float const *c2 = position(indices[3 * t + 2]);
+			double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+			double ac[3] = {c2[0] - a[0], c2[1] - a[1], c2[2] - a[2]};
+			double n[3] = {
+				ab[1] * ac[2] - ab[2] * ac[1],
+				ab[2] * ac[0] - ab[0] * ac[2],
+				ab[0] * ac[1] - ab[1] * ac[0],
+			};
+			double twice_area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for (uint32_t k = 0; k < 3; ++k) {
+				normal[k] += n[k]; //(already area-weighted)
+				center[k] += twice_area * (a[k] + b[k] + c2[k]) / 3.0;
+			}
+			area += twice_area;
+		}
+		if (area > 0.0) {
+			for (uint32_t k = 0; k < 3; ++k) center[k] /= area;
+			double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length > 0.0) {
+				for (uint32_t k = 0; k < 3; ++k) {
+					cluster.sort_key += (center[k] - mesh_center[k]) * normal[k] / length;
+				}
+			}
+		}
+		clusters.emplace_back(cluster);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](Cluster const &a, Cluster const &b) {
+		return a.sort_key > b.sort_key;
+	});
+
+	std::vector< uint32_t > sorted;
+	sorted.reserve(indices.size());
+	for (Cluster const &cluster : clusters) {
+		sorted.insert(sorted.end(), indices.begin() + 3 * cluster.begin, indices.begin() + 3 * cluster.end);
+	}
+	indices = std::move(sorted);
+}
+
+uint32_t reorder_vertices_for_fetch(std::vector< uint32_t > &indices, uint32_t vertex_count, std::vector< uint32_t > *remap) {
+	remap->assign(vertex_count, UINT32_MAX);
+	uint32_t used = 0;
+	for (uint32_t &v : indices) {
+		if ((*remap)[v] == UINT32_MAX) (*remap)[v] = used++;
+		v = (*remap)[v];
+	}
+	return used;
+}
+
+VertexCacheStats simulate_vertex_cache(std::vector< uint32_t > const &indices, uint32_t vertex_count, uint32_t cache_size) {
+	//FIFO cache: a vertex is cached if it was loaded within the last cache_size misses:
+	std::vector< uint64_t > loaded_at(vertex_count, 0); //miss count after the vertex was loaded (0 = never)
+	std::vector< bool > used(vertex_count, false);
+	uint64_t misses = 0;
+	uint32_t used_count = 0;
+	for (uint32_t v : indices) {
+		if (loaded_at[v] == 0 || misses - loaded_at[v] >= cache_size) {
+			misses += 1;
+			loaded_at[v] = misses;
+		}
+		if (!used[v]) {
+			used[v] = true;
+			used_count += 1;
+		}
+	}
+
+	VertexCacheStats stats;
+	if (indices.size() >= 3) stats.acmr = float(double(misses) / double(indices.size() / 3));
+	if (used_count != 0) stats.atvr = float(double(misses) / double(used_count));
+	return stats;
+}
+
+//bounding sphere and backface cone of triangles [begin, end) (the cone follows meshoptimizer's meshopt_computeClusterBounds):
+static Meshlet meshlet_bounds(std::vector< uint32_t > const &indices, uint32_t begin, uint32_t end, float const *positions, size_t position_stride) {
+	auto position = [&](uint32_t v) {
+		return reinterpret_cast< float const * >(reinterpret_cast< char const * >(positions) + v * position_stride);
+	};
+
+	Meshlet meshlet;
+	meshlet.first_index = 3 * begin;
+	meshlet.index_count = 3 * (end - begin);
+
+	//sphere around the center of the vertices' aabb:
+	float lo[3] = {INFINITY, INFINITY, INFINITY};
+	float hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+	for (uint32_t i = 3 * begin; i < 3 * end; ++i) {
+		float const *p = position(indices[i]);
+		for (uint32_t k = 0; k < 3; ++k) {
+			lo[k] = std::min(lo[k], p[k]);
+			hi[k] = std::max(hi[k], p[k]);
+		}
+	}
+	for (uint32_t k = 0; k < 3; ++k) meshlet.center[k] = 0.5f * (lo[k] + hi[k]);
+	float radius2 = 0.0f;
+	for (uint32_t i = 3 * begin; i < 3 * end; ++i) {
+		float const *p = position(indices[i]);
+		float d[3] = {p[0] - meshlet.center[0], p[1] - meshlet.center[1], p[2] - meshlet.center[2]};
+		radius2 = std::max(radius2, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+	}
+	//(a little slack, so float rounding in the culling test can't cut off a vertex on the sphere)
+	meshlet.radius = std::sqrt(radius2) * 1.0001f;
+
+	//cone axis: the average of the (unit) triangle normals; its spread: the largest angle between the axis and a normal:
+	std::vector< float > normals(3 * (end - begin), 0.0f);
+	std::vector< bool > degenerate(end - begin, false);
+	float axis[3] = {0.0f, 0.0f, 0.0f};
+	for (uint32_t t = begin; t < end; ++t) {
+		float const *a = position(indices[3 * t + 0]);
+		float const *b = position(indices[3 * t + 1]);
+		float const *c = position(indices[3 * t + 2]);
+		float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+		float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+		float n[3] = {
+			ab[1] * ac[2] - ab[2] * ac[1],
+			ab[2] * ac[0] - ab[0] * ac[2],
+			ab[0] * ac[1] - ab[1] * ac[0],
+		};
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (!(length > 0.0f)) { //(degenerate triangles don't rasterize, so they don't limit the cone)
+			degenerate[t - begin] = true;
+			continue;
+		}
+		for (uint32_t k = 0; k < 3; ++k) {
+			normals[3 * (t - begin) + k] = n[k] / length;
+			axis[k] += n[k] / length;
+		}
+	}
+	float axis_length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	if (!(axis_length > 0.0f)) return meshlet;
+	for (uint32_t k = 0; k < 3; ++k) axis[k] /= axis_length;
+
+	float min_dot = 1.0f;
+	for (uint32_t t = begin; t < end; ++t) {
+		if (degenerate[t - begin]) continue;
+		float const *n = &normals[3 * (t - begin)];
+		min_dot = std::min(min_dot, n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]);
+	}
+	//(wider than about 84 degrees, the cone would almost never cull and the apex below gets far away)
+	if (min_dot <= 0.1f) return meshlet;
+
+	//apex: move back along the axis until behind every triangle's plane, so the test holds from wherever the eye is:
+	float max_t = 0.0f;
+	for (uint32_t t = begin; t < end; ++t) {
+		if (degenerate[t - begin]) continue;
+		float const *n = &normals[3 * (t - begin)];
+		float const *a = position(indices[3 * t + 0]);
+		float to_center[3] = {meshlet.center[0] - a[0], meshlet.center[1] - a[1], meshlet.center[2] - a[2]};
+		float dc = to_center[0] * n[0] + to_center[1] * n[1] + to_center[2] * n[2];
+		float dn = axis[0] * n[0] + axis[1] * n[1] + axis[2] * n[2];
+		max_t = std::max(max_t, dc / dn);
+	}
+	for (uint32_t k = 0; k < 3; ++k) {
+		meshlet.cone_apex[k] = meshlet.center[k] - axis[k] * max_t;
+		meshlet.cone_axis[k] = axis[k];
+	}
+	meshlet.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+	return meshlet;
+}
+
+std::vector< Meshlet > build_meshlets(std::vector< uint32_t > const &indices, uint32_t vertex_count, float const *positions, size_t position_stride, uint32_t max_vertices, uint32_t max_triangles) {
+	uint32_t triangle_count = uint32_t(indices.size() / 3);
+	std::vector< Meshlet > meshlets;
+
+	//greedily extend the current meshlet until the next triangle would overflow it:
+	std::vector< uint32_t > used_by(vertex_count, UINT32_MAX); //the last meshlet to use each vertex
+	uint32_t begin = 0; //first triangle of the current meshlet
+	uint32_t used = 0; //distinct vertices in the current meshlet
+	auto new_vertices = [&](uint32_t t) {
+		uint32_t const *v = &indices[3 * t];
+		uint32_t current = uint32_t(meshlets.size());
+		return uint32_t(used_by[v[0]] != current)
+		     + uint32_t(used_by[v[1]] != current && v[1] != v[0])
+		     + uint32_t(used_by[v[2]] != current && v[2] != v[0] && v[2] != v[1]);
+	};
+	for (uint32_t t = 0; t < triangle_count; ++t) {
+		if (t > begin && (used + new_vertices(t) > max_vertices || t - begin >= max_triangles)) {
+			meshlets.emplace_back(meshlet_bounds(indices, begin, t, positions, position_stride));
+			begin = t;
+			used = 0;
+		}
+		used += new_vertices(t);
+		for (uint32_t c = 0; c < 3; ++c) used_by[indices[3 * t + c]] = uint32_t(meshlets.size());
+	}
+	if (begin < triangle_count) {
+		meshlets.emplace_back(meshlet_bounds(indices, begin, triangle_count, positions, position_stride));
+	}
+
+	return meshlets;
+}
+
+//sum of squared distances to (weighted) planes, as the 10 unique entries of a symmetric 4x4 matrix:
+struct Quadric {
+	double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0, b2 = 0.0, bc = 0.0, bd = 0.0, c2 = 0.0, cd = 0.0, d2 = 0.0;
+	double weight = 0.0;
+
+	void add_plane(double a, double b, double c, double d, double w) {
+		a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+		b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+		c2 += w * c * c; cd += w * c * d;
+		d2 += w * d * d;
+		weight += w;
+	}
+	Quadric &operator+=(Quadric const &o) {
+		a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+		b2 += o.b2; bc += o.bc; bd += o.bd;
+		c2 += o.c2; cd += o.cd;
+		d2 += o.d2;
+		weight += o.weight;
+		return *this;
+	}
+	//rms distance from p to the planes:
+	double distance(float const *p) const {
+		double x = p[0], y = p[1], z = p[2];
+		double e = a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+		         + b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+		         + c2 * z * z + 2.0 * cd * z
+		         + d2;
+		return (weight > 0.0 ? std::sqrt(std::max(e, 0.0) / weight) : 0.0);
+	}
+};
+
+std::vector< uint32_t > simplify(std::vector< uint32_t > const &indices, uint32_t vertex_count, float const *positions, size_t position_stride, size_t target_index_count, float max_error, float *error) {
+	auto position = [&](uint32_t v) {
+		return reinterpret_cast< float const * >(reinterpret_cast< char const * >(positions) + v * position_stride);
+	};
+	auto normal = [&](uint32_t a, uint32_t b, uint32_t c, double n[3]) {
+		float const *pa = position(a), *pb = position(b), *pc = position(c);
+		double ab[3] = {double(pb[0]) - pa[0], double(pb[1]) - pa[1], double(pb[2]) - pa[2]};
+		double ac[3] = {double(pc[0]) - pa[0], double(pc[1]) - pa[1], double(pc[2]) - pa[2]};
+		n[0] = ab[1] * ac[2] - ab[2] * ac[1];
+		n[1] = ab[2] * ac[0] - ab[0] * ac[2];
+		n[2] = ab[0] * ac[1] - ab[1] * ac[0];
+	};
+
+	std::vector< uint32_t > result;
+	result.reserve(indices.size());
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+		if (a == b || b == c || c == a) continue;
+		result.insert(result.end(), {a, b, c});
+	}
+	*error = 0.0f;
+
+	//vertices at the same position (one per set of attributes) share a "position" id:
+	std::vector< uint32_t > position_id(vertex_count);
+	std::vector< bool > locked(vertex_count, false);
+	{
+		std::vector< uint32_t > order(vertex_count);
+		for (uint32_t v = 0; v < vertex_count; ++v) order[v] = v;
+		auto key = [&](uint32_t v) {
+			float const *p = position(v);
+			return std::array< float, 3 >{p[0], p[1], p[2]};
+		};
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return key(a) < key(b); });
+		for (uint32_t i = 0; i < vertex_count; ) {
+			uint32_t j = i + 1;
+			while (j < vertex_count && key(order[j]) == key(order[i])) ++j;
+			for (uint32_t k = i; k < j; ++k) {
+				position_id[order[k]] = order[i];
+				locked[order[k]] = (j - i > 1); //(a seam)
+			}
+			i = j;
+		}
+	}
+
+	//border edges (used by one triangle, by position) lock their endpoints:
+	{
+		std::vector< std::pair< uint32_t, uint32_t > > edges;
+		edges.reserve(result.size());
+		for (size_t t = 0; t < result.size(); t += 3) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				uint32_t a = position_id[result[t + c]], b = position_id[result[t + (c + 1) % 3]];
+				edges.emplace_back(std::min(a, b), std::max(a, b));
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		std::vector< bool > border_position(vertex_count, false);
+		for (size_t i = 0; i < edges.size(); ) {
+			size_t j = i + 1;
+			while (j < edges.size() && edges[j] == edges[i]) ++j;
+			if (j - i == 1) border_position[edges[i].first] = border_position[edges[i].second] = true;
+			i = j;
+		}
+		for (uint32_t v = 0; v < vertex_count; ++v) {
+			if (border_position[position_id[v]]) locked[v] = true;
+		}
+	}
+
+	//each vertex's quadric: the planes of its triangles, weighted by area:
+	std::vector< Quadric > quadrics(vertex_count);
+	for (size_t t = 0; t < result.size(); t += 3) {
+		double n[3];
+		normal(result[t], result[t + 1], result[t + 2], n);
+		double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (!(length > 0.0)) continue;
+		float const *p = position(result[t]);
+		double a = n[0] / length, b = n[1] / length, c = n[2] / length;
+		double d = -(a * p[0] + b * p[1] + c * p[2]);
+		for (uint32_t k = 0; k < 3; ++k) quadrics[result[t + k]].add_plane(a, b, c, d, 0.5 * length);
+	}
+
+	struct Collapse {
+		uint32_t from, to;
+		double cost;
+	};
+	std::vector< Collapse > collapses;
+	std::vector< uint32_t > adjacency_begin, adjacency;
+	std::vector< bool > touched(vertex_count, false);
+	std::vector< uint32_t > remap(vertex_count);
+
+	//passes of independent collapses (no two touch the same triangles), cheapest first:
+	while (result.size() > target_index_count) {
+		collapses.clear();
+		for (size_t t = 0; t < result.size(); t += 3) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				uint32_t a = result[t + c], b = result[t + (c + 1) % 3];
+				for (uint32_t dir = 0; dir < 2; ++dir) {
+					uint32_t from = (dir ? b : a), to = (dir ? a : b);
+					if (locked[from]) continue;
+					Quadric q = quadrics[from];
+					q += quadrics[to];
+					collapses.emplace_back(Collapse{from, to, q.distance(position(to))});
+				}
+			}
+		}
+		if (collapses.empty()) break;
+		std::sort(collapses.begin(), collapses.end(), [](Collapse const &x, Collapse const &y) {
+			return x.cost < y.cost || (x.cost == y.cost && (x.from < y.from || (x.from == y.from && x.to < y.to)));
+		});
+
+		//vertex -> triangles:
+		adjacency_begin.assign(vertex_count + 1, 0);
+		for (uint32_t v : result) adjacency_begin[v + 1] += 1;
+		for (uint32_t v = 0; v < vertex_count; ++v) adjacency_begin[v + 1] += adjacency_begin[v];
+		adjacency.resize(result.size());
+		{
+			std::vector< uint32_t > fill(adjacency_begin.begin(), adjacency_begin.end() - 1);
+			for (size_t i = 0; i < result.size(); ++i) adjacency[fill[result[i]]++] = uint32_t(i / 3);
+		}
+
+		std::fill(touched.begin(), touched.end(), false);
+		for (uint32_t v = 0; v < vertex_count; ++v) remap[v] = v;
+
+		//(each collapse removes about two triangles; stopping a pass early keeps the later choices' costs current)
+		size_t budget = (result.size() - target_index_count) / 6 + 1;
+		size_t made = 0;
+		bool over_error = false;
+		for (Collapse const &collapse : collapses) {
+			if (collapse.cost > max_error) {
+				over_error = true;
+				break;
+			}
+			if (touched[collapse.from] || touched[collapse.to]) continue;
+
+			//reject collapses that would flip (or fold) a triangle that stays:
+			bool flips = false;
+			for (uint32_t a = adjacency_begin[collapse.from]; a < adjacency_begin[collapse.from + 1] && !flips; ++a) {
+				uint32_t const *tri = &result[3 * adjacency[a]];
+				if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) continue; //(removed by the collapse)
+				uint32_t moved[3];
+				for (uint32_t c = 0; c < 3; ++c) moved[c] = (tri[c] == collapse.from ? collapse.to : tri[c]);
+				double before[3], after[3];
+				normal(tri[0], tri[1], tri[2], before);
+				normal(moved[0], moved[1], moved[2], after);
+				flips = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0;
+			}
+			if (flips) continue;
+
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			for (uint32_t a = adjacency_begin[collapse.from]; a < adjacency_begin[collapse.from + 1]; ++a) {
+				uint32_t const *tri = &result[3 * adjacency[a]];
+				for (uint32_t c = 0; c < 3; ++c) touched[tri[c]] = true;
+			}
+			*error = std::max(*error, float(collapse.cost));
+			if (++made == budget) break;
+		}
+		if (made == 0) break;
+
+		size_t out = 0;
+		for (size_t t = 0; t < result.size(); t += 3) {
+			uint32_t a = remap[result[t]], b = remap[result[t + 1]], c = remap[result[t + 2]];
+			if (a == b || b == c || c == a) continue;
+			result[out++] = a;
+			result[out++] = b;
+			result[out++] = c;
+		}
+		result.resize(out);
+		if (over_error) break;
+	}
+
+	return result;
+}
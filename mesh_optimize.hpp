@@ -0,0 +1,50 @@
+#pragma once
+
+//Load-time reordering of indexed triangle lists for the GPU's post-transform vertex cache, overdraw, and vertex fetch,
+// and splitting them into meshlets for per-cluster culling.
+// (Used by Tutorial::build_scene_meshes with --optimize-meshes and --culling clusters; indices are UINT32, three per triangle.)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Reorder triangles with Tipsify (Sander, Nehab & Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007)
+//  for a vertex cache of cache_size entries.
+// Fills cluster_starts with the first triangle of each run that began at a dead end (where the cache is mostly cold anyway).
+std::vector< uint32_t > tipsify(std::vector< uint32_t > const &indices, uint32_t vertex_count, uint32_t cache_size, std::vector< uint32_t > *cluster_starts);
+
+// Reorder the clusters from tipsify so that clusters facing away from the mesh's center draw first
+//  (they are more likely to occlude the rest of the mesh, so less is overdrawn); triangles within a cluster keep their order.
+// positions[i * position_stride / sizeof(float)] is the x of vertex i (followed by y and z).
+void sort_clusters_for_overdraw(std::vector< uint32_t > &indices, std::vector< uint32_t > const &cluster_starts, float const *positions, size_t position_stride);
+
+// Renumber vertices in the order the indices first use them (so vertex fetch walks the vertex buffer mostly forward).
+// Fills remap (old vertex -> new vertex, UINT32_MAX if unused) and returns the number of vertices used.
+uint32_t reorder_vertices_for_fetch(std::vector< uint32_t > &indices, uint32_t vertex_count, std::vector< uint32_t > *remap);
+
+// Post-transform cache efficiency of an index order, from a simulated FIFO cache of cache_size entries:
+struct VertexCacheStats {
+	float acmr = 0.0f; //average cache miss ratio: vertex shader invocations per triangle (0.5 is ideal for large grids, 3 is worst)
+	float atvr = 0.0f; //average transform to vertex ratio: vertex shader invocations per used vertex (1 is ideal)
+};
+VertexCacheStats simulate_vertex_cache(std::vector< uint32_t > const &indices, uint32_t vertex_count, uint32_t cache_size);
+
+// A run of triangles with few enough distinct vertices to cull as a unit:
+struct Meshlet {
+	uint32_t first_index = 0, index_count = 0; //the meshlet's triangles (a contiguous range of the indices)
+	float center[3] = {0.0f, 0.0f, 0.0f}, radius = 0.0f; //bounding sphere
+	//backface cone: every triangle faces away from eye if dot(normalize(cone_apex - eye), cone_axis) >= cone_cutoff
+	// (cone_cutoff is 1 and cone_axis is zero if the triangles face too many ways for the test to be useful)
+	float cone_apex[3] = {0.0f, 0.0f, 0.0f}, cone_axis[3] = {0.0f, 0.0f, 0.0f}, cone_cutoff = 1.0f;
+};
+
+// Split a triangle list, in its current order, into meshlets of at most max_vertices distinct vertices and max_triangles triangles,
+//  with bounds from positions (read like sort_clusters_for_overdraw's).
+std::vector< Meshlet > build_meshlets(std::vector< uint32_t > const &indices, uint32_t vertex_count, float const *positions, size_t position_stride, uint32_t max_vertices, uint32_t max_triangles);
+
+// Simplify a triangle list by edge collapses ordered by quadric error (Garland & Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997).
+// A collapse moves one endpoint onto the other, so the result indexes the same vertices (only the index list changes).
+// Vertices on open borders and attribute seams (several vertices at one position) never move, so the mesh doesn't tear.
+// Stops at (or below) target_index_count, when the next collapse would move the surface more than max_error, or when nothing can collapse;
+//  *error is then the largest (rms, in position units) distance any collapse moved the surface.
+std::vector< uint32_t > simplify(std::vector< uint32_t > const &indices, uint32_t vertex_count, float const *positions, size_t position_stride, size_t target_index_count, float max_error, float *error);
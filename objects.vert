@@ -11,8 +11,13 @@ layout(set = 1, binding = 0, std140) readonly buffer Transforms {
     Transform TRANSFORMS[];
 };
 
-layout(location = 0) in vec3 Position;
-layout(location = 1) in vec3 Normal;
+// set (by ObjectsPipeline::create) with --packed-vertices, when the vertices are PackedVertex:
+//  Position.xyz is then in [0,1] across the mesh's aabb (CLIP_FROM_LOCAL and WORLD_FROM_LOCAL include the scale back),
+//  Position.w is the bitangent sign as 0 or 1, and Normal.xy and Tangent.xy are octahedral encodings
+layout(constant_id = 0) const bool PACKED_VERTICES = false;
+
+layout(location = 0) in vec4 Position;
+layout(location = 1) in vec4 Normal;
 layout(location = 2) in vec4 Tangent;   // .xyz = tangent direction, .w = bitangent sign
 layout(location = 3) in vec2 TexCoord;
 
@@ -22,11 +27,22 @@ layout(location = 2) out vec2 texCoord;
 layout(location = 3) out vec3 tangent;
 layout(location = 4) out float bitangent_sign;
 
+// inverse of octahedral() in PackedVertex.cpp:
+vec3 octahedral_decode(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+    return normalize(v);
+}
+
 void main() {
-    gl_Position = TRANSFORMS[gl_InstanceIndex].CLIP_FROM_LOCAL * vec4(Position, 1.0);
-    position = mat4x3(TRANSFORMS[gl_InstanceIndex].WORLD_FROM_LOCAL) * vec4(Position, 1.0);
-    normal = mat3(TRANSFORMS[gl_InstanceIndex].WORLD_FROM_LOCAL_NORMAL) * Normal;
-    tangent = mat3(TRANSFORMS[gl_InstanceIndex].WORLD_FROM_LOCAL_NORMAL) * Tangent.xyz;
-    bitangent_sign = Tangent.w;
+    vec3 local_normal = PACKED_VERTICES ? octahedral_decode(Normal.xy) : Normal.xyz;
+    vec3 local_tangent = PACKED_VERTICES ? octahedral_decode(Tangent.xy) : Tangent.xyz;
+
+    gl_Position = TRANSFORMS[gl_InstanceIndex].CLIP_FROM_LOCAL * vec4(Position.xyz, 1.0);
+    position = mat4x3(TRANSFORMS[gl_InstanceIndex].WORLD_FROM_LOCAL) * vec4(Position.xyz, 1.0);
+    normal = mat3(TRANSFORMS[gl_InstanceIndex].WORLD_FROM_LOCAL_NORMAL) * local_normal;
+    tangent = mat3(TRANSFORMS[gl_InstanceIndex].WORLD_FROM_LOCAL_NORMAL) * local_tangent;
+    bitangent_sign = PACKED_VERTICES ? Position.w * 2.0 - 1.0 : Tangent.w;
     texCoord = TexCoord;
 }
\ No newline at end of file
@@ -0,0 +1,170 @@
+//Benchmark for s72 scene loading at startup.
+// Compares parsing the scene's JSON (S72::load) with loading through the compiled
+// scene cache (S72::load_cached): "cold" has no cache yet, so it parses the JSON and
+// writes the cache; "warm" maps the cache written by an earlier load.
+// Also counts the heap allocations made by one call to each.
+//
+// usage: s72-bench scene.s72 [--iterations N] [--load-threads N]
+//NOTE: leaves scene.s72c (the cache) next to scene.s72
+
+#include "S72.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+//count heap allocations by replacing the global allocation functions:
+// (the array and aligned forms of new call these, and the nothrow forms call the array/plain ones)
+static std::atomic< uint64_t > allocations{ 0 };
+static std::atomic< uint64_t > allocated_bytes{ 0 };
+
+void *operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+	if (void *ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+	throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete(void *ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+struct Allocations {
+	uint64_t count = 0;
+	uint64_t bytes = 0;
+};
+
+template< typename F >
+static Allocations count_allocations(F const &run) {
+	uint64_t count_before = allocations.load();
+	uint64_t bytes_before = allocated_bytes.load();
+	run();
+	return Allocations{ .count = allocations.load() - count_before, .bytes = allocated_bytes.load() - bytes_before };
+}
+
+struct Timing {
+	double min_ms = 0.0;
+	double median_ms = 0.0;
+};
+
+template< typename F >
+static Timing time_runs(uint32_t iterations, F const &run) {
+	std::vector< double > ms;
+	ms.reserve(iterations);
+	for (uint32_t i = 0; i < iterations; ++i) {
+		auto before = std::chrono::high_resolution_clock::now();
+		run();
+		auto after = std::chrono::high_resolution_clock::now();
+		ms.emplace_back(std::chrono::duration< double, std::milli >(after - before).count());
+	}
+	std::sort(ms.begin(), ms.end());
+	return Timing{ .min_ms = ms.front(), .median_ms = ms[ms.size() / 2] };
+}
+
+//quick check that two loads found the same things:
+static bool same_counts(S72 const &a, S72 const &b) {
+	return a.nodes.size() == b.nodes.size()
+	    && a.meshes.size() == b.meshes.size()
+	    && a.data_files.size() == b.data_files.size()
+	    && a.cameras.size() == b.cameras.size()
+	    && a.drivers.size() == b.drivers.size()
+	    && a.materials.size() == b.materials.size()
+	    && a.textures.size() == b.textures.size()
+	    && a.environments.size() == b.environments.size()
+	    && a.lights.size() == b.lights.size()
+	    && a.scene.name == b.scene.name
+	    && a.scene.roots.size() == b.scene.roots.size();
+}
+
+int main(int argc, char **argv) {
+	std::string input_path;
+	uint32_t iterations = 10;
+	uint32_t threads = 1;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--iterations" || arg == "--load-threads") {
+			if (i + 1 < argc) {
+				++i;
+				uint32_t value = uint32_t(std::max(1, std::stoi(argv[i])));
+				if (arg == "--iterations") iterations = value;
+				else threads = value;
+			} else {
+				std::cerr << "Error: " << arg << " requires a number." << std::endl;
+				return 1;
+			}
+		} else if (input_path.empty()) {
+			input_path = arg;
+		} else {
+			std::cerr << "Error: unexpected argument '" << arg << "'." << std::endl;
+			return 1;
+		}
+	}
+
+	if (input_path.empty()) {
+		std::cerr << "Usage: s72-bench scene.s72 [--iterations N] [--load-threads N]" << std::endl;
+		return 1;
+	}
+
+	std::string cache_path = input_path + "c";
+
+	try {
+		S72 parsed = S72::load(input_path, threads);
+		std::filesystem::remove(cache_path);
+		S72 cold_load = S72::load_cached(input_path, threads);
+		S72 warm_load = S72::load_cached(input_path, threads);
+		if (!same_counts(parsed, cold_load) || !same_counts(parsed, warm_load)) {
+			std::cerr << "Error: parsed and cached loads of '" << input_path << "' disagree." << std::endl;
+			return 1;
+		}
+
+		Allocations parse_allocations = count_allocations([&]() {
+			S72::load(input_path, threads);
+		});
+		Allocations warm_allocations = count_allocations([&]() {
+			S72::load_cached(input_path, threads);
+		});
+
+		Timing parse = time_runs(iterations, [&]() {
+			S72::load(input_path, threads);
+		});
+
+		Timing cold = time_runs(iterations, [&]() {
+			std::filesystem::remove(cache_path);
+			S72::load_cached(input_path, threads);
+		});
+
+		Timing warm = time_runs(iterations, [&]() {
+			S72::load_cached(input_path, threads);
+		});
+
+		std::cout << "Input: " << input_path << " (" << std::filesystem::file_size(input_path) << " bytes, "
+		          << iterations << " iterations, " << threads << " load thread(s))" << std::endl;
+		std::cout << "  cache: " << cache_path << " (" << std::filesystem::file_size(cache_path) << " bytes)" << std::endl;
+		auto report = [&](char const *name, Timing const &t) {
+			std::cout << "  " << name << ": median " << t.median_ms << " ms, min " << t.min_ms << " ms" << std::endl;
+		};
+		report("S72::load (parse JSON)    ", parse);
+		report("load_cached, cold (+write)", cold);
+		report("load_cached, warm (cache) ", warm);
+		std::cout << "  speedup: " << (parse.median_ms / warm.median_ms) << "x (warm vs. parse)" << std::endl;
+		auto report_allocations = [&](char const *name, Allocations const &a) {
+			std::cout << "  " << name << ": " << a.count << " heap allocations (" << a.bytes << " bytes)" << std::endl;
+		};
+		report_allocations("S72::load (parse JSON)    ", parse_allocations);
+		report_allocations("load_cached, warm (cache) ", warm_allocations);
+	} catch (std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,272 @@
+//Benchmark for the sejp JSON parser.
+// Compares the buffer-based parser (used by sejp::load) -- copying strings
+// or referencing the source text -- the lazy parser, and event-based
+// parsing with the character-at-a-time std::istream parser on the same
+// in-memory file, by time and by heap use.
+//
+// usage: sejp-bench scene.s72 [--iterations N]
+
+#include "sejp.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//count heap traffic so parses can be compared by memory as well as time:
+// (the bench is single-threaded, so plain counters are fine)
+namespace {
+	struct {
+		size_t count = 0; //number of allocations
+		size_t live = 0; //bytes currently allocated
+		size_t peak = 0; //high water mark of live
+	} heap;
+	constexpr size_t HeaderSize = 16; //(keeps returned blocks 16-byte aligned)
+}
+
+void *operator new(size_t size) {
+	char *block = static_cast< char * >(std::malloc(size + HeaderSize));
+	if (!block) throw std::bad_alloc();
+	*reinterpret_cast< size_t * >(block) = size;
+	heap.count += 1;
+	heap.live += size;
+	heap.peak = std::max(heap.peak, heap.live);
+	return block + HeaderSize;
+}
+
+void operator delete(void *ptr) noexcept {
+	if (!ptr) return;
+	char *block = static_cast< char * >(ptr) - HeaderSize;
+	heap.live -= *reinterpret_cast< size_t * >(block);
+	std::free(block);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+	operator delete(ptr);
+}
+
+//check that two parses produced the same tree:
+static bool same(sejp::value const &a, sejp::value const &b) {
+	if (auto s = a.as_string()) return b.as_string() == s;
+	if (auto n = a.as_number()) return b.as_number() == n;
+	if (auto t = a.as_bool()) return b.as_bool() == t;
+	if (a.as_null()) return bool(b.as_null());
+	if (auto arr = a.as_array()) {
+		auto brr = b.as_array();
+		if (!brr || arr->size() != brr->size()) return false;
+		for (size_t i = 0; i < arr->size(); ++i) {
+			if (!same((*arr)[i], (*brr)[i])) return false;
+		}
+		return true;
+	}
+	if (auto obj = a.as_object()) {
+		auto bbj = b.as_object();
+		if (!bbj || obj->size() != bbj->size()) return false;
+		for (auto const &[key, value] : *obj) {
+			auto f = bbj->find(key);
+			if (f == bbj->end() || !same(value, f->second)) return false;
+		}
+		return true;
+	}
+	return false;
+}
+
+//visit every value (which makes a lazy document decode everything):
+static size_t walk(sejp::value const &v) {
+	if (auto arr = v.as_array()) {
+		size_t count = 1;
+		for (sejp::value const &e : *arr) count += walk(e);
+		return count;
+	}
+	if (auto obj = v.as_object()) {
+		size_t count = 1;
+		for (auto const &[key, value] : *obj) count += walk(value);
+		return count;
+	}
+	if (auto n = v.as_number()) return (*n == *n ? 1 : 0);
+	return 1;
+}
+
+//a handler that just counts values (so event parsing has something to do):
+struct CountValues : sejp::handler {
+	size_t count = 0;
+	void on_object_begin() override { ++count; }
+	void on_array_begin() override { ++count; }
+	void on_string(std::string_view) override { ++count; }
+	void on_number(double) override { ++count; }
+	void on_bool(bool) override { ++count; }
+	void on_null() override { ++count; }
+};
+
+struct Timing {
+	double min_ms = 0.0;
+	double median_ms = 0.0;
+};
+
+template< typename F >
+static Timing time_runs(uint32_t iterations, F const &run) {
+	std::vector< double > ms;
+	ms.reserve(iterations);
+	for (uint32_t i = 0; i < iterations; ++i) {
+		auto before = std::chrono::high_resolution_clock::now();
+		run();
+		auto after = std::chrono::high_resolution_clock::now();
+		ms.emplace_back(std::chrono::duration< double, std::milli >(after - before).count());
+	}
+	std::sort(ms.begin(), ms.end());
+	return Timing{ .min_ms = ms.front(), .median_ms = ms[ms.size() / 2] };
+}
+
+int main(int argc, char **argv) {
+	std::string input_path;
+	uint32_t iterations = 20;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--iterations") {
+			if (i + 1 < argc) {
+				++i;
+				iterations = uint32_t(std::max(1, std::stoi(argv[i])));
+			} else {
+				std::cerr << "Error: --iterations requires a number." << std::endl;
+				return 1;
+			}
+		} else if (input_path.empty()) {
+			input_path = arg;
+		} else {
+			std::cerr << "Error: unexpected argument '" << arg << "'." << std::endl;
+			return 1;
+		}
+	}
+
+	if (input_path.empty()) {
+		std::cerr << "Usage: sejp-bench scene.s72 [--iterations N]" << std::endl;
+		return 1;
+	}
+
+	//read the file once so both parsers are timed without disk I/O:
+	std::string buffer;
+	{
+		std::ifstream in(input_path, std::ios::binary);
+		if (!in) {
+			std::cerr << "Error: failed to open '" << input_path << "'." << std::endl;
+			return 1;
+		}
+		std::ostringstream contents;
+		contents << in.rdbuf();
+		buffer = contents.str();
+	}
+
+	try {
+		sejp::document from_buffer = sejp::parse(std::string_view(buffer));
+		sejp::document from_stream = [&]() {
+			std::istringstream in(buffer, std::ios::binary);
+			return sejp::parse(in);
+		}();
+		sejp::document from_reference = sejp::parse(std::string_view(buffer), sejp::Strings::Reference);
+		sejp::document from_lazy = sejp::parse_lazy(std::string_view(buffer));
+		if (!same(from_buffer.root(), from_stream.root()) || !same(from_buffer.root(), from_reference.root()) || !same(from_buffer.root(), from_lazy.root())) {
+			std::cerr << "Error: buffer and stream parsers disagree on '" << input_path << "'." << std::endl;
+			return 1;
+		}
+
+		struct Memory {
+			size_t allocations = 0;
+			size_t peak_bytes = 0; //most heap in use at once during the parse
+			size_t retained_bytes = 0; //heap held by the parsed document
+		};
+		auto measure = [](auto const &run) -> Memory {
+			Memory memory;
+			size_t count_before = heap.count;
+			size_t live_before = heap.live;
+			heap.peak = heap.live;
+			{
+				sejp::document document = run();
+				memory.allocations = heap.count - count_before;
+				memory.peak_bytes = heap.peak - live_before;
+				memory.retained_bytes = heap.live - live_before;
+			}
+			return memory;
+		};
+
+		Memory stream_memory = measure([&]() {
+			std::istringstream in(buffer, std::ios::binary);
+			return sejp::parse(in);
+		});
+		Memory buffered_memory = measure([&]() {
+			return sejp::parse(std::string_view(buffer));
+		});
+		Memory reference_memory = measure([&]() {
+			return sejp::parse(std::string_view(buffer), sejp::Strings::Reference);
+		});
+		Memory lazy_memory = measure([&]() {
+			return sejp::parse_lazy(std::string_view(buffer));
+		});
+		Memory events_memory = measure([&]() {
+			CountValues counter;
+			sejp::parse(std::string_view(buffer), counter);
+			return sejp::document();
+		});
+
+		Timing stream = time_runs(iterations, [&]() {
+			std::istringstream in(buffer, std::ios::binary);
+			sejp::parse(in);
+		});
+
+		Timing buffered = time_runs(iterations, [&]() {
+			sejp::parse(std::string_view(buffer));
+		});
+
+		Timing reference = time_runs(iterations, [&]() {
+			sejp::parse(std::string_view(buffer), sejp::Strings::Reference);
+		});
+
+		Timing lazy = time_runs(iterations, [&]() {
+			sejp::parse_lazy(std::string_view(buffer));
+		});
+
+		Timing events = time_runs(iterations, [&]() {
+			CountValues counter;
+			sejp::parse(std::string_view(buffer), counter);
+		});
+
+		//parse-then-use-everything times, which is the lazy parser's worst case:
+		Timing buffered_walk = time_runs(iterations, [&]() {
+			walk(sejp::parse(std::string_view(buffer)).root());
+		});
+
+		Timing lazy_walk = time_runs(iterations, [&]() {
+			walk(sejp::parse_lazy(std::string_view(buffer)).root());
+		});
+
+		double mb = double(buffer.size()) / (1024.0 * 1024.0);
+		std::cout << "Input: " << input_path << " (" << buffer.size() << " bytes, " << iterations << " iterations)" << std::endl;
+		auto report = [&](char const *name, Timing const &t, Memory const &m) {
+			std::cout << "  " << name << ": median " << t.median_ms << " ms, min " << t.min_ms << " ms, "
+			          << (mb / (t.median_ms / 1000.0)) << " MB/s" << std::endl;
+			std::cout << "  " << std::string(std::string_view(name).size(), ' ') << "  "
+			          << m.allocations << " allocations, peak " << m.peak_bytes << " bytes, retained " << m.retained_bytes << " bytes" << std::endl;
+		};
+		report("std::istream      ", stream, stream_memory);
+		report("buffer (copy)     ", buffered, buffered_memory);
+		report("buffer (reference)", reference, reference_memory);
+		report("lazy              ", lazy, lazy_memory);
+		report("events            ", events, events_memory);
+		std::cout << "  speedup: " << (stream.median_ms / buffered.median_ms) << "x (copy), "
+		          << (stream.median_ms / reference.median_ms) << "x (reference), "
+		          << (stream.median_ms / lazy.median_ms) << "x (lazy), "
+		          << (stream.median_ms / events.median_ms) << "x (events)" << std::endl;
+		std::cout << "  parse + visit every value: buffer (copy) median " << buffered_walk.median_ms << " ms, "
+		          << "lazy median " << lazy_walk.median_ms << " ms" << std::endl;
+	} catch (std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
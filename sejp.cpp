@@ -6,17 +6,126 @@
 #include <fstream>
 #include <sstream>
 #include <charconv>
+#include <system_error>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <new>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#endif
 
 namespace sejp {
 
+//chunked storage for the bytes of strings and keys:
+// (views into the arena stay valid as it grows, since blocks never move)
+struct Arena {
+	std::vector< std::unique_ptr< char[] > > blocks;
+	char *next = nullptr;
+	size_t remaining = 0;
+	size_t block_size = 64 * 1024;
+	size_t first_size = 0; //size of blocks[0]
+
+	//uninitialized space for 'size' bytes, aligned to 'align':
+	void *allocate(size_t size, size_t align) {
+		size_t pad = (align - reinterpret_cast< uintptr_t >(next) % align) % align;
+		if (pad + size > remaining) {
+			size_t block = std::max(size, block_size);
+			blocks.emplace_back(new char[block]); //(aligned for any fundamental type)
+			if (blocks.size() == 1) first_size = block;
+			next = blocks.back().get();
+			remaining = block;
+			pad = 0;
+		}
+		void *ret = next + pad;
+		next += pad + size;
+		remaining -= pad + size;
+		return ret;
+	}
+
+	std::string_view store(std::string_view const &str) {
+		if (str.empty()) return std::string_view();
+		char *at = static_cast< char * >(allocate(str.size(), 1));
+		std::memcpy(at, str.data(), str.size());
+		return std::string_view(at, str.size());
+	}
+
+	//forget everything stored, but keep the first block to store into again:
+	void clear() {
+		if (blocks.empty()) return;
+		blocks.resize(1);
+		next = blocks[0].get();
+		remaining = first_size;
+	}
+};
+
 struct parsed {
-	std::vector< std::optional< std::string > > strings;
-	std::vector< std::optional< double > > numbers;
+	std::string source; //source text, kept when parsing with Strings::Reference
+	Arena arena; //holds the bytes of every string and key that doesn't point into source
+	std::vector< std::string_view > strings;
+	std::vector< double > numbers;
 	//(nothing to store for booleans and nulls)
-	std::vector< std::optional< std::vector< value > > > arrays;
-	std::vector< std::optional< std::map< std::string, value > > > objects;
+
+	//arrays and objects are [begin,end) ranges of contiguous storage:
+	struct Range {
+		uint32_t begin = 0;
+		uint32_t end = 0;
+	};
+	std::vector< Range > arrays; //ranges of elements
+	std::vector< uint32_t > elements; //value indices
+	std::vector< Range > objects; //ranges of members (each range sorted by key)
+	std::vector< object_entry > members;
+
+	uint32_t root = -1U;
+
+	//lazy documents (see parse_lazy) keep only the source text and an index of it;
+	// containers are decoded on first access, numbers on every access:
+	bool lazy = false;
+	std::vector< uint32_t > structurals; //offsets of structurals in source (see find_structurals)
+	struct LazyContainer {
+		uint32_t open; //structural index of the '{' or '['
+		uint32_t close; //structural index of the matching '}' or ']'
+		uint32_t end; //number of the first container after this one's nested containers
+		uint32_t count; //entries (may shrink on decode, when duplicate keys are dropped)
+		//filled in on first as_array() / as_object():
+		bool decoded;
+		void const *entries; //uint32_t value indices for arrays, object_entry's for objects
+	};
+	//NOTE: lazy decoding modifies these from const accessors, so lazy documents must not be read from several threads at once
+	mutable std::vector< LazyContainer > containers; //numbered in document order
+	mutable Arena decoded; //decoded container entries
+	std::unordered_map< uint32_t, std::string_view > unescaped; //strings with escapes, by structural index of opening quote
+
+	//empty, but keep allocated storage (so it can hold another document):
+	void clear() {
+		source.clear();
+		arena.clear();
+		strings.clear();
+		numbers.clear();
+		arrays.clear();
+		elements.clear();
+		objects.clear();
+		members.clear();
+		root = -1U;
+		lazy = false;
+		structurals.clear();
+		containers.clear();
+		decoded.clear();
+		unescaped.clear();
+	}
 };
 
+static_assert(std::is_trivially_copyable_v< value >, "values should be cheap to pass around");
+
 enum Masks : uint32_t {
 	TypeBits  = 0xe0000000,
 	IndexBits = 0x1fffffff
@@ -33,7 +142,150 @@ enum Types : uint32_t {
 	Empty   = 0xe0000000, //<--- used during parsing
 };
 
-value parse(std::istream &from) {
+//Both parsers feed values through a Builder:
+// array elements and object members are staged on scratch stacks until
+// their container closes, then moved into parsed's contiguous storage.
+struct Builder {
+	std::shared_ptr< parsed > data = std::make_shared< parsed >();
+	value root = value(data.get(), -1U);
+
+	struct Open {
+		uint32_t index; //value index of the container
+		uint32_t first; //first staged entry belonging to it
+	};
+	std::vector< Open > open; //containing maps/arrays
+	std::vector< value > staged_elements;
+	std::vector< member > staged_members;
+
+	bool done() const {
+		return root.index != -1U && open.empty();
+	}
+	bool in_object() const {
+		return !open.empty() && (open.back().index & TypeBits) == Object;
+	}
+	bool in_array() const {
+		return !open.empty() && (open.back().index & TypeBits) == Array;
+	}
+	//does the innermost container have any entries yet?
+	bool container_empty() const {
+		assert(!open.empty());
+		return (in_object() ? staged_members.size() : staged_elements.size()) == open.back().first;
+	}
+
+	//slots for the next value:
+	value *element_slot() {
+		assert(in_array());
+		staged_elements.emplace_back(data.get(), -1U);
+		return &staged_elements.back();
+	}
+	//NOTE: keys and strings are stored as-is, so must already point to storage that lives as long as data
+	value *member_slot(std::string_view const &key) {
+		assert(in_object());
+		staged_members.emplace_back(key, value(data.get(), -1U));
+		return &staged_members.back().second;
+	}
+
+	//fill in slots:
+	void begin_object(value *target) {
+		if (uint32_t(data->objects.size()) & ~IndexBits) throw std::runtime_error("parser error: too many objects.");
+		target->index = Object | uint32_t(data->objects.size());
+		data->objects.emplace_back();
+		open.emplace_back(Open{ target->index, uint32_t(staged_members.size()) });
+	}
+	void begin_array(value *target) {
+		if (uint32_t(data->arrays.size()) & ~IndexBits) throw std::runtime_error("parser error: too many arrays.");
+		target->index = Array | uint32_t(data->arrays.size());
+		data->arrays.emplace_back();
+		open.emplace_back(Open{ target->index, uint32_t(staged_elements.size()) });
+	}
+	void set_string(value *target, std::string_view const &str) {
+		if (uint32_t(data->strings.size()) & ~IndexBits) throw std::runtime_error("parser error: too many strings.");
+		target->index = String | uint32_t(data->strings.size());
+		data->strings.emplace_back(str);
+	}
+	void set_number(value *target, double number) {
+		if (uint32_t(data->numbers.size()) & ~IndexBits) throw std::runtime_error("parser error: too many numbers.");
+		target->index = Number | uint32_t(data->numbers.size());
+		data->numbers.emplace_back(number);
+	}
+
+	//move the innermost container's staged entries into place:
+	void end_container() {
+		assert(!open.empty());
+		Open top = open.back();
+		open.pop_back();
+		if ((top.index & TypeBits) == Object) {
+			auto first = staged_members.begin() + top.first;
+			//sort for binary search; for duplicate keys the last one wins:
+			std::stable_sort(first, staged_members.end(), [](member const &a, member const &b) {
+				return a.first < b.first;
+			});
+			parsed::Range &range = data->objects[top.index & IndexBits];
+			range.begin = uint32_t(data->members.size());
+			for (auto m = first; m != staged_members.end(); ++m) {
+				if (m + 1 != staged_members.end() && (m + 1)->first == m->first) continue;
+				data->members.emplace_back(object_entry{ m->first, m->second.index });
+			}
+			range.end = uint32_t(data->members.size());
+			staged_members.erase(first, staged_members.end());
+		} else { assert((top.index & TypeBits) == Array);
+			auto first = staged_elements.begin() + top.first;
+			parsed::Range &range = data->arrays[top.index & IndexBits];
+			range.begin = uint32_t(data->elements.size());
+			for (auto e = first; e != staged_elements.end(); ++e) {
+				data->elements.emplace_back(e->index);
+			}
+			range.end = uint32_t(data->elements.size());
+			staged_elements.erase(first, staged_elements.end());
+		}
+		if (data->elements.size() > IndexBits || data->members.size() > IndexBits) throw std::runtime_error("parser error: too many values.");
+	}
+
+	document finish() {
+		assert(done());
+		data->root = root.index;
+		return document{ .data = data };
+	}
+
+	//start building another document (after finish()), into 'storage' if supplied:
+	// NOTE: storage should be empty (see parsed::clear)
+	void restart(std::shared_ptr< parsed > storage = nullptr) {
+		assert(done());
+		data = storage ? std::move(storage) : std::make_shared< parsed >();
+		root = value(data.get(), -1U);
+	}
+};
+
+//re-encode a code point as UTF8:
+static void append_utf8(std::string *ret_, uint32_t value) {
+	assert(ret_);
+	auto &ret = *ret_;
+	if (value <= 0x007f) {
+		ret += char(value);
+	} else if (value <= 0x07ff) {
+		ret += char(0xc0 | (value >> 6));
+		ret += char(0x80 | (value & 0x3f));
+	} else if (value <= 0xffff) {
+		ret += char(0xe0 | (value >> 12));
+		ret += char(0x80 | ((value >> 6) & 0x3f));
+		ret += char(0x80 | (value & 0x3f));
+	} else { assert(value <= 0x10ffff);
+		ret += char(0xf0 | (value >> 18));
+		ret += char(0x80 | ((value >> 12) & 0x3f));
+		ret += char(0x80 | ((value >> 6) & 0x3f));
+		ret += char(0x80 | (value & 0x3f));
+	}
+}
+
+//parse errors reported the same way by the istream and buffer parsers:
+static std::runtime_error unexpected_after_value(char c) {
+	return std::runtime_error(std::string("parse error: unexpected '") + c + "' after value.");
+}
+static std::runtime_error trailing_junk() {
+	return std::runtime_error("parse error: trailing junk.");
+}
+
+document parse(std::istream &from) {
 	//helpers to read from string:
 
 	auto skip_wsp = [&from]() {
@@ -151,23 +403,7 @@ value parse(std::istream &from) {
 					assert(value <= 0xffff);
 					//TODO: handle surrogate pairs!
 					// (might result in value > 0xffff)
-
-					//re-encode as UTF8:
-					if (value <= 0x007f) {
-						ret += char(value);
-					} else if (value <= 0x07ff) {
-						ret += char(0xc0 | (value >> 6));
-						ret += char(0x80 | (value & 0x3f));
-					} else if (value <= 0xffff) {
-						ret += char(0xe0 | (value >> 12));
-						ret += char(0x80 | ((value >> 6) & 0x3f));
-						ret += char(0x80 | (value & 0x3f));
-					} else { assert(value <= 0x10ffff);
-						ret += char(0xf0 | (value >> 18));
-						ret += char(0x80 | ((value >> 12) & 0x3f));
-						ret += char(0x80 | ((value >> 6) & 0x3f));
-						ret += char(0x80 | (value & 0x3f));
-					}
+					append_utf8(&ret, value);
 				} else {
 					throw std::runtime_error(std::string("parse error: invalid escape '\\") + c + "'.");
 				}
@@ -183,10 +419,7 @@ value parse(std::istream &from) {
 	//-------------------
 	//parsing:
 
-	std::shared_ptr< sejp::parsed > parsed = std::make_shared< sejp::parsed >();
-
-	value root = value(parsed, -1U);
-	std::vector< uint32_t > parents; //containing maps/arrays
+	Builder builder;
 
 	//overall parsing idea:
 	//value: (target is empty)
@@ -210,7 +443,7 @@ value parse(std::istream &from) {
 	//   'n' -> null ("null")
 	//   finish target
 
-	while (root.index == -1U || !parents.empty()) {
+	while (!builder.done()) {
 		skip_wsp();
 		char c = read_char(); //first character of value
 
@@ -218,15 +451,14 @@ value parse(std::istream &from) {
 		value *target = nullptr;
 
 		//figure out which value to fill in:
-		if (parents.empty()) {
-			target = &root;
-		} else if ((parents.back() & TypeBits) == Object) {
+		if (builder.open.empty()) {
+			target = &builder.root;
+		} else if (builder.in_object()) {
 			if (c == '}') {
-				parents.pop_back();
+				builder.end_container();
 				continue;
 			}
-			std::map< std::string, value > &map = parsed->objects.at( parents.back() & IndexBits ).value();
-			if (!map.empty()) {
+			if (!builder.container_empty()) {
 				//consume comma between entries:
 				if (c != ',') throw std::runtime_error("parse error: expected ',' between object members.");
 				skip_wsp();
@@ -239,22 +471,19 @@ value parse(std::istream &from) {
 			if (c != ':') throw std::runtime_error("parse error: expecting ':' after value.");
 			skip_wsp();
 			c = read_char(); //actual first character of value
-			auto ret = map.insert_or_assign(key, value(parsed, -1U));
-			target = &ret.first->second;
+			target = builder.member_slot(builder.data->arena.store(key));
 			//(fall through to value-getting code)
-		} else if ((parents.back() & TypeBits) == Array) {
+		} else { assert(builder.in_array());
 			if (c == ']') {
-				parents.pop_back();
+				builder.end_container();
 				continue;
 			}
-			std::vector< value > &array = parsed->arrays.at( parents.back() & IndexBits ).value();
-			if (!array.empty()) {
+			if (!builder.container_empty()) {
 				if (c != ',') throw std::runtime_error(std::string("parse error: expected ',' between array entries; got '") + c + "'.");
 				skip_wsp();
 				c = read_char(); //actual first character of value
 			}
-			array.emplace_back(parsed, -1U);
-			target = &array.back();
+			target = builder.element_slot();
 			//(fall through to value-getting code)
 		}
 
@@ -262,25 +491,15 @@ value parse(std::istream &from) {
 		assert(target && (target->index & TypeBits) == Empty);
 
 		if        (c == '{') { //object
-			if (uint32_t(parsed->objects.size()) & ~IndexBits) throw std::runtime_error("parser error: too many objects.");
-			target->index = Object | uint32_t(parsed->objects.size());
-			parents.emplace_back(target->index);
-			parsed->objects.emplace_back(std::in_place);
+			builder.begin_object(target);
 			continue;
 		} else if (c == '[') { //array
-			if (uint32_t(parsed->arrays.size()) & ~IndexBits) throw std::runtime_error("parser error: too many arrays.");
-			target->index = Array | uint32_t(parsed->arrays.size());
-			parents.emplace_back(target->index);
-			parsed->arrays.emplace_back(std::in_place);
+			builder.begin_array(target);
 			continue;
 		} else if (c == '"') { //string
-			if (uint32_t(parsed->strings.size()) & ~IndexBits) throw std::runtime_error("parser error: too many strings.");
-			target->index = String | uint32_t(parsed->strings.size());
-			parsed->strings.emplace_back(read_string());
+			builder.set_string(target, builder.data->arena.store(read_string()));
 		} else if (c == '-' || (c >= '0' && c <= '9')) { //number
-			if (uint32_t(parsed->numbers.size()) & ~IndexBits) throw std::runtime_error("parser error: too many numbers.");
-			target->index = Number | uint32_t(parsed->numbers.size());
-			parsed->numbers.emplace_back(read_number(c));
+			builder.set_number(target, read_number(c));
 		} else if (c == 't') { //true
 			read_exactly("rue");
 			target->index = True;
@@ -293,87 +512,1108 @@ value parse(std::istream &from) {
 		} else {
 			throw std::runtime_error(std::string("parse error: value cannot start with '") + c + "'.");
 		}
+
+		//scalars must be followed by whitespace, a structural, or the end of the input:
+		// (matching the buffer parser, which indexes anything else as the start of another scalar)
+		std::istream::int_type p = from.peek();
+		if (p != std::iostream::traits_type::eof()
+		 && p != ' ' && p != '\t' && p != '\n' && p != '\r'
+		 && p != '{' && p != '}' && p != '[' && p != ']' && p != ':' && p != ',' && p != '"') {
+			throw unexpected_after_value(char(p));
+		}
 	}
 
 	skip_wsp();
 
-	if (from.peek() != std::iostream::traits_type::eof()) throw std::runtime_error("parse error: trailing junk.");
+	if (from.peek() != std::iostream::traits_type::eof()) throw trailing_junk();
+
+	return builder.finish();
+}
+
+//-------------------------------------------
+//buffer-based parsing happens in two stages (after the simdjson design):
+//
+// stage 1 classifies the input 64 bytes at a time and records the offset of:
+//   - every structural character ('{', '}', '[', ']', ':', ',') outside of a string,
+//   - every (unescaped) quote, so strings are delimited by consecutive entries,
+//   - the first character of every other scalar (numbers, true, false, null).
+//
+// stage 2 is the tree builder; it walks the structural index instead of the raw
+// bytes, so never has to skip whitespace or scan strings one character at a time.
+
+namespace {
+
+//per-64-byte-block classification, one bit per byte:
+struct BlockMasks {
+	uint64_t quote;
+	uint64_t backslash;
+	uint64_t structural;
+	uint64_t whitespace;
+};
+
+#if defined(__AVX2__)
+
+inline BlockMasks classify(char const *block) {
+	BlockMasks masks{0,0,0,0};
+	for (uint32_t half = 0; half < 2; ++half) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast< __m256i const * >(block + 32 * half));
+		//lowercase bit folds '[' onto '{' and ']' onto '}':
+		__m256i v20 = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+		auto eq = [](__m256i a, char c) { return _mm256_cmpeq_epi8(a, _mm256_set1_epi8(c)); };
+		auto bits = [](__m256i m) { return uint64_t(uint32_t(_mm256_movemask_epi8(m))); };
+		uint32_t shift = 32 * half;
+		masks.quote      |= bits(eq(v, '"')) << shift;
+		masks.backslash  |= bits(eq(v, '\\')) << shift;
+		masks.structural |= bits(_mm256_or_si256(
+			_mm256_or_si256(eq(v20, '{'), eq(v20, '}')),
+			_mm256_or_si256(eq(v, ':'), eq(v, ','))
+		)) << shift;
+		masks.whitespace |= bits(_mm256_or_si256(
+			_mm256_or_si256(eq(v, ' '), eq(v, '\t')),
+			_mm256_or_si256(eq(v, '\n'), eq(v, '\r'))
+		)) << shift;
+	}
+	return masks;
+}
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+inline BlockMasks classify(char const *block) {
+	BlockMasks masks{0,0,0,0};
+	for (uint32_t quarter = 0; quarter < 4; ++quarter) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast< __m128i const * >(block + 16 * quarter));
+		//lowercase bit folds '[' onto '{' and ']' onto '}':
+		__m128i v20 = _mm_or_si128(v, _mm_set1_epi8(0x20));
+		auto eq = [](__m128i a, char c) { return _mm_cmpeq_epi8(a, _mm_set1_epi8(c)); };
+		auto bits = [](__m128i m) { return uint64_t(uint32_t(_mm_movemask_epi8(m))); };
+		uint32_t shift = 16 * quarter;
+		masks.quote      |= bits(eq(v, '"')) << shift;
+		masks.backslash  |= bits(eq(v, '\\')) << shift;
+		masks.structural |= bits(_mm_or_si128(
+			_mm_or_si128(eq(v20, '{'), eq(v20, '}')),
+			_mm_or_si128(eq(v, ':'), eq(v, ','))
+		)) << shift;
+		masks.whitespace |= bits(_mm_or_si128(
+			_mm_or_si128(eq(v, ' '), eq(v, '\t')),
+			_mm_or_si128(eq(v, '\n'), eq(v, '\r'))
+		)) << shift;
+	}
+	return masks;
+}
+
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+
+//NEON has no movemask; weight each lane by its bit and add pairwise:
+inline uint64_t movemask(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3) {
+	static uint8_t const weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t const w = vld1q_u8(weights);
+	uint8x16_t sum01 = vpaddq_u8(vandq_u8(m0, w), vandq_u8(m1, w));
+	uint8x16_t sum23 = vpaddq_u8(vandq_u8(m2, w), vandq_u8(m3, w));
+	uint8x16_t sum = vpaddq_u8(sum01, sum23);
+	sum = vpaddq_u8(sum, sum);
+	return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+
+inline BlockMasks classify(char const *block) {
+	uint8x16_t v[4], v20[4];
+	for (uint32_t i = 0; i < 4; ++i) {
+		v[i] = vld1q_u8(reinterpret_cast< uint8_t const * >(block + 16 * i));
+		//lowercase bit folds '[' onto '{' and ']' onto '}':
+		v20[i] = vorrq_u8(v[i], vdupq_n_u8(0x20));
+	}
+	auto eq = [](uint8x16_t a, char c) { return vceqq_u8(a, vdupq_n_u8(uint8_t(c))); };
+	uint8x16_t quote[4], backslash[4], structural[4], whitespace[4];
+	for (uint32_t i = 0; i < 4; ++i) {
+		quote[i] = eq(v[i], '"');
+		backslash[i] = eq(v[i], '\\');
+		structural[i] = vorrq_u8(vorrq_u8(eq(v20[i], '{'), eq(v20[i], '}')), vorrq_u8(eq(v[i], ':'), eq(v[i], ',')));
+		whitespace[i] = vorrq_u8(vorrq_u8(eq(v[i], ' '), eq(v[i], '\t')), vorrq_u8(eq(v[i], '\n'), eq(v[i], '\r')));
+	}
+	return BlockMasks{
+		.quote = movemask(quote[0], quote[1], quote[2], quote[3]),
+		.backslash = movemask(backslash[0], backslash[1], backslash[2], backslash[3]),
+		.structural = movemask(structural[0], structural[1], structural[2], structural[3]),
+		.whitespace = movemask(whitespace[0], whitespace[1], whitespace[2], whitespace[3]),
+	};
+}
+
+#else
+
+//scalar fallback:
+inline BlockMasks classify(char const *block) {
+	enum : uint8_t { Quote = 1, Backslash = 2, Structural = 4, Whitespace = 8 };
+	static auto const table = [](){
+		std::array< uint8_t, 256 > t{};
+		t[uint8_t('"')] = Quote;
+		t[uint8_t('\\')] = Backslash;
+		for (char c : std::string_view("{}[]:,")) t[uint8_t(c)] = Structural;
+		for (char c : std::string_view(" \t\n\r")) t[uint8_t(c)] = Whitespace;
+		return t;
+	}();
+	BlockMasks masks{0,0,0,0};
+	for (uint32_t i = 0; i < 64; ++i) {
+		uint8_t bits = table[uint8_t(block[i])];
+		masks.quote      |= uint64_t((bits & Quote) != 0) << i;
+		masks.backslash  |= uint64_t((bits & Backslash) != 0) << i;
+		masks.structural |= uint64_t((bits & Structural) != 0) << i;
+		masks.whitespace |= uint64_t((bits & Whitespace) != 0) << i;
+	}
+	return masks;
+}
+
+#endif
+
+//bit i of result is the xor of bits 0..i of x:
+// (i.e., marks the inside of quote-delimited ranges, including the opening quote)
+inline uint64_t prefix_xor(uint64_t x) {
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+//stage 1: build the structural index.
+// a final entry equal to buffer.size() is appended as an end-of-input sentinel.
+//stage 1, a window of blocks at a time:
+// (so stage 2 can consume the index as it is made, rather than holding all of it at once)
+struct StructuralIndexer {
+	std::string_view buffer;
+	uint32_t base = 0; //offset of the next block to scan
+	bool finished = false; //has the end-of-buffer sentinel been recorded?
+
+	//state carried between blocks:
+	bool escape_next = false; //first character of the next block is escaped
+	uint64_t in_string = 0; //all-ones if the previous block ended inside a string
+	uint64_t prev_scalar = 0; //1 if the previous block ended in a scalar character
+
+	explicit StructuralIndexer(std::string_view buffer_) : buffer(buffer_) {
+		if (buffer.size() >= size_t(std::numeric_limits< uint32_t >::max())) throw std::runtime_error("parse error: input is too large (4GB limit).");
+	}
+
+	void scan_block(char const *block, uint32_t block_base, std::vector< uint32_t > *structurals_) {
+		auto &structurals = *structurals_;
+		BlockMasks masks = classify(block);
+
+		//figure out which characters are escaped:
+		// (backslashes are rare in JSON, so just walk them)
+		uint64_t escaped = 0;
+		uint64_t backslash = masks.backslash;
+		if (escape_next) {
+			escaped |= 1;
+			backslash &= ~uint64_t(1);
+			escape_next = false;
+		}
+		while (backslash) {
+			uint32_t i = uint32_t(std::countr_zero(backslash));
+			if (i == 63) {
+				escape_next = true;
+				break;
+			}
+			escaped |= uint64_t(1) << (i + 1);
+			backslash &= ~(uint64_t(3) << i); //(an escaped backslash does not escape anything)
+		}
+
+		uint64_t quote = masks.quote & ~escaped;
+		uint64_t inside = prefix_xor(quote) ^ in_string;
+		in_string = uint64_t(int64_t(inside) >> 63);
+
+		//scalars are runs of anything that isn't whitespace or structural; record where each run starts:
+		uint64_t scalar = ~(masks.structural | masks.whitespace);
+		uint64_t scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+		prev_scalar = scalar >> 63;
+
+		uint64_t bits = ((masks.structural | scalar_start) & ~inside) | quote;
+
+		size_t at = structurals.size();
+		structurals.resize(at + size_t(std::popcount(bits)));
+		while (bits) {
+			structurals[at++] = block_base + uint32_t(std::countr_zero(bits));
+			bits &= bits - 1;
+		}
+	}
+
+	//append the offsets found in (up to) the next 'blocks' blocks to *structurals;
+	// after the last block, also appends the buffer's length as an end-of-input sentinel:
+	void scan(uint32_t blocks, std::vector< uint32_t > *structurals) {
+		assert(!finished);
+		uint32_t length = uint32_t(buffer.size());
+		for (; blocks > 0 && base + 64 <= length; --blocks, base += 64) {
+			scan_block(buffer.data() + base, base, structurals);
+		}
+		if (blocks == 0) return;
+
+		if (base < length) {
+			//pad the last partial block with whitespace:
+			char block[64];
+			std::memset(block, ' ', 64);
+			std::memcpy(block, buffer.data() + base, length - base);
+			scan_block(block, base, structurals);
+			base = length;
+		}
+
+		if (in_string) throw std::runtime_error("parse error: unexpected EOF in string.");
+
+		structurals->emplace_back(length);
+		finished = true;
+	}
+};
+
+//stage 1 all at once:
+std::vector< uint32_t > find_structurals(std::string_view buffer) {
+	StructuralIndexer indexer(buffer);
+
+	std::vector< uint32_t > structurals;
+	//(a rough guess: JSON tends to have a structural every few bytes)
+	structurals.reserve(buffer.size() / 4 + 2);
+
+	indexer.scan(std::numeric_limits< uint32_t >::max(), &structurals);
+	assert(indexer.finished);
+	return structurals;
+}
+
+//stage 1 a window at a time, for the streaming stage 2 below:
+struct StructuralCursor {
+	static constexpr uint32_t WindowBlocks = 1024; //(64k of input per window)
+
+	StructuralIndexer indexer;
+	std::vector< uint32_t > window;
+	size_t next = 0; //next entry in window
+
+	explicit StructuralCursor(std::string_view buffer) : indexer(buffer) {
+		//(same rough guess as in find_structurals)
+		window.reserve(std::min< size_t >(buffer.size(), WindowBlocks * 64) / 4 + 2);
+	}
+
+	//offset of the next structural (indexing more of the buffer if needed):
+	uint32_t peek() {
+		while (next == window.size()) {
+			assert(!indexer.finished); //(stage 2 never reads past the sentinel)
+			window.clear();
+			next = 0;
+			indexer.scan(WindowBlocks, &window);
+		}
+		return window[next];
+	}
+};
+
+//convert the characters between a string's quotes, handling escapes:
+std::string unescape(char const *begin, char const *end) {
+	std::string ret;
+	ret.reserve(size_t(end - begin));
+	for (char const *at = begin; at < end; ) {
+		//copy runs of plain old boring characters all at once:
+		char const *run = at;
+		while (at < end && *at != '\\') ++at;
+		ret.append(run, at);
+		if (at == end) break;
+
+		//handle escapes:
+		++at;
+		//(stage 1 guarantees the closing quote isn't escaped, so there is always a character here)
+		assert(at < end);
+		char c = *at++;
+		if      (c == '\\' || c == '/' || c == '"') ret += c;
+		else if (c == 'b') ret += '\b';
+		else if (c == 'f') ret += '\f';
+		else if (c == 'n') ret += '\n';
+		else if (c == 'r') ret += '\r';
+		else if (c == 't') ret += '\t';
+		else if (c == 'u') {
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < 4; ++i) {
+				value <<= 4;
+				if (at == end) throw std::runtime_error("parse error: string ended in \\uNNNN escape.");
+				c = *at++;
+				if      ('0' <= c && c <= '9') value += (c - '0');
+				else if ('a' <= c && c <= 'f') value += (c - 'a') + 10;
+				else if ('A' <= c && c <= 'F') value += (c - 'A') + 10;
+				else throw std::runtime_error(std::string("parse error: invalid character '") + c + "' in \\uNNNN escape.");
+			}
+			assert(value <= 0xffff);
+			//TODO: handle surrogate pairs!
+			append_utf8(&ret, value);
+		} else {
+			throw std::runtime_error(std::string("parse error: invalid escape '\\") + c + "'.");
+		}
+	}
+	return ret;
+}
+
+//scan a number starting at 'begin' (bounded by 'end'), return where it stops:
+char const *scan_number(char const *begin, char const *end) {
+	char const *at = begin;
+
+	auto read_char = [&at,end]() -> char {
+		if (at == end) throw std::runtime_error("parse error: unexpected EOF.");
+		return *at++;
+	};
+
+	auto digits = [&at,end]() {
+		while (at < end && '0' <= *at && *at <= '9') ++at;
+	};
+
+	char first = read_char();
+	if (first == '-') {
+		//advance to first digit:
+		first = read_char();
+	}
+
+	if (first == '0') {
+		//proceed to fraction
+	} else if ('1' <= first && first <= '9') {
+		//might be more digits
+		digits();
+	} else {
+		throw std::runtime_error(std::string("parse error: unexpected '") + first + "' in number.");
+	}
+
+	//fraction:
+	if (at < end && *at == '.') {
+		++at;
+		char c = read_char();
+		if (!('0' <= c && c <= '9')) throw std::runtime_error(std::string("parse error: wanted fraction digits, got '") + c + "'.");
+		digits();
+	}
+
+	//exponent:
+	if (at < end && (*at == 'E' || *at == 'e')) {
+		++at;
+		if (at < end && (*at == '-' || *at == '+')) ++at;
+		char c = read_char();
+		if (!('0' <= c && c <= '9')) throw std::runtime_error(std::string("parse error: wanted exponent digits, got '") + c + "'.");
+		digits();
+	}
+
+	return at;
+}
+
+double convert_number(char const *begin, char const *end) {
+	double val = 0.0;
+	#ifdef __APPLE__
+	//parse in the default locale (see note in stream version above)
+	std::istringstream iss(std::string(begin, end));
+	iss.imbue(std::locale("C"));
+	iss >> val;
+	#else
+	auto [ptr, ec] = std::from_chars(begin, end, val);
+	if (ec == std::errc::result_out_of_range) {
+		//saturate like strtod does: a negative exponent underflowed to zero, otherwise overflowed to infinity
+		char const *exponent = std::find_if(begin, end, [](char c){ return c == 'e' || c == 'E'; });
+		bool underflow = (exponent + 1 < end && exponent[1] == '-');
+		val = (underflow ? 0.0 : std::numeric_limits< double >::infinity());
+		if (*begin == '-') val = -val;
+	} else if (ec != std::errc() || ptr != end) {
+		throw std::runtime_error("parse error: failed to convert number '" + std::string(begin, end) + "'.");
+	}
+	#endif
+	return val;
+}
+
+} //namespace
+
+//buffer-based version of the parser above:
+// same grammar, but stage 2 walks the structural index (a window at a time) and reports
+// what it finds to an Events object (which, e.g., builds a document; see BuildEvents below).
+//
+//Events objects have these functions:
+//  on_object_begin(), on_key(std::string_view key, bool escaped), on_object_end(),
+//  on_array_begin(), on_array_end(),
+//  on_string(std::string_view str, bool escaped), on_number(double), on_bool(bool), on_null()
+//where 'escaped' strings had escapes, so point to a temporary copy instead of into the buffer.
+template< typename Events >
+static void parse_events(std::string_view buffer, Events &events) {
+	StructuralCursor structurals(buffer);
+
+	char const *const begin = buffer.data();
+	char const *const end = buffer.data() + buffer.size();
+
+	//helpers to walk the index:
+
+	//returns the position of the next structural (or scalar start):
+	auto read_structural = [&]() -> char const * {
+		char const *at = begin + structurals.peek();
+		if (at == end) throw std::runtime_error("parse error: unexpected EOF.");
+		++structurals.next;
+		return at;
+	};
+
+	auto is_wsp = [](char c) {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	};
+
+	//scalars (and strings) must be followed by whitespace or the next structural:
+	// (anything else would have been indexed as the start of another scalar)
+	auto check_scalar_end = [&](char const *at) {
+		if (at != begin + structurals.peek() && !is_wsp(*at)) {
+			throw unexpected_after_value(*at);
+		}
+	};
+
+	auto read_exactly = [&](char const *at, std::string_view const &expect) {
+		for (auto e : expect) {
+			if (at == end) throw std::runtime_error("parse error: unexpected EOF.");
+			char c = *at++;
+			if (c != e) throw std::runtime_error(std::string("parse error: expected '") + e + "', got '" + c + "'.");
+		}
+		check_scalar_end(at);
+	};
+
+	//NOTE: expects 'open' to point to the opening quote
+	//NOTE: returns a view of the buffer, or (if the string had escapes; sets *escaped) of scratch
+	std::string scratch;
+	auto read_string = [&](char const *open, bool *escaped) -> std::string_view {
+		assert(*open == '"');
+		char const *close = read_structural();
+		assert(*close == '"'); //(guaranteed by stage 1)
+		check_scalar_end(close + 1);
+		char const *first = open + 1;
+		if (std::memchr(first, '\\', size_t(close - first)) == nullptr) {
+			*escaped = false;
+			return std::string_view(first, size_t(close - first));
+		} else {
+			*escaped = true;
+			scratch = unescape(first, close);
+			return scratch;
+		}
+	};
+
+	auto read_number = [&](char const *at) -> double {
+		char const *stop = scan_number(at, end);
+		check_scalar_end(stop);
+		return convert_number(at, stop);
+	};
+
+
+	//-------------------
+	//parsing (same state machine as the stream version):
+
+	std::vector< char > open; //containing maps/arrays, as '{' or '['
+	bool first = true; //is the next entry the first in its container?
+	bool started = false; //has the root value started?
+
+	while (!(started && open.empty())) {
+		char const *at = read_structural(); //first character of value
+		char c = *at;
+
+		//handle container ends and separators:
+		if (open.empty()) {
+			started = true;
+		} else if (open.back() == '{') {
+			if (c == '}') {
+				open.pop_back();
+				first = false;
+				events.on_object_end();
+				continue;
+			}
+			if (!first) {
+				//consume comma between entries:
+				if (c != ',') throw std::runtime_error("parse error: expected ',' between object members.");
+				at = read_structural();
+				c = *at;
+			}
+			if (c != '"') throw std::runtime_error("parse error: expecting '\"' at start of key.");
+			bool escaped;
+			std::string_view key = read_string(at, &escaped);
+			c = *read_structural();
+			if (c != ':') throw std::runtime_error("parse error: expecting ':' after value.");
+			at = read_structural(); //actual first character of value
+			c = *at;
+			events.on_key(key, escaped);
+			//(fall through to value-getting code)
+		} else { assert(open.back() == '[');
+			if (c == ']') {
+				open.pop_back();
+				first = false;
+				events.on_array_end();
+				continue;
+			}
+			if (!first) {
+				if (c != ',') throw std::runtime_error(std::string("parse error: expected ',' between array entries; got '") + c + "'.");
+				at = read_structural(); //actual first character of value
+				c = *at;
+			}
+			//(fall through to value-getting code)
+		}
+
+		//actually read the value:
+		first = false;
+
+		if        (c == '{') { //object
+			open.emplace_back('{');
+			first = true;
+			events.on_object_begin();
+		} else if (c == '[') { //array
+			open.emplace_back('[');
+			first = true;
+			events.on_array_begin();
+		} else if (c == '"') { //string
+			bool escaped;
+			std::string_view str = read_string(at, &escaped);
+			events.on_string(str, escaped);
+		} else if (c == '-' || (c >= '0' && c <= '9')) { //number
+			events.on_number(read_number(at));
+		} else if (c == 't') { //true
+			read_exactly(at, "true");
+			events.on_bool(true);
+		} else if (c == 'f') { //false
+			read_exactly(at, "false");
+			events.on_bool(false);
+		} else if (c == 'n') { //null
+			read_exactly(at, "null");
+			events.on_null();
+		} else {
+			throw std::runtime_error(std::string("parse error: value cannot start with '") + c + "'.");
+		}
+	}
+
+	if (begin + structurals.peek() != end) throw trailing_junk();
+}
+
+//Events that build a document:
+struct BuildEvents {
+	Builder builder;
+	Strings strings = Strings::Copy;
+	std::string_view key; //key for the next object member
+
+	//strings that aren't views of the (retained) source need their own storage:
+	std::string_view keep(std::string_view const &str, bool escaped) {
+		if (strings == Strings::Reference && !escaped) return str;
+		else return builder.data->arena.store(str);
+	}
+
+	//slot for the value that is starting:
+	value *slot() {
+		if (builder.open.empty()) {
+			if (builder.root.index != -1U) throw std::runtime_error("parser error: more than one root value.");
+			return &builder.root;
+		} else if (builder.in_object()) {
+			return builder.member_slot(key);
+		} else {
+			return builder.element_slot();
+		}
+	}
+
+	void on_object_begin() { builder.begin_object(slot()); }
+	void on_key(std::string_view const &key_, bool escaped) {
+		if (!builder.in_object()) throw std::runtime_error("parser error: key outside of object.");
+		key = keep(key_, escaped);
+	}
+	void on_object_end() {
+		if (!builder.in_object()) throw std::runtime_error("parser error: end of object outside of object.");
+		builder.end_container();
+	}
+	void on_array_begin() { builder.begin_array(slot()); }
+	void on_array_end() {
+		if (!builder.in_array()) throw std::runtime_error("parser error: end of array outside of array.");
+		builder.end_container();
+	}
+	void on_string(std::string_view const &str, bool escaped) { builder.set_string(slot(), keep(str, escaped)); }
+	void on_number(double number) { builder.set_number(slot(), number); }
+	void on_bool(bool b) { slot()->index = (b ? True : False); }
+	void on_null() { slot()->index = Null; }
+};
+
+//Events that pass through to a (public) handler:
+struct HandlerEvents {
+	handler &to;
 
-	return root;
+	void on_object_begin() { to.on_object_begin(); }
+	void on_key(std::string_view const &key, bool) { to.on_key(key); }
+	void on_object_end() { to.on_object_end(); }
+	void on_array_begin() { to.on_array_begin(); }
+	void on_array_end() { to.on_array_end(); }
+	void on_string(std::string_view const &str, bool) { to.on_string(str); }
+	void on_number(double number) { to.on_number(number); }
+	void on_bool(bool b) { to.on_bool(b); }
+	void on_null() { to.on_null(); }
+};
+
+document parse(std::string_view buffer, Strings strings) {
+	BuildEvents events;
+	events.strings = strings;
+	if (strings == Strings::Reference) {
+		events.builder.data->source = std::string(buffer);
+		buffer = events.builder.data->source;
+	}
+	parse_events(buffer, events);
+	return events.builder.finish();
+}
+
+void parse(std::string_view buffer, handler &to) {
+	HandlerEvents events{ to };
+	parse_events(buffer, events);
 }
 
 //------------------------------------------
 
+std::optional< std::vector< std::string_view > > split_array(std::string_view buffer) {
+	StructuralCursor structurals(buffer);
+
+	char const *const begin = buffer.data();
+	char const *const end = buffer.data() + buffer.size();
+
+	//returns the position of the next structural (or scalar start):
+	auto read_structural = [&]() -> char const * {
+		char const *at = begin + structurals.peek();
+		if (at == end) throw std::runtime_error("parse error: unexpected EOF.");
+		++structurals.next;
+		return at;
+	};
+
+	auto is_wsp = [](char c) {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	};
+
+	if (*read_structural() != '[') return std::nullopt;
+
+	std::vector< std::string_view > elements;
+
+	char const *at = read_structural();
+	if (*at == ']') at = nullptr; //(empty array)
+	while (at) {
+		//find the end of the element starting at 'at':
+		char const *after; //one past the element's last character
+		if (*at == '{' || *at == '[') {
+			//skip to the matching close:
+			// (quotes are indexed in pairs and strings can't contain structurals, so just count)
+			uint32_t depth = 1;
+			do {
+				char c = *read_structural();
+				if (c == '{' || c == '[') depth += 1;
+				else if (c == '}' || c == ']') depth -= 1;
+			} while (depth > 0);
+			after = begin + structurals.window[structurals.next - 1] + 1;
+		} else if (*at == '"') {
+			after = read_structural() + 1;
+		} else {
+			//scalars run up to whitespace or the next structural:
+			after = at;
+			while (after < begin + structurals.peek() && !is_wsp(*after)) ++after;
+		}
+		elements.emplace_back(at, size_t(after - at));
+
+		//only whitespace may come before the next structural:
+		for (char const *c = after; c < begin + structurals.peek(); ++c) {
+			if (!is_wsp(*c)) throw unexpected_after_value(*c);
+		}
+
+		char c = *read_structural();
+		if (c == ']') break;
+		if (c != ',') throw std::runtime_error(std::string("parse error: expected ',' between array entries; got '") + c + "'.");
+		at = read_structural();
+	}
+
+	if (begin + structurals.peek() != end) throw trailing_junk();
+
+	return elements;
+}
+
+//------------------------------------------
+//document_builder just wraps BuildEvents:
+
+document_builder::document_builder() : events(std::make_unique< BuildEvents >()) { }
+document_builder::~document_builder() = default;
+
+void document_builder::on_object_begin() { events->on_object_begin(); }
+void document_builder::on_key(std::string_view key) { events->on_key(key, true); }
+void document_builder::on_object_end() { events->on_object_end(); }
+void document_builder::on_array_begin() { events->on_array_begin(); }
+void document_builder::on_array_end() { events->on_array_end(); }
+void document_builder::on_string(std::string_view str) { events->on_string(str, true); }
+void document_builder::on_number(double number) { events->on_number(number); }
+void document_builder::on_bool(bool b) { events->on_bool(b); }
+void document_builder::on_null() { events->on_null(); }
+
+bool document_builder::done() const {
+	return events->builder.done();
+}
+
+document document_builder::finish() {
+	if (!events->builder.done()) throw std::runtime_error("sejp::document_builder::finish: document is not complete.");
+	document ret = events->builder.finish();
+
+	//build the next document in the storage of the one before this, if nothing refers to it any more:
+	std::shared_ptr< parsed > storage;
+	if (spare && spare.use_count() == 1) {
+		spare->clear();
+		storage = std::move(spare);
+	}
+	spare = events->builder.data;
+	events->builder.restart(std::move(storage));
+	events->key = std::string_view();
+
+	return ret;
+}
+
+//------------------------------------------
+//lazy parsing:
+// the index pass below checks the whole grammar (so parse errors are still reported up front),
+// but only records where each container starts and ends; entries are decoded by lazy_decode
+// on first access, and numbers are converted each time as_number() is called.
+
+//NOTE: expects data->source to hold the text to parse
+static document parse_lazy_source(std::shared_ptr< parsed > const &data) {
+	data->lazy = true;
+	data->structurals = find_structurals(data->source);
+	if (data->structurals.size() > IndexBits) throw std::runtime_error("parser error: too many values.");
+
+	std::vector< uint32_t > const &structurals = data->structurals;
+	char const *const begin = data->source.data();
+	char const *const end = data->source.data() + data->source.size();
+
+	size_t next = 0; //next entry in structurals
 
-std::optional< std::string > const &value::as_string() const {
-	static std::optional< std::string > const empty;
+	//returns the position of the next structural (or scalar start):
+	auto read_structural = [&]() -> char const * {
+		assert(next < structurals.size());
+		char const *at = begin + structurals[next];
+		if (at == end) throw std::runtime_error("parse error: unexpected EOF.");
+		++next;
+		return at;
+	};
+
+	auto is_wsp = [](char c) {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	};
+
+	auto check_scalar_end = [&](char const *at) {
+		assert(next < structurals.size());
+		if (at != begin + structurals[next] && !is_wsp(*at)) {
+			throw unexpected_after_value(*at);
+		}
+	};
+
+	auto read_exactly = [&](char const *at, std::string_view const &expect) {
+		for (auto e : expect) {
+			if (at == end) throw std::runtime_error("parse error: unexpected EOF.");
+			char c = *at++;
+			if (c != e) throw std::runtime_error(std::string("parse error: expected '") + e + "', got '" + c + "'.");
+		}
+		check_scalar_end(at);
+	};
+
+	//strings are left in place, except that ones with escapes are decoded now (they're rare):
+	auto skip_string = [&](char const *open) {
+		assert(*open == '"');
+		uint32_t index = uint32_t(next - 1);
+		char const *close = read_structural();
+		assert(*close == '"'); //(guaranteed by stage 1)
+		check_scalar_end(close + 1);
+		char const *first = open + 1;
+		if (std::memchr(first, '\\', size_t(close - first)) != nullptr) {
+			data->unescaped.emplace(index, data->decoded.store(unescape(first, close)));
+		}
+	};
+
+	//-------------------
+	//index pass (same state machine as the other parsers, minus the tree building):
+
+	std::vector< uint32_t > open; //containing maps/arrays (by container number)
+
+	while (!(data->root != -1U && open.empty())) {
+		char const *at = read_structural(); //first character of value
+		char c = *at;
+
+		bool in_object = false;
+		if (!open.empty()) {
+			parsed::LazyContainer &container = data->containers[open.back()];
+			in_object = (begin[structurals[container.open]] == '{');
+			if (c == (in_object ? '}' : ']')) {
+				container.close = uint32_t(next - 1);
+				container.end = uint32_t(data->containers.size());
+				open.pop_back();
+				continue;
+			}
+			if (container.count != 0) {
+				//consume comma between entries:
+				if (c != ',') {
+					if (in_object) throw std::runtime_error("parse error: expected ',' between object members.");
+					else throw std::runtime_error(std::string("parse error: expected ',' between array entries; got '") + c + "'.");
+				}
+				at = read_structural();
+				c = *at;
+			}
+			if (in_object) {
+				if (c != '"') throw std::runtime_error("parse error: expecting '\"' at start of key.");
+				skip_string(at);
+				c = *read_structural();
+				if (c != ':') throw std::runtime_error("parse error: expecting ':' after value.");
+				at = read_structural(); //actual first character of value
+				c = *at;
+			}
+			if (container.count == IndexBits) throw std::runtime_error("parser error: too many values.");
+			container.count += 1;
+		}
+
+		//the value's index, as seen by value::index:
+		uint32_t index = -1U;
+		uint32_t position = uint32_t(next - 1); //structural index of the value's first character
+
+		if (c == '{' || c == '[') { //object or array
+			if (data->containers.size() >= IndexBits) throw std::runtime_error("parser error: too many containers.");
+			index = (c == '{' ? Object : Array) | uint32_t(data->containers.size());
+			open.emplace_back(uint32_t(data->containers.size()));
+			data->containers.emplace_back(parsed::LazyContainer{
+				.open = position, .close = 0, .end = 0, .count = 0,
+				.decoded = false, .entries = nullptr
+			});
+		} else if (c == '"') { //string
+			skip_string(at);
+			index = String | position;
+		} else if (c == '-' || (c >= '0' && c <= '9')) { //number
+			check_scalar_end(scan_number(at, end));
+			index = Number | position;
+		} else if (c == 't') { //true
+			read_exactly(at, "true");
+			index = True;
+		} else if (c == 'f') { //false
+			read_exactly(at, "false");
+			index = False;
+		} else if (c == 'n') { //null
+			read_exactly(at, "null");
+			index = Null;
+		} else {
+			throw std::runtime_error(std::string("parse error: value cannot start with '") + c + "'.");
+		}
+
+		if (data->root == -1U) data->root = index;
+	}
+
+	if (begin + structurals[next] != end) throw trailing_junk();
+
+	return document{ .data = data };
+}
+
+document parse_lazy(std::string_view buffer) {
+	std::shared_ptr< parsed > data = std::make_shared< parsed >();
+	data->source = std::string(buffer);
+	return parse_lazy_source(data);
+}
+
+//view of a string in a lazy document, given the structural index of its opening quote:
+static std::string_view lazy_string(parsed const &data, uint32_t position) {
+	if (!data.unescaped.empty()) {
+		auto f = data.unescaped.find(position);
+		if (f != data.unescaped.end()) return f->second;
+	}
+	uint32_t first = data.structurals[position] + 1;
+	uint32_t close = data.structurals[position + 1];
+	return std::string_view(data.source.data() + first, close - first);
+}
+
+//decode a lazy container's entries (the first time it is accessed):
+static parsed::LazyContainer const &lazy_decode(parsed const &data, uint32_t number) {
+	parsed::LazyContainer &container = data.containers[number];
+	if (container.decoded) return container;
+
+	char const *source = data.source.data();
+	uint32_t at = container.open + 1; //structural index of the next entry
+	uint32_t nested = number + 1; //number of the next nested container
+
+	//index of the value starting at structural 'at', which then moves past it:
+	// (the index pass has already checked the grammar, so this can just count)
+	auto read_value = [&]() -> uint32_t {
+		char c = source[data.structurals[at]];
+		if (c == '{' || c == '[') {
+			uint32_t index = (c == '{' ? Object : Array) | nested;
+			at = data.containers[nested].close + 1;
+			nested = data.containers[nested].end;
+			return index;
+		} else if (c == '"') {
+			at += 2;
+			return String | (at - 2);
+		} else if (c == 't') {
+			at += 1;
+			return True;
+		} else if (c == 'f') {
+			at += 1;
+			return False;
+		} else if (c == 'n') {
+			at += 1;
+			return Null;
+		} else {
+			at += 1;
+			return Number | (at - 1);
+		}
+	};
+
+	if (source[data.structurals[container.open]] == '{') {
+		object_entry *entries = static_cast< object_entry * >(data.decoded.allocate(sizeof(object_entry) * container.count, alignof(object_entry)));
+		for (uint32_t i = 0; i < container.count; ++i) {
+			if (i != 0) at += 1; //skip ','
+			std::string_view key = lazy_string(data, at);
+			at += 3; //skip key and ':'
+			uint32_t index = read_value();
+			new (entries + i) object_entry{ key, index };
+		}
+		//sort for binary search; for duplicate keys the last one wins:
+		std::stable_sort(entries, entries + container.count, [](object_entry const &a, object_entry const &b) {
+			return a.key < b.key;
+		});
+		uint32_t kept = 0;
+		for (uint32_t i = 0; i < container.count; ++i) {
+			if (i + 1 < container.count && entries[i + 1].key == entries[i].key) continue;
+			entries[kept++] = entries[i];
+		}
+		container.count = kept;
+		container.entries = entries;
+	} else {
+		uint32_t *entries = static_cast< uint32_t * >(data.decoded.allocate(sizeof(uint32_t) * container.count, alignof(uint32_t)));
+		for (uint32_t i = 0; i < container.count; ++i) {
+			if (i != 0) at += 1; //skip ','
+			entries[i] = read_value();
+		}
+		container.entries = entries;
+	}
+	assert(at == container.close);
+	container.decoded = true;
+	return container;
+}
+
+//------------------------------------------
+
+
+std::optional< std::string_view > value::as_string() const {
 	if ((index & TypeBits) == String) {
+		if (data->lazy) return lazy_string(*data, index & IndexBits);
 		return data->strings[index & IndexBits];
 	} else {
-		return empty;
+		return std::nullopt;
 	}
 }
 
-std::optional< double > const &value::as_number() const {
-	static std::optional< double > const empty;
+std::optional< double > value::as_number() const {
 	if ((index & TypeBits) == Number) {
+		if (data->lazy) {
+			char const *begin = data->source.data() + data->structurals[index & IndexBits];
+			return convert_number(begin, scan_number(begin, data->source.data() + data->source.size()));
+		}
 		return data->numbers[index & IndexBits];
 	} else {
-		return empty;
+		return std::nullopt;
 	}
 }
 
-std::optional< bool > const &value::as_bool() const {
-	static std::optional< bool > const true_value(true);
-	static std::optional< bool > const false_value(false);
-	static std::optional< bool > const empty;
+std::optional< bool > value::as_bool() const {
 	if ((index & TypeBits) == True) {
-		return true_value;
+		return true;
 	} else if ((index & TypeBits) == False) {
-		return false_value;
+		return false;
 	} else {
-		return empty;
+		return std::nullopt;
 	}
 }
 
-std::optional< nullptr_t > const &value::as_null() const {
-	static std::optional< nullptr_t > const null_value(nullptr);
-	static std::optional< nullptr_t > const empty;
+std::optional< std::nullptr_t > value::as_null() const {
 	if ((index & TypeBits) == Null) {
-		return null_value;
+		return nullptr;
 	} else {
-		return empty;
+		return std::nullopt;
 	}
 }
 
-std::optional< std::vector< value > > const &value::as_array() const {
-	static std::optional< std::vector< value > > const empty;
+std::optional< array_view > value::as_array() const {
 	if ((index & TypeBits) == Array) {
-		return data->arrays[index & IndexBits];
+		if (data->lazy) {
+			parsed::LazyContainer const &container = lazy_decode(*data, index & IndexBits);
+			uint32_t const *entries = static_cast< uint32_t const * >(container.entries);
+			return array_view{ .data = data, .begin_ = entries, .end_ = entries + container.count };
+		}
+		parsed::Range const &range = data->arrays[index & IndexBits];
+		return array_view{
+			.data = data,
+			.begin_ = data->elements.data() + range.begin,
+			.end_ = data->elements.data() + range.end,
+		};
 	} else {
-		return empty;
+		return std::nullopt;
 	}
 }
 
-std::optional< std::map< std::string, value > > const &value::as_object() const {
-	static std::optional< std::map< std::string, value > > const empty;
+std::optional< object_view > value::as_object() const {
 	if ((index & TypeBits) == Object) {
-		return data->objects[index & IndexBits];
+		if (data->lazy) {
+			parsed::LazyContainer const &container = lazy_decode(*data, index & IndexBits);
+			object_entry const *entries = static_cast< object_entry const * >(container.entries);
+			return object_view{ .data = data, .begin_ = entries, .end_ = entries + container.count };
+		}
+		parsed::Range const &range = data->objects[index & IndexBits];
+		return object_view{
+			.data = data,
+			.begin_ = data->members.data() + range.begin,
+			.end_ = data->members.data() + range.end,
+		};
 	} else {
-		return empty;
+		return std::nullopt;
 	}
 }
 
+value array_view::at(size_t i) const {
+	if (i >= size()) throw std::out_of_range("sejp::array_view::at: index " + std::to_string(i) + " out of range.");
+	return value(data, begin_[i]);
+}
+
+object_view::iterator object_view::find(std::string_view key) const {
+	object_entry const *f = std::lower_bound(begin_, end_, key, [](object_entry const &e, std::string_view const &k) {
+		return e.key < k;
+	});
+	if (f != end_ && f->key == key) return iterator{data, f};
+	else return end();
+}
+
+value object_view::at(std::string_view key) const {
+	object_entry const *f = find(key).at;
+	if (f == end_) throw std::out_of_range("sejp::object_view::at: no member \"" + std::string(key) + "\".");
+	return value(data, f->index);
+}
+
+value document::root() const {
+	return value(data.get(), data->root);
+}
+
 //-------------------------------
 
-value load(std::string const &filename) {
+std::string read_file(std::string const &filename) {
 	std::ifstream in(filename, std::ios::binary);
-	return parse(in);
+	if (!in) throw std::runtime_error("failed to open '" + filename + "' for reading.");
+
+	in.seekg(0, std::ios::end);
+	std::streamoff size = in.tellg();
+	if (size < 0) throw std::runtime_error("failed to get size of '" + filename + "'.");
+	in.seekg(0, std::ios::beg);
+
+	std::string buffer(size_t(size), '\0');
+	if (!in.read(buffer.data(), size)) throw std::runtime_error("failed to read '" + filename + "'.");
+	return buffer;
+}
+
+document load(std::string const &filename, Strings strings) {
+	std::string buffer = read_file(filename);
+
+	BuildEvents events;
+	events.strings = strings;
+	if (strings == Strings::Reference) {
+		//hand the file contents to the document rather than copying them:
+		events.builder.data->source = std::move(buffer);
+		parse_events(events.builder.data->source, events);
+	} else {
+		parse_events(buffer, events);
+	}
+	return events.builder.finish();
+}
+
+void load(std::string const &filename, handler &to) {
+	std::string buffer = read_file(filename);
+	parse(buffer, to);
 }
 
-value parse(std::string const &string) {
-	std::istringstream in(string, std::ios::binary);
-	return parse(in);
+document load_lazy(std::string const &filename) {
+	std::shared_ptr< parsed > data = std::make_shared< parsed >();
+	data->source = read_file(filename);
+	return parse_lazy_source(data);
 }
 
 } //namespace sejp
@@ -1,42 +1,229 @@
 #pragma once
 
 //A "Somewhat Eager JSON Parser" that parses and converts files
-//upon loading into some lists of numbers, objects, bools, nulls;
+//upon loading into some flat lists of numbers, strings, arrays, and objects;
 //then provides a generic "value" handle to the root.
+//(Or, if asked, a less eager one that indexes files and converts values as they are used.)
 
 #include <string>
+#include <string_view>
+#include <iosfwd>
 #include <vector>
-#include <map>
 #include <optional>
 #include <memory>
+#include <utility>
+#include <iterator>
+#include <compare>
+#include <cstddef>
 #include <cstdint>
 
 namespace sejp {
 	//sejp::parsed represents the results of scanning a JSON file:
 	struct parsed;
-	
+
+	struct value;
+	struct array_view;
+	struct object_view;
+
 	//generic value:
+	//  NOTE: values are plain (trivially copyable) handles into a document's storage;
+	//        they (and the views they return) are only valid while that document is alive.
 	struct value {
 		//internals:
-		std::shared_ptr< parsed const > data;
+		parsed const *data;
 		uint32_t index; //(opaque) index data's value storage
-		value(std::shared_ptr< parsed const > const &data_, uint32_t index_) : data(data_), index(index_) { }
+		value(parsed const *data_, uint32_t index_) : data(data_), index(index_) { }
 
 		//interface:
-		//  NOTE: these functions take O(1) time
-		std::optional< std::string > const &as_string() const;
-		std::optional< double > const &as_number() const;
-		std::optional< bool > const &as_bool() const;
-		std::optional< nullptr_t > const &as_null() const;
-		std::optional< std::vector< value > > const &as_array() const;
-		std::optional< std::map< std::string, value > > const &as_object() const;
+		//  NOTE: these functions return views into the document's flat storage without copying:
+		//        O(1) for documents from load()/parse(); for parse_lazy() documents, the first
+		//        as_array()/as_object() on a container decodes it (O(length of its text)), and as_number()
+		//        converts from the source text on every call. (Key lookup is object_view::find, O(log n).)
+		std::optional< std::string_view > as_string() const;
+		std::optional< double > as_number() const;
+		std::optional< bool > as_bool() const;
+		std::optional< std::nullptr_t > as_null() const;
+		std::optional< array_view > as_array() const;
+		std::optional< object_view > as_object() const;
+	};
+
+	//arrays are contiguous runs of value indices:
+	struct array_view {
+		parsed const *data = nullptr;
+		uint32_t const *begin_ = nullptr;
+		uint32_t const *end_ = nullptr;
+
+		struct iterator {
+			using iterator_category = std::random_access_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = sejp::value;
+			using pointer = void;
+			using reference = sejp::value;
+
+			parsed const *data = nullptr;
+			uint32_t const *at = nullptr;
+
+			sejp::value operator*() const { return sejp::value(data, *at); }
+			sejp::value operator[](difference_type i) const { return sejp::value(data, at[i]); }
+			iterator &operator++() { ++at; return *this; }
+			iterator operator++(int) { iterator ret = *this; ++at; return ret; }
+			iterator &operator--() { --at; return *this; }
+			iterator operator--(int) { iterator ret = *this; --at; return ret; }
+			iterator &operator+=(difference_type n) { at += n; return *this; }
+			iterator &operator-=(difference_type n) { at -= n; return *this; }
+			iterator operator+(difference_type n) const { return iterator{data, at + n}; }
+			iterator operator-(difference_type n) const { return iterator{data, at - n}; }
+			difference_type operator-(iterator const &o) const { return at - o.at; }
+			bool operator==(iterator const &o) const { return at == o.at; }
+			auto operator<=>(iterator const &o) const { return at <=> o.at; }
+		};
+
+		iterator begin() const { return iterator{data, begin_}; }
+		iterator end() const { return iterator{data, end_}; }
+		size_t size() const { return size_t(end_ - begin_); }
+		bool empty() const { return begin_ == end_; }
+		value operator[](size_t i) const { return value(data, begin_[i]); }
+		value at(size_t i) const; //throws std::out_of_range
+	};
+
+	//objects are contiguous runs of (key, value index) entries, sorted by key:
+	struct object_entry {
+		std::string_view key;
+		uint32_t index;
+	};
+
+	//object members are presented map-style as (key, value) pairs:
+	using member = std::pair< std::string_view, value >;
+
+	struct object_view {
+		parsed const *data = nullptr;
+		object_entry const *begin_ = nullptr;
+		object_entry const *end_ = nullptr;
+
+		struct iterator {
+			using iterator_category = std::random_access_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = member;
+			using reference = member;
+
+			//(members are built on the fly, so '->' needs something to point to)
+			struct arrow {
+				member m;
+				member const *operator->() const { return &m; }
+			};
+			using pointer = arrow;
+
+			parsed const *data = nullptr;
+			object_entry const *at = nullptr;
+
+			member operator*() const { return member(at->key, sejp::value(data, at->index)); }
+			arrow operator->() const { return arrow{ **this }; }
+			member operator[](difference_type i) const { return *(*this + i); }
+			iterator &operator++() { ++at; return *this; }
+			iterator operator++(int) { iterator ret = *this; ++at; return ret; }
+			iterator &operator--() { --at; return *this; }
+			iterator operator--(int) { iterator ret = *this; --at; return ret; }
+			iterator &operator+=(difference_type n) { at += n; return *this; }
+			iterator &operator-=(difference_type n) { at -= n; return *this; }
+			iterator operator+(difference_type n) const { return iterator{data, at + n}; }
+			iterator operator-(difference_type n) const { return iterator{data, at - n}; }
+			difference_type operator-(iterator const &o) const { return at - o.at; }
+			bool operator==(iterator const &o) const { return at == o.at; }
+			auto operator<=>(iterator const &o) const { return at <=> o.at; }
+		};
+
+		iterator begin() const { return iterator{data, begin_}; }
+		iterator end() const { return iterator{data, end_}; }
+		size_t size() const { return size_t(end_ - begin_); }
+		bool empty() const { return begin_ == end_; }
+		iterator find(std::string_view key) const; //O(log n); returns end() if missing
+		bool contains(std::string_view key) const { return find(key) != end(); }
+		value at(std::string_view key) const; //throws std::out_of_range
+	};
+
+	//owns the storage that values point into:
+	struct document {
+		std::shared_ptr< parsed const > data;
+		value root() const;
 	};
 
-	//how you make values:
+	//how the buffer parser stores strings (and keys):
+	enum class Strings {
+		Copy, //copy every string into the document; the source text is not kept
+		Reference, //keep the source text in the document; strings without escapes are views of it
+	};
+
+	//how you make documents:
 	//  NOTE: O(length of data) time, space.
-	//  NOTE: loaded data is retained via shared_ptr until values referring to it go out of scope
 	//  NOTE: throws on parse error
-	value load(std::string const &filename);
-	value parse(std::string const &string);
+	document load(std::string const &filename, Strings strings = Strings::Copy); //reads the whole file into memory, then parses it as a buffer
+	document parse(std::string_view buffer, Strings strings = Strings::Copy); //scans a contiguous buffer with pointer arithmetic (preferred)
+	document parse(std::istream &from); //reads one character at a time from a stream (slower; kept for comparison)
+
+	//read a whole file into memory (as load() does before parsing it):
+	//  NOTE: throws if the file can't be opened or read
+	std::string read_file(std::string const &filename);
+
+	//event-based ("SAX-style") parsing:
+	// calls a handler's functions as values are read, and never builds a document
+	//  NOTE: strings passed to handler functions are only valid until the function returns
+	//  NOTE: handler functions may throw to stop parsing (the exception is passed on to the caller)
+	//  NOTE: memory use is the file plus a fixed-size window of the index
+	struct handler {
+		virtual ~handler() = default;
+		virtual void on_object_begin() { }
+		virtual void on_key(std::string_view) { }
+		virtual void on_object_end() { }
+		virtual void on_array_begin() { }
+		virtual void on_array_end() { }
+		virtual void on_string(std::string_view) { }
+		virtual void on_number(double) { }
+		virtual void on_bool(bool) { }
+		virtual void on_null() { }
+	};
+	void load(std::string const &filename, handler &to);
+	void parse(std::string_view buffer, handler &to);
+
+	//a handler that builds a document out of the events it is sent
+	// (e.g., to turn just one part of an event stream into a document):
+	struct BuildEvents;
+	struct document_builder : handler {
+		document_builder();
+		~document_builder() override;
+		document_builder(document_builder const &) = delete;
+		document_builder &operator=(document_builder const &) = delete;
+
+		void on_object_begin() override;
+		void on_key(std::string_view key) override;
+		void on_object_end() override;
+		void on_array_begin() override;
+		void on_array_end() override;
+		void on_string(std::string_view str) override;
+		void on_number(double number) override;
+		void on_bool(bool b) override;
+		void on_null() override;
+
+		bool done() const; //has a complete value been sent?
+		document finish(); //returns the document and starts a new one; NOTE: throws if !done()
+
+		std::unique_ptr< BuildEvents > events;
+		//the last document returned; once the caller has released it, the next-but-one document reuses its storage:
+		// (so building a stream of short-lived documents doesn't allocate for each one)
+		std::shared_ptr< parsed > spare;
+	};
+
+	//split a top-level array into the text of each of its elements, without parsing them
+	// (e.g., so the elements can be parsed on several threads):
+	//  NOTE: returns std::nullopt if the top-level value is not an array
+	//  NOTE: only the array itself is checked for errors; elements are checked when they are parsed
+	std::optional< std::vector< std::string_view > > split_array(std::string_view buffer);
+
+	//lazy versions:
+	//  NOTE: these check the whole document for errors and index it, but only decode arrays and
+	//        objects on their first as_array() / as_object() and numbers on every as_number()
+	//  NOTE: the document keeps the source text, and strings are views of it (as with Strings::Reference)
+	//  NOTE: decoding modifies the document, so values from a lazy document should only be used from one thread at a time
+	document load_lazy(std::string const &filename);
+	document parse_lazy(std::string_view buffer);
 
 } //namespace sejp
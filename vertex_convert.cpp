@@ -0,0 +1,196 @@
+#include "vertex_convert.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <utility>
+
+namespace {
+
+enum class Kind { Unorm, Snorm, Uint, Sint, Float };
+
+//How a format lays out one element:
+struct FormatInfo {
+	uint32_t components = 0; //0 if the format isn't supported
+	uint32_t component_bytes = 0;
+	Kind kind = Kind::Float;
+	bool bgra = false; //components are stored blue, green, red, alpha
+	bool a2b10g10r10 = false; //10-bit red, green, blue and 2-bit alpha packed (from the low bits up) in a 32-bit word
+};
+
+constexpr FormatInfo format_info(VkFormat format) {
+	switch (format) {
+		case VK_FORMAT_R8_UNORM: return { 1, 1, Kind::Unorm };
+		case VK_FORMAT_R8_SNORM: return { 1, 1, Kind::Snorm };
+		case VK_FORMAT_R8_UINT: return { 1, 1, Kind::Uint };
+		case VK_FORMAT_R8_SINT: return { 1, 1, Kind::Sint };
+		case VK_FORMAT_R8G8_UNORM: return { 2, 1, Kind::Unorm };
+		case VK_FORMAT_R8G8_SNORM: return { 2, 1, Kind::Snorm };
+		case VK_FORMAT_R8G8_UINT: return { 2, 1, Kind::Uint };
+		case VK_FORMAT_R8G8_SINT: return { 2, 1, Kind::Sint };
+		//(the _PACK32 formats hold the same bytes as their unpacked versions on little-endian hosts)
+		case VK_FORMAT_R8G8B8A8_UNORM: case VK_FORMAT_A8B8G8R8_UNORM_PACK32: return { 4, 1, Kind::Unorm };
+		case VK_FORMAT_R8G8B8A8_SNORM: case VK_FORMAT_A8B8G8R8_SNORM_PACK32: return { 4, 1, Kind::Snorm };
+		case VK_FORMAT_R8G8B8A8_UINT: case VK_FORMAT_A8B8G8R8_UINT_PACK32: return { 4, 1, Kind::Uint };
+		case VK_FORMAT_R8G8B8A8_SINT: case VK_FORMAT_A8B8G8R8_SINT_PACK32: return { 4, 1, Kind::Sint };
+		case VK_FORMAT_B8G8R8A8_UNORM: return { 4, 1, Kind::Unorm, true };
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32: return { 4, 4, Kind::Unorm, false, true };
+		case VK_FORMAT_R16_UNORM: return { 1, 2, Kind::Unorm };
+		case VK_FORMAT_R16_SNORM: return { 1, 2, Kind::Snorm };
+		case VK_FORMAT_R16_UINT: return { 1, 2, Kind::Uint };
+		case VK_FORMAT_R16_SINT: return { 1, 2, Kind::Sint };
+		case VK_FORMAT_R16_SFLOAT: return { 1, 2, Kind::Float };
+		case VK_FORMAT_R16G16_UNORM: return { 2, 2, Kind::Unorm };
+		case VK_FORMAT_R16G16_SNORM: return { 2, 2, Kind::Snorm };
+		case VK_FORMAT_R16G16_UINT: return { 2, 2, Kind::Uint };
+		case VK_FORMAT_R16G16_SINT: return { 2, 2, Kind::Sint };
+		case VK_FORMAT_R16G16_SFLOAT: return { 2, 2, Kind::Float };
+		case VK_FORMAT_R16G16B16A16_UNORM: return { 4, 2, Kind::Unorm };
+		case VK_FORMAT_R16G16B16A16_SNORM: return { 4, 2, Kind::Snorm };
+		case VK_FORMAT_R16G16B16A16_UINT: return { 4, 2, Kind::Uint };
+		case VK_FORMAT_R16G16B16A16_SINT: return { 4, 2, Kind::Sint };
+		case VK_FORMAT_R16G16B16A16_SFLOAT: return { 4, 2, Kind::Float };
+		case VK_FORMAT_R32_UINT: return { 1, 4, Kind::Uint };
+		case VK_FORMAT_R32_SINT: return { 1, 4, Kind::Sint };
+		case VK_FORMAT_R32_SFLOAT: return { 1, 4, Kind::Float };
+		case VK_FORMAT_R32G32_UINT: return { 2, 4, Kind::Uint };
+		case VK_FORMAT_R32G32_SINT: return { 2, 4, Kind::Sint };
+		case VK_FORMAT_R32G32_SFLOAT: return { 2, 4, Kind::Float };
+		case VK_FORMAT_R32G32B32_UINT: return { 3, 4, Kind::Uint };
+		case VK_FORMAT_R32G32B32_SINT: return { 3, 4, Kind::Sint };
+		case VK_FORMAT_R32G32B32_SFLOAT: return { 3, 4, Kind::Float };
+		case VK_FORMAT_R32G32B32A32_UINT: return { 4, 4, Kind::Uint };
+		case VK_FORMAT_R32G32B32A32_SINT: return { 4, 4, Kind::Sint };
+		case VK_FORMAT_R32G32B32A32_SFLOAT: return { 4, 4, Kind::Float };
+		default: return { };
+	}
+}
+
+//The type of one component:
+template< uint32_t Bytes, Kind K > struct Component;
+template< > struct Component< 1, Kind::Unorm > { using type = uint8_t; };
+template< > struct Component< 1, Kind::Uint > { using type = uint8_t; };
+template< > struct Component< 1, Kind::Snorm > { using type = int8_t; };
+template< > struct Component< 1, Kind::Sint > { using type = int8_t; };
+template< > struct Component< 2, Kind::Unorm > { using type = uint16_t; };
+template< > struct Component< 2, Kind::Uint > { using type = uint16_t; };
+template< > struct Component< 2, Kind::Snorm > { using type = int16_t; };
+template< > struct Component< 2, Kind::Sint > { using type = int16_t; };
+template< > struct Component< 2, Kind::Float > { using type = uint16_t; }; //(half float bits)
+template< > struct Component< 4, Kind::Uint > { using type = uint32_t; };
+template< > struct Component< 4, Kind::Sint > { using type = int32_t; };
+template< > struct Component< 4, Kind::Float > { using type = float; };
+
+float half_to_float(uint16_t half) {
+	uint32_t sign = uint32_t(half & 0x8000u) << 16;
+	uint32_t exponent = (half >> 10) & 0x1fu;
+	uint32_t mantissa = half & 0x3ffu;
+	uint32_t bits;
+	if (exponent == 0x1f) {
+		bits = sign | 0x7f800000u | (mantissa << 13); //infinity or NaN
+	} else if (exponent != 0) {
+		bits = sign | ((exponent + (127 - 15)) << 23) | (mantissa << 13);
+	} else {
+		//zero or subnormal (mantissa * 2^-24), which is normal as a float:
+		float value = float(mantissa) * (1.0f / 16777216.0f);
+		return sign ? -value : value;
+	}
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+template< uint32_t Bytes, Kind K >
+float to_float(typename Component< Bytes, K >::type c) {
+	using T = typename Component< Bytes, K >::type;
+	if constexpr (K == Kind::Unorm) {
+		return float(c) * (1.0f / float(T(~T(0))));
+	} else if constexpr (K == Kind::Snorm) {
+		//(both the most negative value and the one above it map to -1)
+		constexpr T Max = T((1u << (8 * Bytes - 1)) - 1u);
+		return std::max(float(c) * (1.0f / float(Max)), -1.0f);
+	} else if constexpr (K == Kind::Float && Bytes == 2) {
+		return half_to_float(c);
+	} else {
+		return float(c);
+	}
+}
+
+//Read one element of Src into the first components of values:
+template< VkFormat Src >
+void decode(uint8_t const *src, float (&values)[4]) {
+	constexpr FormatInfo In = format_info(Src);
+	if constexpr (In.a2b10g10r10) {
+		uint32_t word;
+		std::memcpy(&word, src, sizeof(word));
+		values[0] = float(word & 0x3ffu) * (1.0f / 1023.0f);
+		values[1] = float((word >> 10) & 0x3ffu) * (1.0f / 1023.0f);
+		values[2] = float((word >> 20) & 0x3ffu) * (1.0f / 1023.0f);
+		values[3] = float(word >> 30) * (1.0f / 3.0f);
+	} else {
+		typename Component< In.component_bytes, In.kind >::type components[In.components];
+		std::memcpy(components, src, sizeof(components));
+		for (uint32_t c = 0; c < In.components; ++c) {
+			values[c] = to_float< In.component_bytes, In.kind >(components[c]);
+		}
+		if constexpr (In.bgra) std::swap(values[0], values[2]);
+	}
+}
+
+template< VkFormat Src, VkFormat Dst >
+void convert(uint8_t const *src, size_t src_stride, uint8_t *dst, size_t dst_stride, uint32_t count) {
+	constexpr FormatInfo Out = format_info(Dst);
+	static_assert(Out.kind == Kind::Float && Out.component_bytes == 4 && !Out.bgra, "converts to 32-bit float vectors");
+	for (uint32_t i = 0; i < count; ++i) {
+		float values[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		decode< Src >(src + size_t(i) * src_stride, values);
+		std::memcpy(dst + size_t(i) * dst_stride, values, Out.components * sizeof(float));
+	}
+}
+
+using ConverterTable = std::map< std::pair< VkFormat, VkFormat >, AttributeConverter >;
+
+template< VkFormat Dst, VkFormat... Srcs >
+void add_converters(ConverterTable &table) {
+	(table.emplace(std::make_pair(Srcs, Dst), &convert< Srcs, Dst >), ...);
+}
+
+//every s72 vertex format, to Dst:
+template< VkFormat Dst >
+void add_converters_to(ConverterTable &table) {
+	add_converters< Dst,
+		VK_FORMAT_R8_UNORM, VK_FORMAT_R8_SNORM, VK_FORMAT_R8_UINT, VK_FORMAT_R8_SINT,
+		VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8_SNORM, VK_FORMAT_R8G8_UINT, VK_FORMAT_R8G8_SINT,
+		VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_SNORM, VK_FORMAT_R8G8B8A8_UINT, VK_FORMAT_R8G8B8A8_SINT,
+		VK_FORMAT_B8G8R8A8_UNORM,
+		VK_FORMAT_A8B8G8R8_UNORM_PACK32, VK_FORMAT_A8B8G8R8_SNORM_PACK32, VK_FORMAT_A8B8G8R8_UINT_PACK32, VK_FORMAT_A8B8G8R8_SINT_PACK32,
+		VK_FORMAT_A2B10G10R10_UNORM_PACK32,
+		VK_FORMAT_R16_UNORM, VK_FORMAT_R16_SNORM, VK_FORMAT_R16_UINT, VK_FORMAT_R16_SINT, VK_FORMAT_R16_SFLOAT,
+		VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16_SNORM, VK_FORMAT_R16G16_UINT, VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16_SFLOAT,
+		VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SNORM, VK_FORMAT_R16G16B16A16_UINT, VK_FORMAT_R16G16B16A16_SINT, VK_FORMAT_R16G16B16A16_SFLOAT,
+		VK_FORMAT_R32_UINT, VK_FORMAT_R32_SINT, VK_FORMAT_R32_SFLOAT,
+		VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32_SFLOAT,
+		VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32_SFLOAT,
+		VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_R32G32B32A32_SINT, VK_FORMAT_R32G32B32A32_SFLOAT
+	>(table);
+}
+
+} //namespace
+
+AttributeConverter find_attribute_converter(VkFormat src, VkFormat dst) {
+	static ConverterTable const table = []() {
+		ConverterTable t;
+		add_converters_to< VK_FORMAT_R32G32_SFLOAT >(t);
+		add_converters_to< VK_FORMAT_R32G32B32_SFLOAT >(t);
+		add_converters_to< VK_FORMAT_R32G32B32A32_SFLOAT >(t);
+		return t;
+	}();
+
+	auto f = table.find(std::make_pair(src, dst));
+	return f != table.end() ? f->second : nullptr;
+}
+
+uint32_t attribute_format_size(VkFormat format) {
+	FormatInfo info = format_info(format);
+	return info.a2b10g10r10 ? 4 : info.components * info.component_bytes;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+//Load-time conversion of vertex attribute data between formats, so meshes can store attributes however their exporter likes.
+// (Used by Tutorial::build_scene_meshes; sources are the s72 vertex formats (see format_to_VkFormat in S72.cpp),
+//  destinations are the 32-bit float vectors PosNorTexVertex stores.)
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Convert count elements, src_stride bytes apart, to elements dst_stride bytes apart.
+// Components are read like vertex input would read them (UNORM/SNORM normalized, UINT/SINT as their integer values),
+//  and components the source doesn't have are filled in from (0, 0, 0, 1).
+using AttributeConverter = void (*)(uint8_t const *src, size_t src_stride, uint8_t *dst, size_t dst_stride, uint32_t count);
+
+// The converter for a (src, dst) pair of formats, or nullptr if the pair isn't supported.
+// (every pair has its own instantiation, so each is a tight loop with the format decisions made at compile time)
+AttributeConverter find_attribute_converter(VkFormat src, VkFormat dst);
+
+// Bytes in one element of a format find_attribute_converter supports (0 for others):
+uint32_t attribute_format_size(VkFormat format);